@@ -1,4 +1,10 @@
 #include "algoritmo.h"
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <time.h>
 
 // ----------------------------------------------------
 // Funções para gerenciamento da lista de prioridade
@@ -35,27 +41,89 @@ No *removerPrimeiro(ListaPrioridade *lista) {
 }
 
 //CONTA A FREQUENCIA DE CADA SÍMBOLO NO ARQUIVO
-void contarFrequencias(const char *nomeArquivo, unsigned int frequencias[]) {
+void contarFrequencias(const char *nomeArquivo, uint64_t frequencias[]) {
     FILE *arquivo = fopen(nomeArquivo, "rb");
     if (!arquivo) return;
 
-    unsigned char buffer[TAMANHO_BUFFER];
     size_t bytesLidos;
-    memset(frequencias, 0, TAMANHO_TABELA * sizeof(unsigned int));
-
-    while ((bytesLidos = fread(buffer, 1, TAMANHO_BUFFER, arquivo)) > 0) {
-        for (size_t i = 0; i < bytesLidos; i++)
-            frequencias[buffer[i]]++;
+    memset(frequencias, 0, TAMANHO_TABELA * sizeof(uint64_t));
+    uint8_t *buffer = malloc(TAMANHO_BUFFER_GRANDE);
+    if (buffer) {
+        while ((bytesLidos = fread(buffer, 1, TAMANHO_BUFFER_GRANDE, arquivo)) > 0)
+            acumularFrequencias(buffer, bytesLidos, frequencias);
+        free(buffer);
     }
     fclose(arquivo);
 }
 
+//LÊ 8 BYTES SEM EXIGIR ALINHAMENTO
+static inline uint64_t lerPalavra(const uint8_t *p) {
+    uint64_t palavra;
+    memcpy(&palavra, p, sizeof(palavra));
+    return palavra;
+}
+
+//DISTRIBUI OS 8 BYTES DA PALAVRA ENTRE OS SUB-HISTOGRAMAS, PARA QUE BYTES IGUAIS SEGUIDOS NÃO DEPENDAM UM DO OUTRO
+static inline void contarPalavra(uint32_t sub[][TAMANHO_TABELA], uint64_t palavra) {
+    sub[0][palavra & 0xFF]++;
+    sub[1][(palavra >> 8) & 0xFF]++;
+    sub[2][(palavra >> 16) & 0xFF]++;
+    sub[3][(palavra >> 24) & 0xFF]++;
+    sub[0][(palavra >> 32) & 0xFF]++;
+    sub[1][(palavra >> 40) & 0xFF]++;
+    sub[2][(palavra >> 48) & 0xFF]++;
+    sub[3][palavra >> 56]++;
+}
+
+//CONTA UM TRECHO EM GRUPOS DE 32 BYTES; UM GRUPO COM UM ÚNICO BYTE REPETIDO VIRA QUATRO SOMAS.
+//O SUB-HISTOGRAMA j RECEBE EXATAMENTE AS POSIÇÕES i COM i % 4 == j
+static void contarTrecho(const uint8_t *dados, size_t tamanho, uint32_t sub[][TAMANHO_TABELA]) {
+    size_t i = 0;
+    for (; i + 32 <= tamanho; i += 32) {
+        uint64_t a = lerPalavra(dados + i), b = lerPalavra(dados + i + 8);
+        uint64_t c = lerPalavra(dados + i + 16), d = lerPalavra(dados + i + 24);
+        if ((a ^ b) == 0 && (a ^ c) == 0 && (a ^ d) == 0 && a == (a & 0xFF) * 0x0101010101010101ULL) {
+            for (int j = 0; j < 4; j++)
+                sub[j][a & 0xFF] += 8;
+            continue;
+        }
+        contarPalavra(sub, a);
+        contarPalavra(sub, b);
+        contarPalavra(sub, c);
+        contarPalavra(sub, d);
+    }
+    for (; i < tamanho; i++)
+        sub[i & 3][dados[i]]++;
+}
+
+//SOMA ÀS FREQUÊNCIAS AS OCORRÊNCIAS DE CADA SÍMBOLO EM UM TRECHO DE MEMÓRIA
+void acumularFrequencias(const uint8_t *dados, size_t tamanho, uint64_t frequencias[]) {
+    // Trechos curtos não compensam zerar e somar os sub-histogramas
+    if (tamanho < 4 * TAMANHO_TABELA) {
+        for (size_t i = 0; i < tamanho; i++)
+            frequencias[dados[i]]++;
+        return;
+    }
+
+    // Contadores de 32 bits deixam os sub-histogramas em 4 KB; cada parte cabe neles sem estourar
+    uint32_t sub[4][TAMANHO_TABELA];
+    while (tamanho > 0) {
+        size_t parte = tamanho < ((size_t)1 << 30) ? tamanho : ((size_t)1 << 30);
+        memset(sub, 0, sizeof(sub));
+        contarTrecho(dados, parte, sub);
+        for (int s = 0; s < TAMANHO_TABELA; s++)
+            frequencias[s] += (uint64_t)sub[0][s] + sub[1][s] + sub[2][s] + sub[3][s];
+        dados += parte;
+        tamanho -= parte;
+    }
+}
+
 // ----------------------------------------------------
 // Funções para construção da árvore de Huffman
 // ----------------------------------------------------
 
 //CRIA UM NÓ FOLHA COM O SÍMBOLO E FREQUENCIA INFORMADO
-No *criarFolha(unsigned char simbolo, unsigned int frequencia) {
+No *criarFolha(unsigned char simbolo, uint64_t frequencia) {
     No *novo = calloc(1, sizeof(No));
     novo->simbolo = simbolo;
     novo->frequencia = frequencia;
@@ -71,22 +139,70 @@ No *criarNoInterno(No *esquerdo, No *direito) {
     return novo;
 }
 
-//CONSTROI A ÁRVORE DE HUFFMAN A A PARTIR DE UM VETOR DE FREQUENCIA
-No *construirArvoreHuffman(unsigned int frequencias[]) {
-    ListaPrioridade lista;
-    inicializarLista(&lista);
+//RESERVA UM BLOCO PARA TODOS OS NÓS DE UMA ÁRVORE
+ArenaNos *criarArena(void) {
+    ArenaNos *arena = malloc(sizeof(ArenaNos));
+    if (arena) arena->usados = 0;
+    return arena;
+}
+
+//ENTREGA O PRÓXIMO NÓ LIVRE DA ARENA, ZERADO; NULL SE A ARENA ESTIVER CHEIA
+No *alocarNo(ArenaNos *arena) {
+    if (arena->usados == 2 * TAMANHO_TABELA - 1) return NULL;
+    No *no = &arena->nos[arena->usados++];
+    memset(no, 0, sizeof(No));
+    return no;
+}
+
+//LIBERA DE UMA VEZ TODOS OS NÓS DA ARENA
+void liberarArena(ArenaNos *arena) {
+    free(arena);
+}
+
+//ORDENA FOLHAS POR FREQUÊNCIA; EMPATES MANTÊM A ORDEM DOS SÍMBOLOS
+static int compararFolhas(const void *a, const void *b) {
+    const No *x = *(No *const *)a;
+    const No *y = *(No *const *)b;
+    if (x->frequencia != y->frequencia) return x->frequencia < y->frequencia ? -1 : 1;
+    return (int)x->simbolo - (int)y->simbolo;
+}
+
+//CONSTROI A ÁRVORE DE HUFFMAN COM DUAS FILAS: FOLHAS ORDENADAS E NÓS INTERNOS EM ORDEM DE CRIAÇÃO
+No *construirArvoreHuffman(const uint64_t frequencias[], ArenaNos *arena) {
+    No *folhas[TAMANHO_TABELA], *internos[TAMANHO_TABELA];
+    int totalFolhas = 0;
+    arena->usados = 0;
 
     for (int i = 0; i < TAMANHO_TABELA; i++) {
-        if (frequencias[i] > 0)
-            inserirOrdenado(criarFolha((unsigned char)i, frequencias[i]), &lista);
+        if (frequencias[i] > 0) {
+            No *folha = alocarNo(arena);
+            folha->simbolo = (unsigned char)i;
+            folha->frequencia = frequencias[i];
+            folhas[totalFolhas++] = folha;
+        }
     }
+    if (totalFolhas == 0) return NULL;
+    qsort(folhas, totalFolhas, sizeof(No *), compararFolhas);
 
-    while (lista.tamanho > 1) {
-        No *esquerdo = removerPrimeiro(&lista);
-        No *direito = removerPrimeiro(&lista);
-        inserirOrdenado(criarNoInterno(esquerdo, direito), &lista);
+    // Os nós internos nascem em ordem crescente de frequência, então a segunda fila já fica ordenada.
+    // Em empates a folha sai primeiro, reproduzindo a antiga lista ordenada
+    int proximaFolha = 0, inicioInternos = 0, totalInternos = 0;
+    while ((totalFolhas - proximaFolha) + (totalInternos - inicioInternos) > 1) {
+        No *menores[2];
+        for (int k = 0; k < 2; k++) {
+            if (proximaFolha < totalFolhas &&
+                (inicioInternos == totalInternos || folhas[proximaFolha]->frequencia <= internos[inicioInternos]->frequencia))
+                menores[k] = folhas[proximaFolha++];
+            else
+                menores[k] = internos[inicioInternos++];
+        }
+        No *interno = alocarNo(arena);
+        interno->frequencia = menores[0]->frequencia + menores[1]->frequencia;
+        interno->esquerda = menores[0];
+        interno->direita = menores[1];
+        internos[totalInternos++] = interno;
     }
-    return lista.inicio;
+    return totalInternos ? internos[totalInternos - 1] : folhas[0];
 }
 
 //PERCORRE A ÁRVORE E GERA UM CÓDIGO BINÁRIO PARA CADA SÍMBOLO
@@ -106,6 +222,276 @@ void gerarCodigos(No *no, char caminho[], int posicao, char tabelaCodigos[TAMANH
     }
 }
 
+//PERCORRE A ÁRVORE E GUARDA O CÓDIGO DE CADA FOLHA COMO INTEIRO
+static int preencherCodigos(No *no, uint64_t codigo, int profundidade, CodigoHuffman codigos[]) {
+    if (!no) return 0;
+    if (!no->esquerda && !no->direita) {
+        codigos[no->simbolo].bits = codigo;
+        codigos[no->simbolo].tamanho = (uint8_t)profundidade;
+        return 1;
+    }
+    if (profundidade == 64) return 0;
+    return preencherCodigos(no->esquerda, codigo << 1, profundidade + 1, codigos) &&
+           preencherCodigos(no->direita, (codigo << 1) | 1, profundidade + 1, codigos);
+}
+
+//GERA OS PARES (CÓDIGO, TAMANHO) DE CADA SÍMBOLO; FALHA SE ALGUM CÓDIGO PASSAR DE 64 BITS
+int gerarCodigosInteiros(No *raiz, CodigoHuffman codigos[TAMANHO_TABELA]) {
+    memset(codigos, 0, TAMANHO_TABELA * sizeof(CodigoHuffman));
+    return raiz ? preencherCodigos(raiz, 0, 0, codigos) : 1;
+}
+
+// ----------------------------------------------------
+// Funções para códigos canônicos
+// ----------------------------------------------------
+
+//GUARDA A PROFUNDIDADE DE CADA FOLHA COMO O TAMANHO DO CÓDIGO DO SÍMBOLO
+static void preencherComprimentos(No *no, int profundidade, uint8_t comprimentos[]) {
+    if (!no->esquerda && !no->direita) {
+        // Uma árvore com uma única folha ainda precisa de um bit por símbolo
+        comprimentos[no->simbolo] = (uint8_t)(profundidade ? profundidade : 1);
+        return;
+    }
+    preencherComprimentos(no->esquerda, profundidade + 1, comprimentos);
+    preencherComprimentos(no->direita, profundidade + 1, comprimentos);
+}
+
+//CALCULA O TAMANHO DO CÓDIGO DE CADA SÍMBOLO A PARTIR DA ÁRVORE DE HUFFMAN
+void calcularComprimentos(No *raiz, uint8_t comprimentos[TAMANHO_TABELA]) {
+    memset(comprimentos, 0, TAMANHO_TABELA);
+    if (raiz) preencherComprimentos(raiz, 0, comprimentos);
+}
+
+//CALCULA TAMANHOS ÓTIMOS SEM NENHUM CÓDIGO MAIOR QUE 'limite' (ALGORITMO PACKAGE-MERGE)
+int calcularComprimentosLimitados(const uint64_t frequencias[], int limite, uint8_t comprimentos[TAMANHO_TABELA]) {
+    int simbolos[TAMANHO_TABELA];
+    int n = 0;
+    memset(comprimentos, 0, TAMANHO_TABELA);
+    for (int i = 0; i < TAMANHO_TABELA; i++) {
+        if (frequencias[i] > 0) simbolos[n++] = i;
+    }
+    if (n == 0) return 1;
+    if (n == 1) {
+        comprimentos[simbolos[0]] = 1;
+        return 1;
+    }
+    // Com 'limite' bits cabem no máximo 2^limite símbolos
+    if (limite < 1 || limite > COMPRIMENTO_MAXIMO_CODIGO || (limite < 9 && (1 << limite) < n)) return 0;
+
+    // Folhas em ordem crescente de frequência (inserção, no máximo 256 elementos)
+    for (int i = 1; i < n; i++) {
+        int atual = simbolos[i], j = i;
+        while (j > 0 && frequencias[simbolos[j - 1]] > frequencias[atual]) {
+            simbolos[j] = simbolos[j - 1];
+            j--;
+        }
+        simbolos[j] = atual;
+    }
+
+    // Nível limite-1 (o mais fundo) só tem folhas; cada nível acima junta as folhas
+    // com os pacotes formados por pares consecutivos do nível de baixo
+    uint64_t pesos[3 * TAMANHO_TABELA], novos[3 * TAMANHO_TABELA];
+    uint8_t *ehFolha = malloc((size_t)limite * 3 * TAMANHO_TABELA);
+    if (!ehFolha) return 0;
+    int tamanho = n;
+    for (int i = 0; i < n; i++) pesos[i] = frequencias[simbolos[i]];
+
+    for (int nivel = limite - 2; nivel >= 0; nivel--) {
+        uint8_t *marcas = ehFolha + (size_t)nivel * 3 * TAMANHO_TABELA;
+        int pacotes = tamanho / 2, folha = 0, pacote = 0, novoTamanho = 0;
+        while (folha < n || pacote < pacotes) {
+            uint64_t pesoPacote = (pacote < pacotes) ? pesos[2 * pacote] + pesos[2 * pacote + 1] : UINT64_MAX;
+            if (folha < n && frequencias[simbolos[folha]] <= pesoPacote) {
+                novos[novoTamanho] = frequencias[simbolos[folha++]];
+                marcas[novoTamanho++] = 1;
+            } else {
+                novos[novoTamanho] = pesoPacote;
+                marcas[novoTamanho++] = 0;
+                pacote++;
+            }
+        }
+        memcpy(pesos, novos, novoTamanho * sizeof(uint64_t));
+        tamanho = novoTamanho;
+    }
+
+    // Os 2n-2 menores itens do topo formam a solução: cada folha escolhida em um nível
+    // soma 1 ao tamanho do seu código, e cada pacote escolhido expande dois itens do nível de baixo
+    int selecionados = 2 * n - 2;
+    for (int nivel = 0; nivel < limite - 1; nivel++) {
+        const uint8_t *marcas = ehFolha + (size_t)nivel * 3 * TAMANHO_TABELA;
+        int folhas = 0;
+        for (int j = 0; j < selecionados; j++) folhas += marcas[j];
+        for (int k = 0; k < folhas; k++) comprimentos[simbolos[k]]++;
+        selecionados = 2 * (selecionados - folhas);
+    }
+    for (int k = 0; k < selecionados; k++) comprimentos[simbolos[k]]++;
+
+    free(ehFolha);
+    return 1;
+}
+
+//SOMA QUANTOS BITS OS DADOS OCUPAM COM OS TAMANHOS DE CÓDIGO INFORMADOS
+uint64_t contarBitsCodificados(const uint64_t frequencias[], const uint8_t comprimentos[TAMANHO_TABELA]) {
+    uint64_t total = 0;
+    for (int i = 0; i < TAMANHO_TABELA; i++)
+        total += (uint64_t)frequencias[i] * comprimentos[i];
+    return total;
+}
+
+//ATRIBUI CÓDIGOS CANÔNICOS EM ORDEM DE TAMANHO E SÍMBOLO; FALHA SE OS TAMANHOS NÃO FORMAREM UM CÓDIGO DE PREFIXO
+int gerarCodigosCanonicos(const uint8_t comprimentos[TAMANHO_TABELA], CodigoHuffman codigos[TAMANHO_TABELA]) {
+    int quantidade[COMPRIMENTO_MAXIMO_CODIGO + 1] = {0};
+    for (int simbolo = 0; simbolo < TAMANHO_TABELA; simbolo++) {
+        if (comprimentos[simbolo] > COMPRIMENTO_MAXIMO_CODIGO) return 0;
+        quantidade[comprimentos[simbolo]]++;
+    }
+    quantidade[0] = 0;
+
+    // Desigualdade de Kraft: conta as folhas livres em cada nível sem estourar 64 bits
+    int64_t livres = 1;
+    for (int tamanho = 1; tamanho <= COMPRIMENTO_MAXIMO_CODIGO; tamanho++) {
+        livres = livres * 2 - quantidade[tamanho];
+        if (livres < 0) return 0;
+        if (livres > TAMANHO_TABELA) livres = TAMANHO_TABELA + 1;
+    }
+
+    uint64_t proximo[COMPRIMENTO_MAXIMO_CODIGO + 1];
+    uint64_t codigo = 0;
+    proximo[0] = 0;
+    for (int tamanho = 1; tamanho <= COMPRIMENTO_MAXIMO_CODIGO; tamanho++) {
+        codigo = (codigo + quantidade[tamanho - 1]) << 1;
+        proximo[tamanho] = codigo;
+    }
+    for (int simbolo = 0; simbolo < TAMANHO_TABELA; simbolo++) {
+        int tamanho = comprimentos[simbolo];
+        codigos[simbolo].tamanho = (uint8_t)tamanho;
+        codigos[simbolo].bits = tamanho ? proximo[tamanho]++ : 0;
+    }
+    return 1;
+}
+
+//ESCREVE UM INTEIRO EM BLOCOS DE 7 BITS, DO MENOS PARA O MAIS SIGNIFICATIVO
+int escreverVarint(EscritorBits *escritor, uint64_t valor) {
+    int escritos = 0;
+    do {
+        uint8_t byte = valor & 0x7F;
+        valor >>= 7;
+        escreverByteEscritor(escritor, byte | (valor ? 0x80 : 0));
+        escritos++;
+    } while (valor);
+    return escritos;
+}
+
+//LÊ UM INTEIRO ESCRITO POR escreverVarint
+int lerVarint(LeitorBits *leitor, uint64_t *valor) {
+    *valor = 0;
+    for (int deslocamento = 0; deslocamento < 64; deslocamento += 7) {
+        int byte = lerByteLeitor(leitor);
+        if (byte == EOF) return 0;
+        *valor |= (uint64_t)(byte & 0x7F) << deslocamento;
+        if (!(byte & 0x80)) return 1;
+    }
+    return 0;
+}
+
+//ESCREVE VALORES DE ATÉ 4 BITS, DOIS POR BYTE
+static void escreverMeiosBytes(const uint8_t valores[], int quantidade, EscritorBits *escritor) {
+    for (int i = 0; i < quantidade; i += 2) {
+        uint8_t segundo = (i + 1 < quantidade) ? valores[i + 1] : 0;
+        escreverByteEscritor(escritor, (uint8_t)((valores[i] << 4) | segundo));
+    }
+}
+
+//LÊ VALORES GRAVADOS POR escreverMeiosBytes
+static int lerMeiosBytes(LeitorBits *leitor, uint8_t valores[], int quantidade) {
+    for (int i = 0; i < quantidade; i += 2) {
+        int byte = lerByteLeitor(leitor);
+        if (byte == EOF) return 0;
+        valores[i] = (uint8_t)(byte >> 4);
+        if (i + 1 < quantidade) valores[i + 1] = (uint8_t)(byte & 0x0F);
+    }
+    return 1;
+}
+
+//SERIALIZA OS 256 TAMANHOS NA REPRESENTAÇÃO MAIS CURTA; RETORNA OS BYTES ESCRITOS
+int escreverComprimentos(const uint8_t comprimentos[TAMANHO_TABELA], EscritorBits *escritor) {
+    uint8_t corridas[2 * TAMANHO_TABELA];
+    uint8_t usados[TAMANHO_TABELA], tamanhosUsados[TAMANHO_TABELA];
+    int tamanhoCorridas = 0, quantidadeUsados = 0, maior = 0;
+    for (int i = 0; i < TAMANHO_TABELA;) {
+        int j = i;
+        while (j < TAMANHO_TABELA && comprimentos[j] == comprimentos[i]) j++;
+        corridas[tamanhoCorridas++] = comprimentos[i];
+        corridas[tamanhoCorridas++] = (uint8_t)(j - i - 1);
+        i = j;
+    }
+    for (int i = 0; i < TAMANHO_TABELA; i++) {
+        if (!comprimentos[i]) continue;
+        usados[quantidadeUsados] = (uint8_t)i;
+        tamanhosUsados[quantidadeUsados++] = comprimentos[i];
+        if (comprimentos[i] > maior) maior = comprimentos[i];
+    }
+
+    // Tamanhos de até 15 bits cabem em meio byte
+    int tamanhoEsparsa = (maior <= 15 && quantidadeUsados > 0) ? 1 + quantidadeUsados + (quantidadeUsados + 1) / 2 : INT32_MAX;
+    int tamanhoCompacta = (maior <= 15) ? TAMANHO_TABELA / 2 : INT32_MAX;
+    int melhor = TAMANHO_TABELA;
+    if (tamanhoCorridas < melhor) melhor = tamanhoCorridas;
+    if (tamanhoEsparsa < melhor) melhor = tamanhoEsparsa;
+    if (tamanhoCompacta < melhor) melhor = tamanhoCompacta;
+
+    if (melhor == tamanhoEsparsa) {
+        escreverByteEscritor(escritor, TABELA_ESPARSA);
+        escreverByteEscritor(escritor, (uint8_t)(quantidadeUsados - 1));
+        escreverBytesEscritor(escritor, usados, quantidadeUsados);
+        escreverMeiosBytes(tamanhosUsados, quantidadeUsados, escritor);
+    } else if (melhor == tamanhoCorridas) {
+        escreverByteEscritor(escritor, TABELA_EM_CORRIDAS);
+        escreverBytesEscritor(escritor, corridas, tamanhoCorridas);
+    } else if (melhor == tamanhoCompacta) {
+        escreverByteEscritor(escritor, TABELA_COMPACTA);
+        escreverMeiosBytes(comprimentos, TAMANHO_TABELA, escritor);
+    } else {
+        escreverByteEscritor(escritor, TABELA_COMPLETA);
+        escreverBytesEscritor(escritor, comprimentos, TAMANHO_TABELA);
+    }
+    return 1 + melhor;
+}
+
+//LÊ OS 256 TAMANHOS ESCRITOS POR escreverComprimentos
+int lerComprimentos(LeitorBits *leitor, uint8_t comprimentos[TAMANHO_TABELA]) {
+    int modo = lerByteLeitor(leitor);
+    memset(comprimentos, 0, TAMANHO_TABELA);
+
+    if (modo == TABELA_COMPLETA)
+        return lerBytesLeitor(leitor, comprimentos, TAMANHO_TABELA) == TAMANHO_TABELA;
+    if (modo == TABELA_COMPACTA)
+        return lerMeiosBytes(leitor, comprimentos, TAMANHO_TABELA);
+
+    if (modo == TABELA_ESPARSA) {
+        uint8_t usados[TAMANHO_TABELA], tamanhosUsados[TAMANHO_TABELA];
+        int quantidade = lerByteLeitor(leitor);
+        if (quantidade == EOF) return 0;
+        quantidade++;
+        if (lerBytesLeitor(leitor, usados, quantidade) != (size_t)quantidade ||
+            !lerMeiosBytes(leitor, tamanhosUsados, quantidade))
+            return 0;
+        for (int i = 0; i < quantidade; i++)
+            comprimentos[usados[i]] = tamanhosUsados[i];
+        return 1;
+    }
+
+    if (modo != TABELA_EM_CORRIDAS) return 0;
+    for (int i = 0; i < TAMANHO_TABELA;) {
+        int tamanho = lerByteLeitor(leitor);
+        int repeticoes = lerByteLeitor(leitor);
+        if (tamanho == EOF || repeticoes == EOF || i + repeticoes + 1 > TAMANHO_TABELA) return 0;
+        memset(comprimentos + i, tamanho, repeticoes + 1);
+        i += repeticoes + 1;
+    }
+    return 1;
+}
+
 // ----------------------------------------------------
 // Funções para escrita de bits no arquivo
 // ----------------------------------------------------
@@ -156,155 +542,3541 @@ int escreverArvore(No *no, FILE *arquivo) {
     return 1 + tamEsquerdo + tamDireito;
 }
 
-// ----------------------------------------------------
-// Funções principais de compactação e descompactação
-// ----------------------------------------------------
+//INICIALIZA O ESCRITOR DE BITS COM UM BUFFER GRANDE SOBRE O ARQUIVO
+int inicializarEscritor(EscritorBits *escritor, FILE *arquivo) {
+    escritor->arquivo = arquivo;
+    escritor->buffer = malloc(TAMANHO_BUFFER_GRANDE);
+    escritor->capacidade = TAMANHO_BUFFER_GRANDE;
+    escritor->posicao = 0;
+    escritor->acumulador = 0;
+    escritor->bitsNoAcumulador = 0;
+    escritor->totalBits = 0;
+    escritor->bufferProprio = 1;
+    escritor->estouro = 0;
+    return escritor->buffer != NULL;
+}
 
-//REALIZA A COMPACTAÇÃO DO ARQUIVO UTILIZANDO HUFFMAN
-void compactarHuffman(const char *nomeEntrada, const char *nomeSaida) {
-    unsigned int frequencias[TAMANHO_TABELA] = {0};
-    contarFrequencias(nomeEntrada, frequencias);
+//INICIALIZA O ESCRITOR DE BITS SOBRE UMA ÁREA DE MEMÓRIA DE PELO MENOS 4 BYTES, SEM ARQUIVO
+int inicializarEscritorMemoria(EscritorBits *escritor, uint8_t *destino, size_t capacidade) {
+    escritor->arquivo = NULL;
+    escritor->buffer = destino;
+    escritor->capacidade = capacidade;
+    escritor->posicao = 0;
+    escritor->acumulador = 0;
+    escritor->bitsNoAcumulador = 0;
+    escritor->totalBits = 0;
+    escritor->bufferProprio = 0;
+    // Uma palavra de 32 bits precisa sempre caber, mesmo depois de um estouro
+    escritor->estouro = capacidade < 4;
+    return !escritor->estouro;
+}
 
-    No *raiz = construirArvoreHuffman(frequencias);
+//GRAVA O BUFFER NO ARQUIVO; SEM ARQUIVO, REGISTRA QUE A MEMÓRIA NÃO BASTOU E DESCARTA O RESTO
+static void descarregarEscritor(EscritorBits *escritor) {
+    if (escritor->arquivo)
+        fwrite(escritor->buffer, 1, escritor->posicao, escritor->arquivo);
+    else
+        escritor->estouro = 1;
+    escritor->posicao = 0;
+}
 
-    char tabelaCodigos[TAMANHO_TABELA][TAMANHO_TABELA] = {{0}};
-    char caminhoAtual[TAMANHO_TABELA];
-    gerarCodigos(raiz, caminhoAtual, 0, tabelaCodigos);
+//ACRESCENTA UM CÓDIGO AO ACUMULADOR E DESCARREGA PALAVRAS DE 32 BITS NO BUFFER
+void escreverCodigo(EscritorBits *escritor, uint64_t codigo, int tamanho) {
+    // O acumulador guarda menos de 32 bits pendentes, então cabem até 32 bits novos
+    if (tamanho > 32) {
+        escreverCodigo(escritor, codigo >> 32, tamanho - 32);
+        codigo &= 0xFFFFFFFFu;
+        tamanho = 32;
+    }
+    escritor->acumulador = (escritor->acumulador << tamanho) | codigo;
+    escritor->bitsNoAcumulador += tamanho;
+    escritor->totalBits += (uint64_t)tamanho;
 
-    FILE *saida = fopen(nomeSaida, "wb");
-    if (!saida) return;
+    if (escritor->bitsNoAcumulador >= 32) {
+        escritor->bitsNoAcumulador -= 32;
+        uint32_t palavra = (uint32_t)(escritor->acumulador >> escritor->bitsNoAcumulador);
+        if (escritor->posicao + 4 > escritor->capacidade)
+            descarregarEscritor(escritor);
+        uint8_t *destino = escritor->buffer + escritor->posicao;
+        destino[0] = (uint8_t)(palavra >> 24);
+        destino[1] = (uint8_t)(palavra >> 16);
+        destino[2] = (uint8_t)(palavra >> 8);
+        destino[3] = (uint8_t)palavra;
+        escritor->posicao += 4;
+    }
+}
 
-    fputc(0, saida);
-    fputc(0, saida);
+//GRAVA UM BYTE NO BUFFER, DESCARREGANDO-O SE ESTIVER CHEIO
+static void gravarByteBuffer(EscritorBits *escritor, uint8_t byte) {
+    if (escritor->posicao == escritor->capacidade)
+        descarregarEscritor(escritor);
+    escritor->buffer[escritor->posicao++] = byte;
+}
 
-    int tamanhoArvore = escreverArvore(raiz, saida);
+//COMPLETA O ÚLTIMO BYTE COM ZEROS E PASSA PARA O BUFFER TODOS OS BITS PENDENTES
+void alinharEscritor(EscritorBits *escritor) {
+    int resto = escritor->bitsNoAcumulador % 8;
+    if (resto) {
+        escritor->acumulador <<= 8 - resto;
+        escritor->bitsNoAcumulador += 8 - resto;
+    }
+    while (escritor->bitsNoAcumulador >= 8) {
+        escritor->bitsNoAcumulador -= 8;
+        gravarByteBuffer(escritor, (uint8_t)(escritor->acumulador >> escritor->bitsNoAcumulador));
+    }
+    escritor->acumulador = 0;
+}
 
-    FILE *entrada = fopen(nomeEntrada, "rb");
-    if (!entrada) {
-        fclose(saida);
+//GRAVA UM BYTE INTEIRO, ALINHANDO ANTES OS BITS PENDENTES
+void escreverByteEscritor(EscritorBits *escritor, uint8_t byte) {
+    if (escritor->bitsNoAcumulador)
+        alinharEscritor(escritor);
+    gravarByteBuffer(escritor, byte);
+}
+
+//GRAVA UMA SEQUÊNCIA DE BYTES, ALINHANDO ANTES OS BITS PENDENTES
+void escreverBytesEscritor(EscritorBits *escritor, const void *dados, size_t tamanho) {
+    const uint8_t *origem = dados;
+    if (escritor->bitsNoAcumulador)
+        alinharEscritor(escritor);
+
+    // Trechos maiores que o buffer vão direto para o arquivo
+    if (escritor->arquivo && tamanho >= escritor->capacidade) {
+        descarregarEscritor(escritor);
+        fwrite(origem, 1, tamanho, escritor->arquivo);
         return;
     }
+    while (tamanho > 0) {
+        if (escritor->posicao == escritor->capacidade)
+            descarregarEscritor(escritor);
+        size_t parte = escritor->capacidade - escritor->posicao;
+        if (parte > tamanho) parte = tamanho;
+        memcpy(escritor->buffer + escritor->posicao, origem, parte);
+        escritor->posicao += parte;
+        origem += parte;
+        tamanho -= parte;
+    }
+}
 
-    ControladorBits controlador;
-    inicializarControlador(&controlador, saida);
-
-    int caractere;
-    while ((caractere = fgetc(entrada)) != EOF) {
-        char *codigo = tabelaCodigos[caractere];
-        for (int i = 0; codigo[i] != '\0'; i++)
-            escreverBit(&controlador, codigo[i] - '0');
+//COMPLETA O ÚLTIMO BYTE COM ZEROS E GRAVA O QUE RESTA NO ARQUIVO; SEM ARQUIVO, 'posicao' FICA COM O TOTAL ESCRITO
+void finalizarEscritor(EscritorBits *escritor) {
+    alinharEscritor(escritor);
+    if (escritor->arquivo) {
+        fwrite(escritor->buffer, 1, escritor->posicao, escritor->arquivo);
+        escritor->posicao = 0;
+    }
+    if (escritor->bufferProprio) {
+        free(escritor->buffer);
+        escritor->buffer = NULL;
     }
+}
 
-    finalizarEscrita(&controlador);
-    int bitsLixo = (8 - (controlador.totalBits % 8)) % 8;
-    unsigned short cabecalho = (bitsLixo << 13) | (tamanhoArvore & 0x1FFF);
+// ----------------------------------------------------
+// Funções para leitura de bits do arquivo
+// ----------------------------------------------------
 
-    fseek(saida, 0, SEEK_SET);
-    fputc((cabecalho >> 8) & 0xFF, saida);
-    fputc(cabecalho & 0xFF, saida);
+//INICIALIZA O LEITOR DE BITS COM UM BUFFER GRANDE SOBRE O ARQUIVO
+int inicializarLeitor(LeitorBits *leitor, FILE *arquivo) {
+    leitor->arquivo = arquivo;
+    leitor->buffer = malloc(TAMANHO_BUFFER_GRANDE);
+    leitor->tamanho = 0;
+    leitor->posicao = 0;
+    leitor->acumulador = 0;
+    leitor->bitsNoAcumulador = 0;
+    leitor->fimArquivo = 0;
+    leitor->bufferProprio = 1;
+    return leitor->buffer != NULL;
+}
 
-    fclose(entrada);
-    fclose(saida);
+//INICIALIZA O LEITOR DE BITS SOBRE DADOS JÁ CARREGADOS NA MEMÓRIA, SEM ARQUIVO
+void inicializarLeitorMemoria(LeitorBits *leitor, const uint8_t *dados, size_t tamanho) {
+    leitor->arquivo = NULL;
+    // O leitor nunca escreve no buffer
+    leitor->buffer = (uint8_t *)dados;
+    leitor->tamanho = tamanho;
+    leitor->posicao = 0;
+    leitor->acumulador = 0;
+    leitor->bitsNoAcumulador = 0;
+    leitor->fimArquivo = tamanho == 0;
+    leitor->bufferProprio = 0;
 }
 
-//LÊ O CABEÇALHO DE UM ARQUIVO COMPACTADO, EXTRAINDO INFORMAÇÕES DO CONTROLE
-void lerCabecalho(FILE *arquivo, int *bitsLixo, int *tamanhoArvore) {
-    fseek(arquivo, 0, SEEK_SET);
-    int byte1 = fgetc(arquivo);
-    int byte2 = fgetc(arquivo);
-    *bitsLixo = byte1 >> 5;
-    *tamanhoArvore = (byte1 & 0x1F) << 8 | byte2;
+//LÊ O PRÓXIMO BLOCO DO ARQUIVO, MARCANDO O FIM QUANDO NÃO HÁ MAIS DADOS
+static void carregarBlocoLeitor(LeitorBits *leitor) {
+    leitor->tamanho = leitor->arquivo ? fread(leitor->buffer, 1, TAMANHO_BUFFER_GRANDE, leitor->arquivo) : 0;
+    leitor->posicao = 0;
+    if (leitor->tamanho == 0)
+        leitor->fimArquivo = 1;
 }
 
-//RECONSTROI A ÁRVORE A PARTIR DE ARQUIVOS SEREALIZADOS
-No *lerNo(FILE *arquivo) {
-    int caractere = fgetc(arquivo);
-    if (caractere == EOF) return NULL;
+//LÊ 8 BYTES COMO UM INTEIRO COM O PRIMEIRO BYTE NOS BITS MAIS ALTOS
+static inline uint64_t lerPalavraBigEndian(const uint8_t *p) {
+    return (uint64_t)p[0] << 56 | (uint64_t)p[1] << 48 | (uint64_t)p[2] << 40 | (uint64_t)p[3] << 32 |
+           (uint64_t)p[4] << 24 | (uint64_t)p[5] << 16 | (uint64_t)p[6] << 8 | (uint64_t)p[7];
+}
 
-    if (caractere == '\\') {
-        return criarFolha(fgetc(arquivo), 0);
-    } else if (caractere == '*') {
-        No *no = malloc(sizeof(No));
-        no->esquerda = lerNo(arquivo);
-        no->direita = lerNo(arquivo);
-        return no;
+//CARREGA UMA PALAVRA INTEIRA E AVANÇA APENAS OS BYTES QUE COUBERAM NO ACUMULADOR; EXIGE 8 BYTES NO BUFFER
+static inline void recarregarPalavra(LeitorBits *leitor) {
+    leitor->acumulador |= lerPalavraBigEndian(leitor->buffer + leitor->posicao) >> leitor->bitsNoAcumulador;
+    leitor->posicao += (63 - leitor->bitsNoAcumulador) >> 3;
+    leitor->bitsNoAcumulador |= 56;
+}
+
+//COMPLETA O ACUMULADOR ATÉ PELO MENOS 57 BITS, OU ATÉ ACABAR O ARQUIVO
+void recarregarLeitor(LeitorBits *leitor) {
+    if (leitor->posicao + 8 <= leitor->tamanho) {
+        recarregarPalavra(leitor);
     } else {
-        return criarFolha(caractere, 0);
+        while (leitor->bitsNoAcumulador <= 56 && !leitor->fimArquivo) {
+            if (leitor->posicao == leitor->tamanho) {
+                carregarBlocoLeitor(leitor);
+                continue;
+            }
+            leitor->acumulador |= (uint64_t)leitor->buffer[leitor->posicao++] << (56 - leitor->bitsNoAcumulador);
+            leitor->bitsNoAcumulador += 8;
+        }
     }
+    // Descobre o fim assim que o buffer acaba, para que o último byte seja conhecido
+    if (leitor->posicao == leitor->tamanho && !leitor->fimArquivo)
+        carregarBlocoLeitor(leitor);
 }
 
-//DECODIFICA DADOS COMPACTADOS EM BITS, ATRAVESSANDO A ÁRVORE DE HUFFMAN
-void decodificarBits(FILE *entrada, FILE *saida, No *raiz, int bitsLixo) {
-    No *atual = raiz;
-    uint8_t byteAtual, proximoByte;
-    int finalizado = 0;
-
-    size_t leitura = fread(&byteAtual, 1, 1, entrada);
-    if (leitura != 1) return;
+//DESCARTA OS BITS QUE RESTAM DO BYTE ATUAL PARA VOLTAR A LER BYTES INTEIROS
+static void alinharLeitor(LeitorBits *leitor) {
+    int resto = leitor->bitsNoAcumulador % 8;
+    leitor->acumulador <<= resto;
+    leitor->bitsNoAcumulador -= resto;
+}
 
-    while (!finalizado) {
-        size_t leituraProx = fread(&proximoByte, 1, 1, entrada);
-        int bitsRestantes = (leituraProx == 1) ? 8 : 8 - bitsLixo;
-        finalizado = (leituraProx != 1);
+//LÊ UM BYTE INTEIRO APÓS ALINHAR O LEITOR; RETORNA EOF NO FIM DOS DADOS
+int lerByteLeitor(LeitorBits *leitor) {
+    alinharLeitor(leitor);
+    if (leitor->bitsNoAcumulador >= 8) {
+        int byte = (int)(leitor->acumulador >> 56);
+        leitor->acumulador <<= 8;
+        leitor->bitsNoAcumulador -= 8;
+        return byte;
+    }
+    // O acumulador pode conter cópias dos próximos bytes; ao ler direto do buffer ele é zerado
+    leitor->acumulador = 0;
+    if (leitor->posicao == leitor->tamanho) {
+        if (leitor->fimArquivo) return EOF;
+        carregarBlocoLeitor(leitor);
+        if (leitor->fimArquivo) return EOF;
+    }
+    return leitor->buffer[leitor->posicao++];
+}
 
-        for (int i = 7; i >= 8 - bitsRestantes; i--) {
-            int bit = (byteAtual >> i) & 1;
-            atual = (bit == 0) ? atual->esquerda : atual->direita;
+//LÊ ATÉ 'tamanho' BYTES INTEIROS APÓS ALINHAR O LEITOR; RETORNA QUANTOS FORAM LIDOS
+size_t lerBytesLeitor(LeitorBits *leitor, void *destino, size_t tamanho) {
+    uint8_t *saida = destino;
+    size_t lidos = 0;
+    alinharLeitor(leitor);
+    while (lidos < tamanho && leitor->bitsNoAcumulador >= 8) {
+        saida[lidos++] = (uint8_t)(leitor->acumulador >> 56);
+        leitor->acumulador <<= 8;
+        leitor->bitsNoAcumulador -= 8;
+    }
+    if (lidos == tamanho) return lidos;
 
-            if (!atual->esquerda && !atual->direita) {
-                fputc(atual->simbolo, saida);
-                atual = raiz;
+    leitor->acumulador = 0;
+    while (lidos < tamanho) {
+        if (leitor->posicao == leitor->tamanho) {
+            if (leitor->fimArquivo) break;
+            // Trechos maiores que o buffer vão direto do arquivo para o destino
+            if (leitor->arquivo && tamanho - lidos >= TAMANHO_BUFFER_GRANDE) {
+                lidos += fread(saida + lidos, 1, tamanho - lidos, leitor->arquivo);
+                if (lidos < tamanho) leitor->fimArquivo = 1;
+                break;
             }
+            carregarBlocoLeitor(leitor);
+            continue;
         }
-        byteAtual = proximoByte;
+        size_t parte = leitor->tamanho - leitor->posicao;
+        if (parte > tamanho - lidos) parte = tamanho - lidos;
+        memcpy(saida + lidos, leitor->buffer + leitor->posicao, parte);
+        leitor->posicao += parte;
+        lidos += parte;
     }
+    return lidos;
 }
 
-// Descompacta um arquivo Huffman, lendo do arquivo de entrada e escrevendo no arquivo de saída
-void descompactarHuffman(const char *nomeEntrada, const char *nomeSaida) {
-    // Abre o arquivo compactado para leitura binária
-    FILE *entrada = fopen(nomeEntrada, "rb");
-    if (!entrada) 
-        return;  // Se não conseguir abrir, aborta
+//LIBERA O BUFFER DO LEITOR DE BITS
+void liberarLeitor(LeitorBits *leitor) {
+    if (leitor->bufferProprio)
+        free(leitor->buffer);
+    leitor->buffer = NULL;
+}
 
-    // Abre/Cria o arquivo de saída para escrita binária
-    FILE *saida = fopen(nomeSaida, "wb");
-    if (!saida) {
-        fclose(entrada);
-        return;  // Se falhar, garante fechar o de entrada antes de sair
+// ----------------------------------------------------
+// Funções para mapeamento do arquivo de entrada
+// ----------------------------------------------------
+
+//MAPEIA O ARQUIVO PARA LEITURA SEQUENCIAL A PARTIR DA POSIÇÃO ATUAL; RETORNA 0 PARA PIPES E ARQUIVOS VAZIOS
+int mapearArquivo(FILE *arquivo, MapeamentoArquivo *mapeamento) {
+    struct stat informacoes;
+    memset(mapeamento, 0, sizeof(MapeamentoArquivo));
+    off_t posicao = ftello(arquivo);
+    if (posicao < 0 || fstat(fileno(arquivo), &informacoes) != 0 || !S_ISREG(informacoes.st_mode) ||
+        informacoes.st_size <= posicao || (uint64_t)informacoes.st_size > SIZE_MAX)
+        return 0;
+
+    size_t tamanho = (size_t)informacoes.st_size;
+    void *base = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, fileno(arquivo), 0);
+    if (base == MAP_FAILED) return 0;
+    // O arquivo é percorrido do início ao fim: o kernel pode ler bem adiante e liberar o que ficou para trás
+    madvise(base, tamanho, MADV_SEQUENTIAL);
+
+    mapeamento->base = base;
+    mapeamento->tamanhoMapeado = tamanho;
+    mapeamento->dados = (const uint8_t *)base + posicao;
+    mapeamento->tamanho = tamanho - (size_t)posicao;
+    return 1;
+}
+
+//DESFAZ O MAPEAMENTO
+void desmapearArquivo(MapeamentoArquivo *mapeamento) {
+    if (mapeamento->base)
+        munmap(mapeamento->base, mapeamento->tamanhoMapeado);
+    memset(mapeamento, 0, sizeof(MapeamentoArquivo));
+}
+
+// ----------------------------------------------------
+// Funções para o grupo de threads
+// ----------------------------------------------------
+
+//QUANTIDADE DE PROCESSADORES DISPONÍVEIS, USADA QUANDO O NÚMERO DE THREADS NÃO É INFORMADO
+int threadsDisponiveis(void) {
+    long quantidade = sysconf(_SC_NPROCESSORS_ONLN);
+    return quantidade > 0 ? (int)quantidade : 1;
+}
+
+//LAÇO DE CADA THREAD: RETIRA TAREFAS DA FILA ATÉ O GRUPO SER ENCERRADO
+static void *executarThread(void *argumento) {
+    GrupoThreads *grupo = argumento;
+    pthread_mutex_lock(&grupo->trava);
+    for (;;) {
+        while (grupo->tamanhoFila == 0 && !grupo->encerrar)
+            pthread_cond_wait(&grupo->temTarefa, &grupo->trava);
+        if (grupo->tamanhoFila == 0) break;
+
+        Tarefa tarefa = grupo->fila[grupo->inicioFila];
+        grupo->inicioFila = (grupo->inicioFila + 1) % grupo->capacidadeFila;
+        grupo->tamanhoFila--;
+        pthread_mutex_unlock(&grupo->trava);
+
+        tarefa.funcao(tarefa.argumento);
+
+        pthread_mutex_lock(&grupo->trava);
+        if (--grupo->pendentes == 0)
+            pthread_cond_broadcast(&grupo->concluidas);
     }
+    pthread_mutex_unlock(&grupo->trava);
+    return NULL;
+}
 
-    // Lê os dois primeiros bytes e extrai:
-    //  - bitsLixo: quantos zeros foram adicionados no último byte
-    //  - tamanhoArvore: quantos bytes a serialização da árvore ocupa
-    int bitsLixo, tamanhoArvore;
-    lerCabecalho(entrada, &bitsLixo, &tamanhoArvore);
+//CRIA UM GRUPO COM 'quantidade' THREADS; COM MENOS DE DUAS, AS TAREFAS RODAM NA PRÓPRIA CHAMADA
+GrupoThreads *criarGrupoThreads(int quantidade) {
+    GrupoThreads *grupo = calloc(1, sizeof(GrupoThreads));
+    if (!grupo) return NULL;
+    pthread_mutex_init(&grupo->trava, NULL);
+    pthread_cond_init(&grupo->temTarefa, NULL);
+    pthread_cond_init(&grupo->concluidas, NULL);
+    if (quantidade < 2) return grupo;
 
-    // Reconstrói a árvore de Huffman a partir dos próximos bytes (percurso pré-ordem)
-    No *raiz = lerNo(entrada);
-    if (!raiz) {
-        // Se não conseguir ler a árvore, aborta e fecha arquivos
-        fclose(entrada);
-        fclose(saida);
+    grupo->threads = malloc(quantidade * sizeof(pthread_t));
+    if (!grupo->threads) return grupo;
+    // Se alguma thread não puder ser criada, o grupo segue com as que já existem
+    while (grupo->quantidadeThreads < quantidade &&
+           pthread_create(&grupo->threads[grupo->quantidadeThreads], NULL, executarThread, grupo) == 0)
+        grupo->quantidadeThreads++;
+    return grupo;
+}
+
+//DOBRA A FILA CIRCULAR, MANTENDO A ORDEM DAS TAREFAS; RETORNA 0 SE NÃO HOUVER MEMÓRIA
+static int aumentarFila(GrupoThreads *grupo) {
+    int capacidade = grupo->capacidadeFila ? 2 * grupo->capacidadeFila : 16;
+    Tarefa *fila = malloc(capacidade * sizeof(Tarefa));
+    if (!fila) return 0;
+    for (int i = 0; i < grupo->tamanhoFila; i++)
+        fila[i] = grupo->fila[(grupo->inicioFila + i) % grupo->capacidadeFila];
+    free(grupo->fila);
+    grupo->fila = fila;
+    grupo->capacidadeFila = capacidade;
+    grupo->inicioFila = 0;
+    return 1;
+}
+
+//COLOCA UMA TAREFA NA FILA; SEM THREADS OU SEM MEMÓRIA PARA A FILA, EXECUTA NA PRÓPRIA CHAMADA
+void enviarTarefa(GrupoThreads *grupo, FuncaoTarefa funcao, void *argumento) {
+    if (grupo->quantidadeThreads == 0) {
+        funcao(argumento);
+        return;
+    }
+    pthread_mutex_lock(&grupo->trava);
+    if (grupo->tamanhoFila == grupo->capacidadeFila && !aumentarFila(grupo)) {
+        pthread_mutex_unlock(&grupo->trava);
+        funcao(argumento);
         return;
     }
+    grupo->fila[(grupo->inicioFila + grupo->tamanhoFila) % grupo->capacidadeFila] = (Tarefa){funcao, argumento};
+    grupo->tamanhoFila++;
+    grupo->pendentes++;
+    pthread_cond_signal(&grupo->temTarefa);
+    pthread_mutex_unlock(&grupo->trava);
+}
 
-    // Percorre o fluxo de bits restante, decodificando cada bit
-    // e escrevendo símbolo a símbolo no arquivo de saída
-    decodificarBits(entrada, saida, raiz, bitsLixo);
+//ESPERA ATÉ QUE TODAS AS TAREFAS ENVIADAS TERMINEM
+void aguardarTarefas(GrupoThreads *grupo) {
+    pthread_mutex_lock(&grupo->trava);
+    while (grupo->pendentes > 0)
+        pthread_cond_wait(&grupo->concluidas, &grupo->trava);
+    pthread_mutex_unlock(&grupo->trava);
+}
 
-    // Fecha ambos os arquivos ao final da operação
-    fclose(entrada);
-    fclose(saida);
+//ENCERRA AS THREADS DEPOIS DE ESVAZIAR A FILA E LIBERA O GRUPO
+void destruirGrupoThreads(GrupoThreads *grupo) {
+    if (!grupo) return;
+    pthread_mutex_lock(&grupo->trava);
+    grupo->encerrar = 1;
+    pthread_cond_broadcast(&grupo->temTarefa);
+    pthread_mutex_unlock(&grupo->trava);
+    for (int i = 0; i < grupo->quantidadeThreads; i++)
+        pthread_join(grupo->threads[i], NULL);
+
+    pthread_mutex_destroy(&grupo->trava);
+    pthread_cond_destroy(&grupo->temTarefa);
+    pthread_cond_destroy(&grupo->concluidas);
+    free(grupo->threads);
+    free(grupo->fila);
+    free(grupo);
 }
 
-//GERA AUTOMATICAMENTE O NOME DE SAIDA .HUFF
-void gerarNomeArquivoComExtensaoHuff(char *entrada, char *saida) {
-    const char *ext = strrchr(entrada, '.');
-    size_t len = ext ? (size_t)(ext - entrada) : strlen(entrada);
-    memcpy(saida, entrada, len);
-    strcpy(saida + len, ".huff");
+// ----------------------------------------------------
+// Funções para o codificador tANS
+// ----------------------------------------------------
+
+// Entrada da tabela de decodificação do tANS: o símbolo do estado e como chegar ao próximo estado
+typedef struct {
+    uint8_t simbolo;
+    uint8_t bits;
+    uint16_t base;
+} EntradaTans;
+
+//POSIÇÃO DO BIT MAIS ALTO DE UM VALOR POSITIVO
+static int bitMaisAlto(uint32_t valor) {
+    int posicao = 0;
+    while (valor >>= 1) posicao++;
+    return posicao;
+}
+
+//LOGARITMO NA BASE 2 EM PONTO FIXO 16.16, PARA ESTIMAR O CUSTO DO tANS SEM PONTO FLUTUANTE
+static uint32_t log2Fixo(uint32_t valor) {
+    int inteiro = bitMaisAlto(valor);
+    uint32_t resultado = (uint32_t)inteiro << 16;
+    // Mantissa em [1, 2) com 31 bits de fração: cada quadrado que passa de 2 revela um bit da fração
+    uint64_t mantissa = (uint64_t)valor << (31 - inteiro);
+    for (int bit = 15; bit >= 0; bit--) {
+        mantissa = (mantissa * mantissa) >> 31;
+        if (mantissa >= ((uint64_t)1 << 32)) {
+            mantissa >>= 1;
+            resultado |= 1u << bit;
+        }
+    }
+    return resultado;
+}
+
+//ESCOLHE O TAMANHO DA TABELA: MENOR EM BLOCOS PEQUENOS, MAS COM PELO MENOS UM ESTADO POR SÍMBOLO USADO
+static int escolherBitsTans(size_t tamanho, int usados) {
+    int bits = TANS_BITS_TABELA;
+    while (bits > TANS_BITS_MINIMO && ((size_t)1 << bits) > tamanho) bits--;
+    while ((1 << bits) < usados) bits++;
+    return bits;
+}
+
+//DISTRIBUI OS 2^bitsTabela ESTADOS NA PROPORÇÃO DAS FREQUÊNCIAS, COM PELO MENOS UM POR SÍMBOLO USADO
+static void normalizarFrequencias(const uint64_t frequencias[], uint64_t total, int bitsTabela,
+                                  uint16_t normalizadas[]) {
+    int tamanhoTabela = 1 << bitsTabela, soma = 0, maior = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++) {
+        normalizadas[s] = 0;
+        if (!frequencias[s]) continue;
+        uint64_t proporcional = (frequencias[s] * (uint64_t)tamanhoTabela + total / 2) / total;
+        normalizadas[s] = proporcional ? (uint16_t)proporcional : 1;
+        soma += normalizadas[s];
+        if (normalizadas[s] > normalizadas[maior]) maior = s;
+    }
+
+    // A sobra do arredondamento vai para o símbolo mais frequente; o excesso sai dos que têm mais estados
+    if (soma < tamanhoTabela) normalizadas[maior] += (uint16_t)(tamanhoTabela - soma);
+    while (soma > tamanhoTabela) {
+        maior = 0;
+        for (int s = 1; s < TAMANHO_TABELA; s++)
+            if (normalizadas[s] > normalizadas[maior]) maior = s;
+        normalizadas[maior]--;
+        soma--;
+    }
+}
+
+//BITS ESPERADOS PARA O BLOCO COM A DISTRIBUIÇÃO NORMALIZADA: CADA SÍMBOLO CUSTA bitsTabela - log2(estados)
+static uint64_t estimarBitsTans(const uint64_t frequencias[], const uint16_t normalizadas[], int bitsTabela) {
+    uint64_t total = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        if (frequencias[s])
+            total += frequencias[s] * (((uint32_t)bitsTabela << 16) - log2Fixo(normalizadas[s]));
+    return total >> 16;
+}
+
+//ESPALHA OS SÍMBOLOS PELA TABELA COM UM PASSO ÍMPAR, QUE VISITA TODAS AS POSIÇÕES E MISTURA OS SÍMBOLOS
+static void espalharSimbolos(const uint16_t normalizadas[], int bitsTabela, uint8_t espalhados[]) {
+    int tamanhoTabela = 1 << bitsTabela;
+    int passo = (tamanhoTabela >> 1) + (tamanhoTabela >> 3) + 3;
+    int posicao = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++) {
+        for (int i = 0; i < normalizadas[s]; i++) {
+            espalhados[posicao] = (uint8_t)s;
+            posicao = (posicao + passo) & (tamanhoTabela - 1);
+        }
+    }
+}
+
+//GRAVA A TABELA DO tANS: BITS DA TABELA E PREENCHIMENTO INICIAL, SÍMBOLOS USADOS E ESTADOS DE CADA UM
+static void escreverTabelaTans(const uint16_t normalizadas[], int bitsTabela, int preenchimento,
+                               EscritorBits *escritor) {
+    int usados = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        if (normalizadas[s]) usados++;
+
+    escreverByteEscritor(escritor, (uint8_t)(bitsTabela | preenchimento << 4));
+    escreverByteEscritor(escritor, (uint8_t)(usados - 1));
+    // Poucos símbolos vão em lista; a partir de 32 o mapa de bits de 32 bytes é menor
+    if (usados < 32) {
+        for (int s = 0; s < TAMANHO_TABELA; s++)
+            if (normalizadas[s]) escreverByteEscritor(escritor, (uint8_t)s);
+    } else {
+        for (int s = 0; s < TAMANHO_TABELA; s += 8) {
+            uint8_t mapa = 0;
+            for (int i = 0; i < 8; i++)
+                if (normalizadas[s + i]) mapa |= (uint8_t)(0x80 >> i);
+            escreverByteEscritor(escritor, mapa);
+        }
+    }
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        if (normalizadas[s]) escreverVarint(escritor, normalizadas[s] - 1);
+}
+
+//LÊ A TABELA GRAVADA POR escreverTabelaTans, CONFERINDO QUE OS ESTADOS SOMAM 2^bitsTabela
+static int lerTabelaTans(LeitorBits *leitor, uint16_t normalizadas[], int *bitsTabela, int *preenchimento) {
+    int byte = lerByteLeitor(leitor);
+    int usados = lerByteLeitor(leitor);
+    if (byte == EOF || usados == EOF) return 0;
+    *bitsTabela = byte & 0x0F;
+    *preenchimento = byte >> 4;
+    usados++;
+    if (*bitsTabela < TANS_BITS_MINIMO || *bitsTabela > TANS_BITS_MAXIMO || *preenchimento > 7) return 0;
+
+    memset(normalizadas, 0, TAMANHO_TABELA * sizeof(uint16_t));
+    if (usados < 32) {
+        for (int i = 0; i < usados; i++) {
+            int simbolo = lerByteLeitor(leitor);
+            if (simbolo == EOF || normalizadas[simbolo]) return 0;
+            normalizadas[simbolo] = 1;
+        }
+    } else {
+        int marcados = 0;
+        for (int s = 0; s < TAMANHO_TABELA; s += 8) {
+            int mapa = lerByteLeitor(leitor);
+            if (mapa == EOF) return 0;
+            for (int i = 0; i < 8; i++)
+                if (mapa & (0x80 >> i)) {
+                    normalizadas[s + i] = 1;
+                    marcados++;
+                }
+        }
+        if (marcados != usados) return 0;
+    }
+
+    uint64_t soma = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++) {
+        if (!normalizadas[s]) continue;
+        uint64_t estados;
+        if (!lerVarint(leitor, &estados) || estados >= ((uint64_t)1 << *bitsTabela)) return 0;
+        normalizadas[s] = (uint16_t)(estados + 1);
+        soma += estados + 1;
+    }
+    return soma == ((uint64_t)1 << *bitsTabela);
 }
 
+//MONTA A TABELA DE DECODIFICAÇÃO: A k-ÉSIMA OCORRÊNCIA DO SÍMBOLO s CORRESPONDE A x = estados(s) + k
+static void construirDecodificacaoTans(const uint16_t normalizadas[], int bitsTabela, EntradaTans tabela[]) {
+    int tamanhoTabela = 1 << bitsTabela;
+    uint8_t espalhados[1 << TANS_BITS_MAXIMO];
+    uint16_t proximo[TAMANHO_TABELA];
+    espalharSimbolos(normalizadas, bitsTabela, espalhados);
+    memcpy(proximo, normalizadas, sizeof(proximo));
+    for (int i = 0; i < tamanhoTabela; i++) {
+        uint8_t simbolo = espalhados[i];
+        uint32_t x = proximo[simbolo]++;
+        int bits = bitsTabela - bitMaisAlto(x);
+        tabela[i].simbolo = simbolo;
+        tabela[i].bits = (uint8_t)bits;
+        tabela[i].base = (uint16_t)((x << bits) - (uint32_t)tamanhoTabela);
+    }
+}
+
+//GRAVA 32 BITS EM BIG-ENDIAN
+static inline void gravarPalavraBigEndian(uint8_t *p, uint32_t valor) {
+    p[0] = (uint8_t)(valor >> 24);
+    p[1] = (uint8_t)(valor >> 16);
+    p[2] = (uint8_t)(valor >> 8);
+    p[3] = (uint8_t)valor;
+}
+
+//CODIFICA O BLOCO COM tANS EM 'destino' (TABELA SEGUIDA DOS BITS); RETORNA O TAMANHO, OU 0 SE PASSAR DE 'capacidade'.
+//OS SÍMBOLOS SÃO CODIFICADOS DO ÚLTIMO PARA O PRIMEIRO E CADA GRUPO DE BITS ENTRA NO INÍCIO DO FLUXO, PARA QUE O
+//DECODIFICADOR LEIA TUDO EM ORDEM. O SÍMBOLO i USA O ESTADO i % 4, E AS QUATRO CADEIAS SE DECODIFICAM EM PARALELO
+static size_t codificarTans(const uint8_t *dados, size_t tamanho, const uint16_t normalizadas[], int bitsTabela,
+                            uint8_t *destino, size_t capacidade) {
+    uint32_t tamanhoTabela = 1u << bitsTabela;
+    if (capacidade < MARGEM_TABELA_TANS + 16) return 0;
+
+    // Estados de codificação agrupados por símbolo, na ordem em que a decodificação numera as ocorrências
+    uint8_t espalhados[1 << TANS_BITS_MAXIMO];
+    uint16_t estados[1 << TANS_BITS_MAXIMO];
+    uint32_t inicio[TAMANHO_TABELA], ocupados[TAMANHO_TABELA] = {0};
+    int bitsMaximos[TAMANHO_TABELA];
+    uint32_t acumulado = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++) {
+        inicio[s] = acumulado;
+        acumulado += normalizadas[s];
+        bitsMaximos[s] = normalizadas[s] ? bitsTabela - bitMaisAlto(normalizadas[s]) : 0;
+    }
+    espalharSimbolos(normalizadas, bitsTabela, espalhados);
+    for (uint32_t i = 0; i < tamanhoTabela; i++) {
+        uint8_t simbolo = espalhados[i];
+        estados[inicio[simbolo] + ocupados[simbolo]++] = (uint16_t)(tamanhoTabela + i);
+    }
 
+    // O fluxo cresce do fim de 'destino' para trás; a margem do começo fica para a tabela
+    uint8_t *limite = destino + MARGEM_TABELA_TANS + 8;
+    uint8_t *posicao = destino + capacidade;
+    uint64_t acumulador = 0;
+    int bitsAcumulados = 0;
+    uint32_t estado[4] = {tamanhoTabela, tamanhoTabela, tamanhoTabela, tamanhoTabela};
 
+    for (size_t i = tamanho; i-- > 0;) {
+        uint32_t *x = &estado[i & 3];
+        uint8_t simbolo = dados[i];
+        // Reduz o estado ao intervalo [estados, 2 * estados) do símbolo, emitindo os bits de baixo
+        int bits = bitsMaximos[simbolo] - ((*x >> bitsMaximos[simbolo]) < normalizadas[simbolo]);
+        acumulador |= (uint64_t)(*x & ((1u << bits) - 1)) << bitsAcumulados;
+        bitsAcumulados += bits;
+        *x = estados[inicio[simbolo] + (*x >> bits) - normalizadas[simbolo]];
+        if (bitsAcumulados >= 32) {
+            if (posicao < limite) return 0;
+            posicao -= 4;
+            gravarPalavraBigEndian(posicao, (uint32_t)acumulador);
+            acumulador >>= 32;
+            bitsAcumulados -= 32;
+        }
+    }
+
+    // Os estados finais abrem o fluxo: o decodificador lê o do sub-fluxo 0 primeiro
+    for (int j = 3; j >= 0; j--) {
+        acumulador |= (uint64_t)(estado[j] - tamanhoTabela) << bitsAcumulados;
+        bitsAcumulados += bitsTabela;
+        while (bitsAcumulados >= 8) {
+            if (posicao <= limite) return 0;
+            *--posicao = (uint8_t)acumulador;
+            acumulador >>= 8;
+            bitsAcumulados -= 8;
+        }
+    }
+    int preenchimento = 0;
+    if (bitsAcumulados > 0) {
+        if (posicao <= limite) return 0;
+        *--posicao = (uint8_t)acumulador;
+        preenchimento = 8 - bitsAcumulados;
+    }
+
+    EscritorBits escritor;
+    inicializarEscritorMemoria(&escritor, destino, MARGEM_TABELA_TANS);
+    escreverTabelaTans(normalizadas, bitsTabela, preenchimento, &escritor);
+    finalizarEscritor(&escritor);
+    size_t tamanhoFluxo = (size_t)(destino + capacidade - posicao);
+    memmove(destino + escritor.posicao, posicao, tamanhoFluxo);
+    return escritor.posicao + tamanhoFluxo;
+}
+
+//AVANÇA UM ESTADO DO tANS, DEVOLVENDO O SÍMBOLO DELE. O DESLOCAMENTO EM DUAS ETAPAS ACEITA ZERO BITS
+static inline uint8_t passoTans(const EntradaTans tabela[], uint32_t *estado, LeitorBits *leitor) {
+    EntradaTans entrada = tabela[*estado];
+    *estado = entrada.base + (uint32_t)((leitor->acumulador >> 1) >> (63 - entrada.bits));
+    leitor->acumulador <<= entrada.bits;
+    leitor->bitsNoAcumulador -= entrada.bits;
+    return entrada.simbolo;
+}
+
+//DECODIFICA OS 'quantidade' PRIMEIROS SÍMBOLOS DE UM CORPO GRAVADO POR codificarTans
+static int decodificarTans(const uint8_t *corpo, size_t tamanhoCorpo, uint8_t *destino, size_t quantidade) {
+    LeitorBits leitor;
+    uint16_t normalizadas[TAMANHO_TABELA];
+    int bitsTabela, preenchimento;
+    inicializarLeitorMemoria(&leitor, corpo, tamanhoCorpo);
+    if (!lerTabelaTans(&leitor, normalizadas, &bitsTabela, &preenchimento)) return 0;
+
+    EntradaTans *tabela = malloc(sizeof(EntradaTans) << bitsTabela);
+    if (!tabela) return 0;
+    construirDecodificacaoTans(normalizadas, bitsTabela, tabela);
+
+    // Depois da tabela vêm o preenchimento e os quatro estados iniciais
+    recarregarLeitor(&leitor);
+    if (leitor.bitsNoAcumulador < preenchimento + 4 * bitsTabela) {
+        free(tabela);
+        return 0;
+    }
+    leitor.acumulador <<= preenchimento;
+    leitor.bitsNoAcumulador -= preenchimento;
+    uint32_t estados[4];
+    for (int j = 0; j < 4; j++) {
+        estados[j] = (uint32_t)(leitor.acumulador >> (64 - bitsTabela));
+        leitor.acumulador <<= bitsTabela;
+        leitor.bitsNoAcumulador -= bitsTabela;
+    }
+
+    // Cópias locais, como nos quatro sub-fluxos do Huffman: as gravações em 'destino' não as alcançam. Cada
+    // recarga garante 56 bits, o bastante para quatro passos de até TANS_BITS_MAXIMO bits
+    LeitorBits local = leitor;
+    uint32_t e0 = estados[0], e1 = estados[1], e2 = estados[2], e3 = estados[3];
+    size_t posicao = 0;
+    while (quantidade - posicao >= 4 && local.posicao + 8 <= local.tamanho) {
+        recarregarPalavra(&local);
+        destino[posicao] = passoTans(tabela, &e0, &local);
+        destino[posicao + 1] = passoTans(tabela, &e1, &local);
+        destino[posicao + 2] = passoTans(tabela, &e2, &local);
+        destino[posicao + 3] = passoTans(tabela, &e3, &local);
+        posicao += 4;
+    }
+    leitor = local;
+    estados[0] = e0;
+    estados[1] = e1;
+    estados[2] = e2;
+    estados[3] = e3;
+
+    int sucesso = 1;
+    for (; posicao < quantidade; posicao++) {
+        uint32_t *estado = &estados[posicao & 3];
+        if (leitor.bitsNoAcumulador < TANS_BITS_MAXIMO)
+            recarregarLeitor(&leitor);
+        if (tabela[*estado].bits > leitor.bitsNoAcumulador) {
+            sucesso = 0;
+            break;
+        }
+        destino[posicao] = passoTans(tabela, estado, &leitor);
+    }
+    free(tabela);
+    return sucesso;
+}
+
+// ----------------------------------------------------
+// Funções para instrumentação
+// ----------------------------------------------------
+
+//INSTANTE ATUAL EM SEGUNDOS, PELO RELÓGIO MONOTÔNICO
+static double relogio(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (double)agora.tv_sec + (double)agora.tv_nsec * 1e-9;
+}
+
+//INÍCIO DA PRIMEIRA FASE; SEM TEMPOS A MEDIR, O RELÓGIO NÃO É LIDO
+static inline double iniciarFases(double segundosFase[]) {
+    return segundosFase ? relogio() : 0;
+}
+
+//SOMA À FASE O TEMPO DESDE 'inicio' E DEVOLVE O INSTANTE ATUAL, QUE É O INÍCIO DA FASE SEGUINTE
+static inline double marcarFase(double segundosFase[], FaseCodec fase, double inicio) {
+    if (!segundosFase) return 0;
+    double agora = relogio();
+    segundosFase[fase] += agora - inicio;
+    return agora;
+}
+
+//LOGARITMO NA BASE 2 DE UM INTEIRO DE 64 BITS, COM A PRECISÃO DE log2Fixo
+static double log2Aproximado(uint64_t valor) {
+    int deslocamento = 0;
+    while (valor >> 32) {
+        valor >>= 1;
+        deslocamento++;
+    }
+    return deslocamento + log2Fixo((uint32_t)valor) / 65536.0;
+}
+
+//BITS QUE UM CODIFICADOR DE ORDEM 0 IDEAL GASTARIA COM O HISTOGRAMA: A SOMA DE f * log2(total / f)
+static double calcularBitsEntropia(const uint64_t frequencias[]) {
+    uint64_t total = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        total += frequencias[s];
+    if (total == 0) return 0;
+    double log2Total = log2Aproximado(total), bits = 0;
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        if (frequencias[s]) bits += (double)frequencias[s] * (log2Total - log2Aproximado(frequencias[s]));
+    return bits;
+}
+
+//ZERA AS ESTATÍSTICAS E DEVOLVE O INSTANTE EM QUE A OPERAÇÃO COMEÇOU; SEM ESTATÍSTICAS, NÃO LÊ O RELÓGIO
+static double iniciarEstatisticas(EstatisticasCodec *estatisticas) {
+    if (!estatisticas) return 0;
+    memset(estatisticas, 0, sizeof(EstatisticasCodec));
+    return relogio();
+}
+
+//ANOTA OS SÍMBOLOS, OS BITS DOS CÓDIGOS, A ENTROPIA E O MAIOR CÓDIGO DE UM HISTOGRAMA CODIFICADO POR INTEIRO
+static void anotarCodigos(EstatisticasCodec *estatisticas, const uint64_t frequencias[],
+                          const CodigoHuffman codigos[]) {
+    for (int s = 0; s < TAMANHO_TABELA; s++) {
+        if (!frequencias[s]) continue;
+        estatisticas->simbolos += frequencias[s];
+        estatisticas->bitsCodificados += frequencias[s] * codigos[s].tamanho;
+        if (codigos[s].tamanho > estatisticas->profundidadeMaxima)
+            estatisticas->profundidadeMaxima = codigos[s].tamanho;
+    }
+    estatisticas->bitsEntropia += calcularBitsEntropia(frequencias);
+}
+
+//SOMA AS FASES E OS CONTADORES DE UM BLOCO ÀS ESTATÍSTICAS E ZERA AS FASES DO BLOCO PARA O PRÓXIMO USO DA TAREFA
+static void somarEstatisticasBloco(EstatisticasCodec *estatisticas, RelatorioCompactacao *relatorio) {
+    for (int fase = 0; fase < TOTAL_FASES; fase++)
+        estatisticas->segundosFase[fase] += relatorio->segundosFase[fase];
+    memset(relatorio->segundosFase, 0, sizeof(relatorio->segundosFase));
+    estatisticas->bitsCodificados += relatorio->bitsCodificados;
+    estatisticas->bitsEntropia += relatorio->bitsEntropia;
+    if (relatorio->comprimentoMaximo > estatisticas->profundidadeMaxima)
+        estatisticas->profundidadeMaxima = relatorio->comprimentoMaximo;
+}
+
+//BYTES ENTRE 'inicio' E A POSIÇÃO ATUAL DO ARQUIVO; QUANDO A POSIÇÃO NÃO EXISTE (PIPES) OU NÃO AVANÇA
+//(/dev/null), FICA O VALOR 'contado'
+static uint64_t bytesDesde(FILE *arquivo, off_t inicio, uint64_t contado) {
+    off_t atual = inicio >= 0 ? ftello(arquivo) : -1;
+    return inicio >= 0 && atual > inicio ? (uint64_t)(atual - inicio) : contado;
+}
+
+//ESCREVE UM TEXTO ENTRE ASPAS, COM OS ESCAPES DO JSON
+static void escreverTextoJson(FILE *saida, const char *texto) {
+    fputc('"', saida);
+    for (const unsigned char *c = (const unsigned char *)texto; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fprintf(saida, "\\%c", *c);
+        else if (*c < 0x20)
+            fprintf(saida, "\\u%04x", *c);
+        else
+            fputc(*c, saida);
+    }
+    fputc('"', saida);
+}
+
+//ESCREVE AS ESTATÍSTICAS EM UMA LINHA JSON, COM O NOME DO ARQUIVO SE HOUVER. A VAZÃO É MEDIDA PELOS BYTES
+//ORIGINAIS: OS DE ENTRADA NA COMPACTAÇÃO E OS DE SAÍDA NAS OUTRAS OPERAÇÕES; SEM SÍMBOLOS CONTADOS, AS MÉDIAS SÃO null
+void escreverEstatisticasJson(FILE *saida, const char *operacao, const char *nome,
+                              const EstatisticasCodec *estatisticas) {
+    static const char *nomesFases[TOTAL_FASES] = {"leitura",   "histograma",  "arvore",        "codigos",
+                                                  "cabecalho", "codificacao", "decodificacao", "gravacao"};
+    int compactacao = strcmp(operacao, "compactar") == 0;
+    uint64_t originais = compactacao ? estatisticas->bytesEntrada : estatisticas->bytesSaida;
+    uint64_t compactados = compactacao ? estatisticas->bytesSaida : estatisticas->bytesEntrada;
+
+    // Várias threads podem escrever no mesmo arquivo: a linha sai inteira
+    flockfile(saida);
+    fprintf(saida, "{\"operacao\":");
+    escreverTextoJson(saida, operacao);
+    if (nome) {
+        fprintf(saida, ",\"arquivo\":");
+        escreverTextoJson(saida, nome);
+    }
+    fprintf(saida, ",\"bytes_entrada\":%llu,\"bytes_saida\":%llu,", (unsigned long long)estatisticas->bytesEntrada,
+            (unsigned long long)estatisticas->bytesSaida);
+    fprintf(saida, "\"razao\":%.6f,\"segundos\":%.6f,",
+            originais ? (double)compactados / (double)originais : 0.0, estatisticas->segundos);
+    fprintf(saida, "\"mb_por_segundo\":%.3f,",
+            estatisticas->segundos > 0 ? (double)originais / 1e6 / estatisticas->segundos : 0.0);
+    if (estatisticas->simbolos)
+        fprintf(saida, "\"comprimento_medio\":%.6f,\"entropia\":%.6f,\"profundidade_maxima\":%d,",
+                (double)estatisticas->bitsCodificados / (double)estatisticas->simbolos,
+                estatisticas->bitsEntropia / (double)estatisticas->simbolos, estatisticas->profundidadeMaxima);
+    else
+        fprintf(saida, "\"comprimento_medio\":null,\"entropia\":null,\"profundidade_maxima\":null,");
+    fprintf(saida, "\"fases\":{");
+    for (int fase = 0; fase < TOTAL_FASES; fase++)
+        fprintf(saida, "%s\"%s\":%.6f", fase ? "," : "", nomesFases[fase], estatisticas->segundosFase[fase]);
+    fprintf(saida, "}}\n");
+    funlockfile(saida);
+}
+
+// ----------------------------------------------------
+// Funções para o formato em blocos
+// ----------------------------------------------------
+
+//CONTA OS SÍMBOLOS COM CÓDIGO, GUARDANDO O ÚLTIMO DELES EM 'unico'
+static int contarSimbolosUsados(const uint8_t comprimentos[], int *unico) {
+    int usados = 0;
+    for (int i = 0; i < TAMANHO_TABELA; i++) {
+        if (comprimentos[i]) {
+            usados++;
+            *unico = i;
+        }
+    }
+    return usados;
+}
+
+//ESCOLHE OS TAMANHOS DOS CÓDIGOS DE UM HISTOGRAMA, RECORRENDO AO PACKAGE-MERGE SÓ QUANDO A ÁRVORE PASSA DO LIMITE
+static int escolherComprimentos(const uint64_t frequencias[], int comprimentoMaximo, uint8_t comprimentos[],
+                                RelatorioCompactacao *relatorio) {
+    ArenaNos *arena = criarArena();
+    if (!arena) return 0;
+    calcularComprimentos(construirArvoreHuffman(frequencias, arena), comprimentos);
+    liberarArena(arena);
+    uint64_t bitsSemLimite = contarBitsCodificados(frequencias, comprimentos);
+
+    int maior = 0;
+    for (int i = 0; i < TAMANHO_TABELA; i++)
+        if (comprimentos[i] > maior) maior = comprimentos[i];
+    if (comprimentoMaximo > 0 && maior > comprimentoMaximo) {
+        if (!calcularComprimentosLimitados(frequencias, comprimentoMaximo, comprimentos)) return 0;
+        maior = comprimentoMaximo;
+    }
+
+    if (relatorio) {
+        relatorio->bitsSemLimite = bitsSemLimite;
+        relatorio->bitsCodificados = contarBitsCodificados(frequencias, comprimentos);
+        relatorio->comprimentoMaximo = maior;
+    }
+    return 1;
+}
+
+// Modelo de ordem 1 de um bloco: um histograma por byte anterior e os grupos de contextos que dividem uma tabela
+typedef struct {
+    uint32_t histogramas[TAMANHO_TABELA][TAMANHO_TABELA];
+    uint64_t agrupados[MAXIMO_TABELAS_CONTEXTO][TAMANHO_TABELA];
+    uint8_t comprimentos[MAXIMO_TABELAS_CONTEXTO][TAMANHO_TABELA];
+    CodigoHuffman codigos[MAXIMO_TABELAS_CONTEXTO][TAMANHO_TABELA];
+    uint8_t mapa[TAMANHO_TABELA];
+    int grupos;
+} ModeloOrdem1;
+
+//SOMA OS HISTOGRAMAS DOS CONTEXTOS DE CADA GRUPO
+static void somarGrupos(ModeloOrdem1 *modelo, const uint64_t totais[]) {
+    memset(modelo->agrupados, 0, sizeof(modelo->agrupados));
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++) {
+        if (!totais[contexto]) continue;
+        uint64_t *grupo = modelo->agrupados[modelo->mapa[contexto]];
+        for (int s = 0; s < TAMANHO_TABELA; s++)
+            grupo[s] += modelo->histogramas[contexto][s];
+    }
+}
+
+//AGRUPA OS CONTEXTOS EM ATÉ MAXIMO_TABELAS_CONTEXTO GRUPOS POR K-MÉDIAS: AS SEMENTES SÃO OS CONTEXTOS MAIS
+//FREQUENTES, E CADA CONTEXTO VAI PARA O GRUPO CUJA DISTRIBUIÇÃO CODIFICA SEU HISTOGRAMA COM MENOS BITS
+static void agruparContextos(ModeloOrdem1 *modelo) {
+    uint64_t totais[TAMANHO_TABELA];
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++) {
+        totais[contexto] = 0;
+        for (int s = 0; s < TAMANHO_TABELA; s++)
+            totais[contexto] += modelo->histogramas[contexto][s];
+    }
+
+    int grupos = 0;
+    uint8_t semente[TAMANHO_TABELA] = {0};
+    memset(modelo->mapa, 0, sizeof(modelo->mapa));
+    while (grupos < MAXIMO_TABELAS_CONTEXTO) {
+        int maior = -1;
+        for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++)
+            if (totais[contexto] && !semente[contexto] && (maior < 0 || totais[contexto] > totais[maior]))
+                maior = contexto;
+        if (maior < 0) break;
+        semente[maior] = 1;
+        modelo->mapa[maior] = (uint8_t)grupos++;
+    }
+    // Até a primeira rodada, cada grupo tem só a sua semente
+    memset(modelo->agrupados, 0, sizeof(modelo->agrupados));
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++)
+        if (semente[contexto])
+            for (int s = 0; s < TAMANHO_TABELA; s++)
+                modelo->agrupados[modelo->mapa[contexto]][s] = modelo->histogramas[contexto][s];
+
+    for (int rodada = 0; rodada < RODADAS_AGRUPAMENTO; rodada++) {
+        // Custo de cada símbolo em cada grupo, em ponto fixo; a contagem extra cobre símbolos ausentes do grupo
+        uint32_t custos[MAXIMO_TABELAS_CONTEXTO][TAMANHO_TABELA];
+        for (int g = 0; g < grupos; g++) {
+            uint64_t total = 0;
+            for (int s = 0; s < TAMANHO_TABELA; s++) total += modelo->agrupados[g][s];
+            uint32_t log2Total = log2Fixo((uint32_t)(total + TAMANHO_TABELA));
+            for (int s = 0; s < TAMANHO_TABELA; s++)
+                custos[g][s] = log2Total - log2Fixo((uint32_t)modelo->agrupados[g][s] + 1);
+        }
+        for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++) {
+            if (!totais[contexto]) continue;
+            uint64_t menorCusto = UINT64_MAX;
+            for (int g = 0; g < grupos; g++) {
+                uint64_t custo = 0;
+                for (int s = 0; s < TAMANHO_TABELA; s++)
+                    custo += (uint64_t)modelo->histogramas[contexto][s] * custos[g][s];
+                if (custo < menorCusto) {
+                    menorCusto = custo;
+                    modelo->mapa[contexto] = (uint8_t)g;
+                }
+            }
+        }
+        somarGrupos(modelo, totais);
+    }
+
+    // Grupos que ficaram sem contextos são descartados e os demais renumerados
+    int novoNumero[MAXIMO_TABELAS_CONTEXTO], ocupados = 0;
+    for (int g = 0; g < grupos; g++) {
+        uint64_t total = 0;
+        for (int s = 0; s < TAMANHO_TABELA; s++) total += modelo->agrupados[g][s];
+        novoNumero[g] = total ? ocupados++ : 0;
+    }
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++)
+        modelo->mapa[contexto] = totais[contexto] ? (uint8_t)novoNumero[modelo->mapa[contexto]] : 0;
+    modelo->grupos = ocupados;
+    somarGrupos(modelo, totais);
+}
+
+//COMPACTA O BLOCO EM ORDEM 1 SE O CORPO FICAR MENOR QUE 'limite'. RETORNA 1 SE GRAVOU, 0 SE NÃO COMPENSOU E
+//-1 EM FALTA DE MEMÓRIA
+static int compactarBlocoOrdem1(const uint8_t *dados, size_t tamanho, size_t limite, EscritorBits *saida) {
+    ModeloOrdem1 *modelo = calloc(1, sizeof(ModeloOrdem1));
+    if (!modelo) return -1;
+    // O primeiro byte do bloco usa o contexto 0
+    uint8_t anterior = 0;
+    for (size_t i = 0; i < tamanho; i++) {
+        modelo->histogramas[anterior][dados[i]]++;
+        anterior = dados[i];
+    }
+    agruparContextos(modelo);
+
+    // Os códigos ficam em BITS_TABELA bits para que cada símbolo se resolva com uma consulta
+    uint64_t bits = 0;
+    for (int g = 0; g < modelo->grupos; g++) {
+        uint8_t *comprimentos = modelo->comprimentos[g];
+        int unico = 0;
+        if (!escolherComprimentos(modelo->agrupados[g], BITS_TABELA, comprimentos, NULL)) {
+            free(modelo);
+            return -1;
+        }
+        // Um grupo de um símbolo só ganha um código de um bit e um vizinho sem uso, para a tabela ficar completa
+        if (contarSimbolosUsados(comprimentos, &unico) == 1) {
+            comprimentos[unico] = 1;
+            comprimentos[unico ^ 1] = 1;
+        }
+        gerarCodigosCanonicos(comprimentos, modelo->codigos[g]);
+        for (int s = 0; s < TAMANHO_TABELA; s++)
+            bits += modelo->agrupados[g][s] * comprimentos[s];
+    }
+
+    uint8_t cabecalho[1 + TAMANHO_TABELA / 2 + MAXIMO_TABELAS_CONTEXTO * (1 + TAMANHO_TABELA)];
+    EscritorBits escritorCabecalho;
+    inicializarEscritorMemoria(&escritorCabecalho, cabecalho, sizeof(cabecalho));
+    escreverByteEscritor(&escritorCabecalho, (uint8_t)(modelo->grupos - 1));
+    int bitsMapa = modelo->grupos > 1 ? bitMaisAlto((uint32_t)modelo->grupos - 1) + 1 : 0;
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++)
+        escreverCodigo(&escritorCabecalho, modelo->mapa[contexto], bitsMapa);
+    alinharEscritor(&escritorCabecalho);
+    for (int g = 0; g < modelo->grupos; g++)
+        escreverComprimentos(modelo->comprimentos[g], &escritorCabecalho);
+    finalizarEscritor(&escritorCabecalho);
+    size_t tamanhoCorpo = escritorCabecalho.posicao + (size_t)((bits + 7) / 8);
+    if (tamanhoCorpo >= limite) {
+        free(modelo);
+        return 0;
+    }
+
+    escreverByteEscritor(saida, BLOCO_ORDEM1);
+    escreverVarint(saida, tamanho);
+    escreverVarint(saida, tamanhoCorpo);
+    escreverBytesEscritor(saida, cabecalho, escritorCabecalho.posicao);
+    const CodigoHuffman *codigosDoContexto[TAMANHO_TABELA];
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++)
+        codigosDoContexto[contexto] = modelo->codigos[modelo->mapa[contexto]];
+    anterior = 0;
+    for (size_t i = 0; i < tamanho; i++) {
+        const CodigoHuffman *codigo = &codigosDoContexto[anterior][dados[i]];
+        escreverCodigo(saida, codigo->bits, codigo->tamanho);
+        anterior = dados[i];
+    }
+    alinharEscritor(saida);
+    free(modelo);
+    return 1;
+}
+
+//COMPACTA UM BLOCO COM HISTOGRAMA E TABELA PRÓPRIOS: TIPO, TAMANHO ORIGINAL, TAMANHO DO CORPO E CORPO
+int compactarBloco(const uint8_t *dados, size_t tamanho, const OpcoesCompactacao *opcoes, EscritorBits *saida,
+                   RelatorioCompactacao *relatorio) {
+    if (tamanho > TAMANHO_BLOCO_MAXIMO) return 0;
+    double *fases = relatorio && opcoes->estatisticas ? relatorio->segundosFase : NULL;
+    double instante = iniciarFases(fases);
+
+    // Cada sub-histograma conta as posições de um resto da divisão por 4: somados formam o histograma do
+    // bloco e, separados, dão o tamanho de cada sub-fluxo intercalado
+    uint32_t sub[4][TAMANHO_TABELA];
+    uint64_t frequencias[TAMANHO_TABELA];
+    memset(sub, 0, sizeof(sub));
+    contarTrecho(dados, tamanho, sub);
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        frequencias[s] = (uint64_t)sub[0][s] + sub[1][s] + sub[2][s] + sub[3][s];
+    if (fases) relatorio->bitsEntropia = calcularBitsEntropia(frequencias);
+    instante = marcarFase(fases, FASE_HISTOGRAMA, instante);
+
+    // Os sub-fluxos são decodificados apenas pela tabela, então nenhum código passa de BITS_TABELA bits
+    int quatroFluxos = opcoes->quatroFluxos && tamanho >= TAMANHO_MINIMO_QUATRO_FLUXOS;
+    int comprimentoMaximo = opcoes->comprimentoMaximo;
+    if (quatroFluxos && (comprimentoMaximo == 0 || comprimentoMaximo > BITS_TABELA))
+        comprimentoMaximo = BITS_TABELA;
+
+    uint8_t comprimentos[TAMANHO_TABELA];
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    if (!escolherComprimentos(frequencias, comprimentoMaximo, comprimentos, relatorio)) return 0;
+    instante = marcarFase(fases, FASE_ARVORE, instante);
+    if (!gerarCodigosCanonicos(comprimentos, codigos)) return 0;
+    instante = marcarFase(fases, FASE_CODIGOS, instante);
+
+    // Um único símbolo dispensa os bits, como no formato canônico
+    int unico = 0;
+    int usados = contarSimbolosUsados(comprimentos, &unico);
+    if (usados <= 1) quatroFluxos = 0;
+
+    uint64_t bitsFluxo[4] = {0};
+    for (int j = 0; j < 4; j++)
+        for (int s = 0; s < TAMANHO_TABELA; s++)
+            bitsFluxo[j] += (uint64_t)sub[j][s] * comprimentos[s];
+
+    // A tabela (e, com quatro sub-fluxos, o tamanho dos três primeiros) é montada antes para que o tamanho
+    // do corpo vá no cabeçalho do bloco
+    uint8_t cabecalho[1 + TAMANHO_TABELA + 3 * 10];
+    EscritorBits escritorCabecalho;
+    inicializarEscritorMemoria(&escritorCabecalho, cabecalho, sizeof(cabecalho));
+    escreverComprimentos(comprimentos, &escritorCabecalho);
+    size_t tamanhoDados = 0;
+    if (quatroFluxos) {
+        for (int j = 0; j < 4; j++) {
+            if (j < 3) escreverVarint(&escritorCabecalho, (bitsFluxo[j] + 7) / 8);
+            tamanhoDados += (size_t)((bitsFluxo[j] + 7) / 8);
+        }
+    } else if (usados > 1) {
+        tamanhoDados = (size_t)((bitsFluxo[0] + bitsFluxo[1] + bitsFluxo[2] + bitsFluxo[3] + 7) / 8);
+    }
+    finalizarEscritor(&escritorCabecalho);
+    size_t tamanhoCabecalho = escritorCabecalho.posicao;
+    size_t tamanhoCorpo = tamanhoCabecalho + tamanhoDados;
+    instante = marcarFase(fases, FASE_CABECALHO, instante);
+
+    // O tANS usa o mesmo histograma; no modo automático ele só é codificado se a estimativa vencer o Huffman
+    uint8_t *corpoTans = NULL;
+    size_t tamanhoTans = 0;
+    if (usados > 1 && opcoes->codificador != CODIFICADOR_HUFFMAN) {
+        uint16_t normalizadas[TAMANHO_TABELA];
+        int bitsTabela = escolherBitsTans(tamanho, usados);
+        normalizarFrequencias(frequencias, tamanho, bitsTabela, normalizadas);
+        if (opcoes->codificador == CODIFICADOR_TANS ||
+            estimarBitsTans(frequencias, normalizadas, bitsTabela) / 8 < tamanhoDados) {
+            size_t capacidade = tamanho + MARGEM_TABELA_TANS + 16;
+            corpoTans = malloc(capacidade);
+            if (!corpoTans) return 0;
+            tamanhoTans = codificarTans(dados, tamanho, normalizadas, bitsTabela, corpoTans, capacidade);
+        }
+    }
+    int usarTans = tamanhoTans > 0 && (opcoes->codificador == CODIFICADOR_TANS || tamanhoTans < tamanhoCorpo);
+    if (usarTans) tamanhoCorpo = tamanhoTans;
+    if (relatorio) relatorio->blocosTans = 0;
+    if (relatorio) relatorio->blocosOrdem1 = 0;
+
+    // Em ordem 1 o bloco só é gravado se ficar menor que o melhor corpo de ordem 0
+    if (opcoes->ordem1 && usados > 1 && tamanho >= TAMANHO_MINIMO_ORDEM1) {
+        int resultado = compactarBlocoOrdem1(dados, tamanho, tamanhoCorpo < tamanho ? tamanhoCorpo : tamanho, saida);
+        if (resultado != 0) {
+            free(corpoTans);
+            if (relatorio && resultado > 0) relatorio->blocosOrdem1 = 1;
+            marcarFase(fases, FASE_CODIFICACAO, instante);
+            return resultado > 0;
+        }
+    }
+
+    if (tamanhoCorpo >= tamanho) {
+        free(corpoTans);
+        escreverByteEscritor(saida, BLOCO_CRU);
+        escreverVarint(saida, tamanho);
+        escreverVarint(saida, tamanho);
+        escreverBytesEscritor(saida, dados, tamanho);
+        marcarFase(fases, FASE_CODIFICACAO, instante);
+        return 1;
+    }
+
+    if (usarTans) {
+        escreverByteEscritor(saida, BLOCO_TANS);
+        escreverVarint(saida, tamanho);
+        escreverVarint(saida, tamanhoCorpo);
+        escreverBytesEscritor(saida, corpoTans, tamanhoCorpo);
+        free(corpoTans);
+        if (relatorio) relatorio->blocosTans = 1;
+        marcarFase(fases, FASE_CODIFICACAO, instante);
+        return 1;
+    }
+    free(corpoTans);
+
+    escreverByteEscritor(saida, quatroFluxos ? BLOCO_HUFFMAN_4 : BLOCO_HUFFMAN);
+    escreverVarint(saida, tamanho);
+    escreverVarint(saida, tamanhoCorpo);
+    escreverBytesEscritor(saida, cabecalho, tamanhoCabecalho);
+    if (quatroFluxos) {
+        // O sub-fluxo j recebe os símbolos das posições j, j + 4, j + 8...
+        for (int j = 0; j < 4; j++) {
+            for (size_t i = (size_t)j; i < tamanho; i += 4)
+                escreverCodigo(saida, codigos[dados[i]].bits, codigos[dados[i]].tamanho);
+            alinharEscritor(saida);
+        }
+    } else if (usados > 1) {
+        for (size_t i = 0; i < tamanho; i++)
+            escreverCodigo(saida, codigos[dados[i]].bits, codigos[dados[i]].tamanho);
+        alinharEscritor(saida);
+    }
+    marcarFase(fases, FASE_CODIFICACAO, instante);
+    return 1;
+}
+
+//CONSOME UM CÓDIGO DE ATÉ BITS_TABELA BITS DO INÍCIO DO ACUMULADOR
+static inline uint8_t consumirSimboloTabela(const EntradaDecodificacao tabela[], LeitorBits *leitor) {
+    EntradaDecodificacao registro = tabela[leitor->acumulador >> (64 - BITS_TABELA)];
+    leitor->acumulador <<= registro.bits;
+    leitor->bitsNoAcumulador -= registro.bits;
+    return registro.simbolo;
+}
+
+//DECODIFICA OS 'quantidade' PRIMEIROS SÍMBOLOS DE QUATRO SUB-FLUXOS INTERCALADOS: O SÍMBOLO i VEM DO SUB-FLUXO i % 4.
+//A TABELA DEVE RESOLVER TODOS OS CÓDIGOS
+static int decodificarQuatroFluxos(const EntradaDecodificacao tabela[], LeitorBits fluxos[4], uint8_t *destino,
+                                   size_t quantidade) {
+    // Cópias locais: as gravações em 'destino' poderiam apontar para os leitores e forçariam releituras
+    LeitorBits a = fluxos[0], b = fluxos[1], c = fluxos[2], d = fluxos[3];
+    size_t posicao = 0;
+
+    // Com 8 bytes sobrando em cada sub-fluxo, a recarga dispensa o teste de fim e garante 56 bits, o bastante
+    // para quatro códigos; as quatro cadeias de consultas não dependem umas das outras
+    while (quantidade - posicao >= 16 && a.posicao + 8 <= a.tamanho && b.posicao + 8 <= b.tamanho &&
+           c.posicao + 8 <= c.tamanho && d.posicao + 8 <= d.tamanho) {
+        recarregarPalavra(&a);
+        recarregarPalavra(&b);
+        recarregarPalavra(&c);
+        recarregarPalavra(&d);
+        for (int rodada = 0; rodada < 4; rodada++, posicao += 4) {
+            destino[posicao] = consumirSimboloTabela(tabela, &a);
+            destino[posicao + 1] = consumirSimboloTabela(tabela, &b);
+            destino[posicao + 2] = consumirSimboloTabela(tabela, &c);
+            destino[posicao + 3] = consumirSimboloTabela(tabela, &d);
+        }
+    }
+    fluxos[0] = a;
+    fluxos[1] = b;
+    fluxos[2] = c;
+    fluxos[3] = d;
+
+    // Perto do fim, um símbolo por vez com a recarga que respeita o tamanho de cada sub-fluxo
+    for (; posicao < quantidade; posicao++) {
+        LeitorBits *fluxo = &fluxos[posicao & 3];
+        if (fluxo->bitsNoAcumulador < BITS_TABELA)
+            recarregarLeitor(fluxo);
+        if (tabela[fluxo->acumulador >> (64 - BITS_TABELA)].bits > fluxo->bitsNoAcumulador) return 0;
+        destino[posicao] = consumirSimboloTabela(tabela, fluxo);
+    }
+    return 1;
+}
+
+//VERIFICA SE TODA ENTRADA DA TABELA RESOLVE UM CÓDIGO, COMO EXIGE A DECODIFICAÇÃO EM QUATRO SUB-FLUXOS
+static int tabelaCompleta(const EntradaDecodificacao tabela[]) {
+    for (int i = 0; i < (1 << BITS_TABELA); i++)
+        if (tabela[i].bits == 0) return 0;
+    return 1;
+}
+
+//SEPARA OS QUATRO SUB-FLUXOS QUE SEGUEM A TABELA NO CORPO, LENDO O TAMANHO DOS TRÊS PRIMEIROS
+static int separarQuatroFluxos(LeitorBits *leitor, const uint8_t *corpo, size_t tamanhoCorpo, LeitorBits fluxos[4]) {
+    uint64_t tamanhos[3];
+    for (int j = 0; j < 3; j++)
+        if (!lerVarint(leitor, &tamanhos[j])) return 0;
+
+    // Depois dos varints o leitor está alinhado: o que falta ler são os bytes do acumulador e os do buffer
+    uint64_t restantes = (uint64_t)(leitor->bitsNoAcumulador / 8);
+    if (!leitor->fimArquivo) restantes += leitor->tamanho - leitor->posicao;
+    const uint8_t *inicio = corpo + (tamanhoCorpo - restantes);
+    for (int j = 0; j < 4; j++) {
+        uint64_t tamanho = j < 3 ? tamanhos[j] : restantes;
+        if (tamanho > restantes) return 0;
+        inicializarLeitorMemoria(&fluxos[j], inicio, (size_t)tamanho);
+        inicio += tamanho;
+        restantes -= tamanho;
+    }
+    return 1;
+}
+
+//DECODIFICA OS 'quantidade' PRIMEIROS SÍMBOLOS DE UM BLOCO EM ORDEM 1, TROCANDO DE TABELA A CADA SÍMBOLO
+static int decodificarOrdem1(const uint8_t *corpo, size_t tamanhoCorpo, uint8_t *destino, size_t quantidade) {
+    LeitorBits leitor;
+    inicializarLeitorMemoria(&leitor, corpo, tamanhoCorpo);
+    int grupos = lerByteLeitor(&leitor);
+    if (grupos == EOF || ++grupos > MAXIMO_TABELAS_CONTEXTO) return 0;
+
+    uint8_t mapa[TAMANHO_TABELA];
+    int bitsMapa = grupos > 1 ? bitMaisAlto((uint32_t)grupos - 1) + 1 : 0;
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++) {
+        if (leitor.bitsNoAcumulador < bitsMapa)
+            recarregarLeitor(&leitor);
+        if (leitor.bitsNoAcumulador < bitsMapa) return 0;
+        mapa[contexto] = (uint8_t)((leitor.acumulador >> 1) >> (63 - bitsMapa));
+        leitor.acumulador <<= bitsMapa;
+        leitor.bitsNoAcumulador -= bitsMapa;
+        if (mapa[contexto] >= grupos) return 0;
+    }
+
+    Decodificador *decodificadores = malloc((size_t)grupos * sizeof(Decodificador));
+    if (!decodificadores) return 0;
+    for (int g = 0; g < grupos; g++) {
+        uint8_t comprimentos[TAMANHO_TABELA];
+        CodigoHuffman codigos[TAMANHO_TABELA];
+        if (!lerComprimentos(&leitor, comprimentos) || !gerarCodigosCanonicos(comprimentos, codigos)) {
+            free(decodificadores);
+            return 0;
+        }
+        construirDecodificador(codigos, &decodificadores[g]);
+        if (!tabelaCompleta(decodificadores[g].tabela)) {
+            free(decodificadores);
+            return 0;
+        }
+    }
+    const EntradaDecodificacao *tabelas[TAMANHO_TABELA];
+    for (int contexto = 0; contexto < TAMANHO_TABELA; contexto++)
+        tabelas[contexto] = decodificadores[mapa[contexto]].tabela;
+
+    // Cada recarga garante 56 bits, o bastante para cinco códigos; o símbolo decodificado escolhe a próxima tabela
+    LeitorBits local = leitor;
+    uint8_t anterior = 0;
+    size_t posicao = 0;
+    while (quantidade - posicao >= 5 && local.posicao + 8 <= local.tamanho) {
+        recarregarPalavra(&local);
+        for (int i = 0; i < 5; i++)
+            destino[posicao++] = anterior = consumirSimboloTabela(tabelas[anterior], &local);
+    }
+    leitor = local;
+
+    int sucesso = 1;
+    for (; posicao < quantidade; posicao++) {
+        if (leitor.bitsNoAcumulador < BITS_TABELA)
+            recarregarLeitor(&leitor);
+        if (tabelas[anterior][leitor.acumulador >> (64 - BITS_TABELA)].bits > leitor.bitsNoAcumulador) {
+            sucesso = 0;
+            break;
+        }
+        destino[posicao] = anterior = consumirSimboloTabela(tabelas[anterior], &leitor);
+    }
+    free(decodificadores);
+    return sucesso;
+}
+
+//DESCOMPACTA APENAS OS PRIMEIROS 'quantidade' BYTES DE UM BLOCO; RETORNA 0 SE O BLOCO ESTIVER CORROMPIDO
+static int descompactarInicioBloco(int tipo, const uint8_t *corpo, size_t tamanhoCorpo, uint8_t *destino,
+                                   size_t tamanhoOriginal, size_t quantidade) {
+    if (tipo == BLOCO_CRU) {
+        if (tamanhoCorpo != tamanhoOriginal) return 0;
+        memcpy(destino, corpo, quantidade);
+        return 1;
+    }
+    if (tipo == BLOCO_TANS) return decodificarTans(corpo, tamanhoCorpo, destino, quantidade);
+    if (tipo == BLOCO_ORDEM1) return decodificarOrdem1(corpo, tamanhoCorpo, destino, quantidade);
+    if (tipo != BLOCO_HUFFMAN && tipo != BLOCO_HUFFMAN_4) return 0;
+
+    LeitorBits leitor;
+    uint8_t comprimentos[TAMANHO_TABELA];
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    inicializarLeitorMemoria(&leitor, corpo, tamanhoCorpo);
+    if (!lerComprimentos(&leitor, comprimentos) || !gerarCodigosCanonicos(comprimentos, codigos)) return 0;
+
+    int unico = 0;
+    if (contarSimbolosUsados(comprimentos, &unico) == 1) {
+        if (tipo == BLOCO_HUFFMAN_4) return 0;
+        memset(destino, unico, quantidade);
+        return 1;
+    }
+
+    Decodificador *decodificador = malloc(sizeof(Decodificador));
+    if (!decodificador) return 0;
+    construirDecodificador(codigos, decodificador);
+    int sucesso;
+    if (tipo == BLOCO_HUFFMAN_4) {
+        LeitorBits fluxos[4];
+        sucesso = tabelaCompleta(decodificador->tabela) && separarQuatroFluxos(&leitor, corpo, tamanhoCorpo, fluxos) &&
+                  decodificarQuatroFluxos(decodificador->tabela, fluxos, destino, quantidade);
+    } else {
+        sucesso = decodificarParaMemoria(decodificador, &leitor, 0, destino, quantidade) == quantidade;
+    }
+    free(decodificador);
+    return sucesso;
+}
+
+//DESCOMPACTA O CORPO DE UM BLOCO EM 'destino'; RETORNA 0 SE O BLOCO ESTIVER CORROMPIDO
+int descompactarBloco(int tipo, const uint8_t *corpo, size_t tamanhoCorpo, uint8_t *destino, size_t tamanhoOriginal) {
+    return descompactarInicioBloco(tipo, corpo, tamanhoCorpo, destino, tamanhoOriginal, tamanhoOriginal);
+}
+
+// ----------------------------------------------------
+// Funções principais de compactação e descompactação
+// ----------------------------------------------------
+
+//PREENCHE AS OPÇÕES DE COMPACTAÇÃO COM OS VALORES PADRÃO
+void opcoesPadrao(OpcoesCompactacao *opcoes) {
+    opcoes->formato = FORMATO_BLOCOS;
+    opcoes->comprimentoMaximo = COMPRIMENTO_PADRAO;
+    opcoes->relatorio = NULL;
+    opcoes->tamanhoBloco = TAMANHO_BLOCO_PADRAO;
+    opcoes->threads = 0;
+    opcoes->indice = 0;
+    opcoes->mapearEntrada = 1;
+    opcoes->quatroFluxos = 1;
+    opcoes->pipeline = 0;
+    opcoes->codificador = CODIFICADOR_AUTOMATICO;
+    opcoes->ordem1 = 0;
+    opcoes->estatisticasPipeline = NULL;
+    opcoes->estatisticas = NULL;
+    opcoes->falhaPacote = NULL;
+}
+
+//CONTA AS FREQUÊNCIAS DA ENTRADA INTEIRA, PELO MAPEAMENTO OU LENDO O ARQUIVO EM BLOCOS GRANDES
+static int contarFrequenciasEntrada(FILE *entrada, const MapeamentoArquivo *mapeamento, uint64_t frequencias[]) {
+    memset(frequencias, 0, TAMANHO_TABELA * sizeof(uint64_t));
+    if (mapeamento) {
+        acumularFrequencias(mapeamento->dados, mapeamento->tamanho, frequencias);
+        return 1;
+    }
+    uint8_t *buffer = malloc(TAMANHO_BUFFER_GRANDE);
+    if (!buffer) return 0;
+    size_t bytesLidos;
+    while ((bytesLidos = fread(buffer, 1, TAMANHO_BUFFER_GRANDE, entrada)) > 0)
+        acumularFrequencias(buffer, bytesLidos, frequencias);
+    free(buffer);
+    return 1;
+}
+
+//CODIFICA A ENTRADA COM A TABELA DE CÓDIGOS, PELO MAPEAMENTO OU RELENDO O ARQUIVO DO INÍCIO
+static int codificarEntrada(FILE *entrada, const MapeamentoArquivo *mapeamento, EscritorBits *escritor,
+                            const CodigoHuffman codigos[]) {
+    if (mapeamento) {
+        for (size_t i = 0; i < mapeamento->tamanho; i++) {
+            CodigoHuffman codigo = codigos[mapeamento->dados[i]];
+            escreverCodigo(escritor, codigo.bits, codigo.tamanho);
+        }
+        return 1;
+    }
+
+    uint8_t *bufferEntrada = malloc(TAMANHO_BUFFER_GRANDE);
+    if (!bufferEntrada || fseek(entrada, 0, SEEK_SET) != 0) {
+        free(bufferEntrada);
+        return 0;
+    }
+    size_t bytesLidos;
+    while ((bytesLidos = fread(bufferEntrada, 1, TAMANHO_BUFFER_GRANDE, entrada)) > 0) {
+        for (size_t i = 0; i < bytesLidos; i++) {
+            CodigoHuffman codigo = codigos[bufferEntrada[i]];
+            escreverCodigo(escritor, codigo.bits, codigo.tamanho);
+        }
+    }
+    free(bufferEntrada);
+    return 1;
+}
+
+//GRAVA NO FORMATO ORIGINAL: CABEÇALHO DE 2 BYTES, ÁRVORE EM PRÉ-ORDEM E BITS
+static int compactarFormatoArvore(FILE *entrada, const MapeamentoArquivo *mapeamento, FILE *saida, No *raiz,
+                                  const uint64_t frequencias[], EstatisticasCodec *estatisticas) {
+    double *fases = estatisticas ? estatisticas->segundosFase : NULL;
+    double instante = iniciarFases(fases);
+
+    // Códigos como pares (inteiro, tamanho) em vez de strings de '0' e '1'
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    if (!gerarCodigosInteiros(raiz, codigos)) return 0;
+    if (estatisticas) anotarCodigos(estatisticas, frequencias, codigos);
+    instante = marcarFase(fases, FASE_CODIGOS, instante);
+
+    fputc(0, saida);
+    fputc(0, saida);
+
+    // Arquivo vazio: apenas o cabeçalho zerado, sem árvore
+    if (!raiz) return 1;
+
+    int tamanhoArvore = escreverArvore(raiz, saida);
+    instante = marcarFase(fases, FASE_CABECALHO, instante);
+
+    EscritorBits escritor;
+    if (!inicializarEscritor(&escritor, saida)) return 0;
+    int sucesso = codificarEntrada(entrada, mapeamento, &escritor, codigos);
+    uint64_t totalBits = escritor.totalBits;
+    instante = marcarFase(fases, FASE_CODIFICACAO, instante);
+    finalizarEscritor(&escritor);
+    if (!sucesso) return 0;
+
+    int bitsLixo = (int)((8 - (totalBits % 8)) % 8);
+    unsigned short cabecalho = (bitsLixo << 13) | (tamanhoArvore & 0x1FFF);
+
+    fseek(saida, 0, SEEK_SET);
+    fputc((cabecalho >> 8) & 0xFF, saida);
+    fputc(cabecalho & 0xFF, saida);
+    marcarFase(fases, FASE_GRAVACAO, instante);
+    return 1;
+}
+
+//GRAVA NO FORMATO CANÔNICO: ASSINATURA, QUANTIDADE DE SÍMBOLOS, TAMANHOS DOS CÓDIGOS E BITS
+static int compactarFormatoCanonico(FILE *entrada, const MapeamentoArquivo *mapeamento, FILE *saida,
+                                    const uint64_t frequencias[], const OpcoesCompactacao *opcoes) {
+    double *fases = opcoes->estatisticas ? opcoes->estatisticas->segundosFase : NULL;
+    double instante = iniciarFases(fases);
+    uint8_t comprimentos[TAMANHO_TABELA];
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    if (!escolherComprimentos(frequencias, opcoes->comprimentoMaximo, comprimentos, opcoes->relatorio)) return 0;
+    instante = marcarFase(fases, FASE_ARVORE, instante);
+    if (!gerarCodigosCanonicos(comprimentos, codigos)) return 0;
+    if (opcoes->estatisticas) anotarCodigos(opcoes->estatisticas, frequencias, codigos);
+    instante = marcarFase(fases, FASE_CODIGOS, instante);
+
+    uint64_t totalSimbolos = 0;
+    for (int i = 0; i < TAMANHO_TABELA; i++)
+        totalSimbolos += frequencias[i];
+
+    EscritorBits escritor;
+    if (!inicializarEscritor(&escritor, saida)) return 0;
+    escreverByteEscritor(&escritor, MARCADOR_FORMATO);
+    escreverByteEscritor(&escritor, FORMATO_CANONICO);
+    escreverVarint(&escritor, totalSimbolos);
+    escreverComprimentos(comprimentos, &escritor);
+    instante = marcarFase(fases, FASE_CABECALHO, instante);
+
+    // Com um único símbolo a quantidade basta e nenhum bit é gravado
+    int unico = 0, sucesso = 1;
+    if (contarSimbolosUsados(comprimentos, &unico) > 1)
+        sucesso = codificarEntrada(entrada, mapeamento, &escritor, codigos);
+    instante = marcarFase(fases, FASE_CODIFICACAO, instante);
+    finalizarEscritor(&escritor);
+    marcarFase(fases, FASE_GRAVACAO, instante);
+    return sucesso;
+}
+
+typedef struct Pipeline Pipeline;
+
+// Um bloco a compactar ou descompactar, com os buffers reaproveitados entre lotes
+typedef struct {
+    const uint8_t *origem;      // Dados a processar: o buffer 'entrada' ou um trecho da memória de quem chamou
+    uint8_t *entrada;
+    size_t capacidadeEntrada;
+    size_t tamanhoEntrada;
+    uint8_t *saida;
+    size_t capacidadeSaida;
+    size_t tamanhoSaida;
+    int tipo;
+    const OpcoesCompactacao *opcoes;
+    RelatorioCompactacao relatorio;
+    int sucesso;
+    Pipeline *pipeline;         // Só no modo em pipeline
+    int pronta;                 // Processada e aguardando a gravação, no modo em pipeline
+} TarefaBloco;
+
+//GARANTE QUE O BUFFER COMPORTE 'tamanho' BYTES
+static int reservarBuffer(uint8_t **buffer, size_t *capacidade, size_t tamanho) {
+    if (*capacidade >= tamanho && *buffer) return 1;
+    uint8_t *novo = realloc(*buffer, tamanho ? tamanho : 1);
+    if (!novo) return 0;
+    *buffer = novo;
+    *capacidade = tamanho;
+    return 1;
+}
+
+//TAREFA DE UMA THREAD: COMPACTA O BLOCO DE 'entrada' NA MEMÓRIA DE 'saida'
+static void executarCompactacaoBloco(void *argumento) {
+    TarefaBloco *tarefa = argumento;
+    EscritorBits escritor;
+    inicializarEscritorMemoria(&escritor, tarefa->saida, tarefa->capacidadeSaida);
+    tarefa->sucesso = compactarBloco(tarefa->origem, tarefa->tamanhoEntrada, tarefa->opcoes, &escritor,
+                                     &tarefa->relatorio);
+    finalizarEscritor(&escritor);
+    tarefa->tamanhoSaida = escritor.posicao;
+    if (escritor.estouro) tarefa->sucesso = 0;
+}
+
+//TAREFA DE UMA THREAD: DESCOMPACTA O CORPO EM 'origem' PARA 'saida'
+static void executarDescompactacaoBloco(void *argumento) {
+    TarefaBloco *tarefa = argumento;
+    double *fases = tarefa->opcoes && tarefa->opcoes->estatisticas ? tarefa->relatorio.segundosFase : NULL;
+    double instante = iniciarFases(fases);
+    tarefa->sucesso = descompactarBloco(tarefa->tipo, tarefa->origem, tarefa->tamanhoEntrada, tarefa->saida,
+                                        tarefa->tamanhoSaida);
+    marcarFase(fases, FASE_DECODIFICACAO, instante);
+}
+
+//LIBERA OS BUFFERS DE UM LOTE DE TAREFAS
+static void liberarTarefas(TarefaBloco *tarefas, int quantidade) {
+    if (!tarefas) return;
+    for (int i = 0; i < quantidade; i++) {
+        free(tarefas[i].entrada);
+        free(tarefas[i].saida);
+    }
+    free(tarefas);
+}
+
+// Estágio de leitura do pipeline: prepara o próximo bloco na tarefa; retorna 1, 0 no fim ou -1 em erro
+typedef int (*FuncaoLeituraBloco)(void *contexto, TarefaBloco *tarefa);
+
+// Estágio de gravação: recebe os blocos na ordem de leitura; retorna 0 em erro
+typedef int (*FuncaoGravacaoBloco)(void *contexto, TarefaBloco *tarefa);
+
+// Três estágios ligados por uma fila circular limitada: uma thread lê, o grupo de threads processa e quem
+// chamou grava. Os contadores só crescem; o bloco i ocupa a tarefa i % capacidade
+struct Pipeline {
+    TarefaBloco *tarefas;
+    int capacidade;
+    uint64_t lidos;
+    uint64_t processados;
+    uint64_t gravados;
+    int fimLeitura;
+    int erroLeitura;
+    int cancelado;
+    FuncaoLeituraBloco ler;
+    void *contextoLeitura;
+    FuncaoTarefa processar;
+    GrupoThreads *grupo;
+    EstatisticasPipeline estatisticas;
+    uint64_t somaFilaProcessamento;
+    uint64_t somaFilaGravacao;
+    pthread_mutex_t trava;
+    pthread_cond_t mudou;
+};
+
+//TAREFA DE UMA THREAD DO PIPELINE: PROCESSA O BLOCO E O MARCA COMO PRONTO PARA A GRAVAÇÃO
+static void executarEtapaPipeline(void *argumento) {
+    TarefaBloco *tarefa = argumento;
+    Pipeline *pipeline = tarefa->pipeline;
+    pipeline->processar(tarefa);
+    pthread_mutex_lock(&pipeline->trava);
+    tarefa->pronta = 1;
+    pipeline->processados++;
+    pthread_cond_broadcast(&pipeline->mudou);
+    pthread_mutex_unlock(&pipeline->trava);
+}
+
+//LAÇO DA THREAD DE LEITURA: LÊ BLOCOS ENQUANTO HOUVER ESPAÇO NA FILA E OS ENVIA AO GRUPO DE THREADS
+static void *executarLeituraPipeline(void *argumento) {
+    Pipeline *pipeline = argumento;
+    pthread_mutex_lock(&pipeline->trava);
+    while (!pipeline->cancelado) {
+        // A fila cheia segura a leitura até a gravação liberar uma posição
+        int esperou = 0;
+        while (pipeline->lidos - pipeline->gravados == (uint64_t)pipeline->capacidade && !pipeline->cancelado) {
+            esperou = 1;
+            pthread_cond_wait(&pipeline->mudou, &pipeline->trava);
+        }
+        pipeline->estatisticas.esperasLeitura += esperou;
+        if (pipeline->cancelado) break;
+
+        TarefaBloco *tarefa = &pipeline->tarefas[pipeline->lidos % pipeline->capacidade];
+        pthread_mutex_unlock(&pipeline->trava);
+        tarefa->pronta = 0;
+        int resultado = pipeline->ler(pipeline->contextoLeitura, tarefa);
+        pthread_mutex_lock(&pipeline->trava);
+        if (resultado <= 0) {
+            pipeline->erroLeitura = resultado < 0;
+            break;
+        }
+        pipeline->lidos++;
+        pthread_mutex_unlock(&pipeline->trava);
+        enviarTarefa(pipeline->grupo, executarEtapaPipeline, tarefa);
+        pthread_mutex_lock(&pipeline->trava);
+    }
+    pipeline->fimLeitura = 1;
+    pthread_cond_broadcast(&pipeline->mudou);
+    pthread_mutex_unlock(&pipeline->trava);
+    return NULL;
+}
+
+//GRAVA OS BLOCOS NA ORDEM EM QUE FORAM LIDOS, AMOSTRANDO AS FILAS A CADA BLOCO, ATÉ O FIM DA LEITURA OU UM ERRO
+static int gravarPipeline(Pipeline *pipeline, FuncaoGravacaoBloco gravar, void *contextoGravacao) {
+    int sucesso = 1;
+    pthread_mutex_lock(&pipeline->trava);
+    for (;;) {
+        TarefaBloco *tarefa = &pipeline->tarefas[pipeline->gravados % pipeline->capacidade];
+        int esperou = 0;
+        while (!(pipeline->gravados < pipeline->lidos && tarefa->pronta) &&
+               !(pipeline->fimLeitura && pipeline->gravados == pipeline->lidos)) {
+            esperou = 1;
+            pthread_cond_wait(&pipeline->mudou, &pipeline->trava);
+        }
+        if (pipeline->gravados == pipeline->lidos) break;
+
+        EstatisticasPipeline *estatisticas = &pipeline->estatisticas;
+        int filaProcessamento = (int)(pipeline->lidos - pipeline->processados);
+        int filaGravacao = (int)(pipeline->processados - pipeline->gravados);
+        estatisticas->esperasGravacao += esperou;
+        pipeline->somaFilaProcessamento += (uint64_t)filaProcessamento;
+        pipeline->somaFilaGravacao += (uint64_t)filaGravacao;
+        if (filaProcessamento > estatisticas->maximoFilaProcessamento)
+            estatisticas->maximoFilaProcessamento = filaProcessamento;
+        if (filaGravacao > estatisticas->maximoFilaGravacao)
+            estatisticas->maximoFilaGravacao = filaGravacao;
+
+        pthread_mutex_unlock(&pipeline->trava);
+        sucesso = gravar(contextoGravacao, tarefa);
+        pthread_mutex_lock(&pipeline->trava);
+        pipeline->gravados++;
+        pthread_cond_broadcast(&pipeline->mudou);
+        if (!sucesso) {
+            pipeline->cancelado = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&pipeline->trava);
+    return sucesso;
+}
+
+//RODA LEITURA, PROCESSAMENTO E GRAVAÇÃO AO MESMO TEMPO; OS BUFFERS DAS TAREFAS SÃO RESERVADOS PELA LEITURA
+static int executarPipeline(const OpcoesCompactacao *opcoes, FuncaoLeituraBloco ler, void *contextoLeitura,
+                            FuncaoTarefa processar, FuncaoGravacaoBloco gravar, void *contextoGravacao) {
+    int threads = opcoes->threads > 0 ? opcoes->threads : threadsDisponiveis();
+    Pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    // Além dos blocos em processamento, um sendo lido e outro sendo gravado
+    pipeline.capacidade = 2 * threads + 2;
+    pipeline.ler = ler;
+    pipeline.contextoLeitura = contextoLeitura;
+    pipeline.processar = processar;
+    pipeline.tarefas = calloc(pipeline.capacidade, sizeof(TarefaBloco));
+    pipeline.grupo = criarGrupoThreads(threads);
+    if (!pipeline.tarefas || !pipeline.grupo) {
+        free(pipeline.tarefas);
+        destruirGrupoThreads(pipeline.grupo);
+        return 0;
+    }
+    for (int i = 0; i < pipeline.capacidade; i++) {
+        pipeline.tarefas[i].opcoes = opcoes;
+        pipeline.tarefas[i].pipeline = &pipeline;
+    }
+    pthread_mutex_init(&pipeline.trava, NULL);
+    pthread_cond_init(&pipeline.mudou, NULL);
+
+    pthread_t leitor;
+    int sucesso = pthread_create(&leitor, NULL, executarLeituraPipeline, &pipeline) == 0;
+    if (sucesso) {
+        sucesso = gravarPipeline(&pipeline, gravar, contextoGravacao);
+        pthread_join(leitor, NULL);
+        aguardarTarefas(pipeline.grupo);
+        if (pipeline.erroLeitura) sucesso = 0;
+    }
+
+    if (opcoes->estatisticasPipeline) {
+        EstatisticasPipeline *estatisticas = opcoes->estatisticasPipeline;
+        *estatisticas = pipeline.estatisticas;
+        estatisticas->blocos = pipeline.gravados;
+        estatisticas->capacidadeFila = pipeline.capacidade;
+        if (pipeline.gravados) {
+            estatisticas->mediaFilaProcessamento = (double)pipeline.somaFilaProcessamento / pipeline.gravados;
+            estatisticas->mediaFilaGravacao = (double)pipeline.somaFilaGravacao / pipeline.gravados;
+        }
+    }
+    pthread_mutex_destroy(&pipeline.trava);
+    pthread_cond_destroy(&pipeline.mudou);
+    destruirGrupoThreads(pipeline.grupo);
+    liberarTarefas(pipeline.tarefas, pipeline.capacidade);
+    return sucesso;
+}
+
+//ANOTA ONDE UM BLOCO COMEÇA (OU, APÓS O ÚLTIMO, ONDE OS BLOCOS TERMINAM) SEM CONTÁ-LO COMO BLOCO
+static int anotarPosicaoIndice(IndiceBlocos *indice, uint64_t posicaoCompactada, uint64_t posicaoOriginal) {
+    if (indice->quantidadeBlocos + 1 > indice->capacidade) {
+        size_t capacidade = indice->capacidade ? 2 * indice->capacidade : 64;
+        EntradaIndice *entradas = realloc(indice->entradas, capacidade * sizeof(EntradaIndice));
+        if (!entradas) return 0;
+        indice->entradas = entradas;
+        indice->capacidade = capacidade;
+    }
+    indice->entradas[indice->quantidadeBlocos].posicaoCompactada = posicaoCompactada;
+    indice->entradas[indice->quantidadeBlocos].posicaoOriginal = posicaoOriginal;
+    return 1;
+}
+
+//GRAVA O RODAPÉ: QUANTIDADE DE BLOCOS, TAMANHOS COMPACTADO E ORIGINAL DE CADA UM, TAMANHO DO ÍNDICE E ASSINATURA;
+//RETORNA QUANTOS BYTES ELE OCUPA
+static uint64_t escreverIndiceBlocos(EscritorBits *escritor, const IndiceBlocos *indice) {
+    uint32_t tamanhoIndice = (uint32_t)escreverVarint(escritor, indice->quantidadeBlocos);
+    for (size_t i = 0; i < indice->quantidadeBlocos; i++) {
+        const EntradaIndice *bloco = &indice->entradas[i], *proximo = &indice->entradas[i + 1];
+        tamanhoIndice += (uint32_t)escreverVarint(escritor, proximo->posicaoCompactada - bloco->posicaoCompactada);
+        tamanhoIndice += (uint32_t)escreverVarint(escritor, proximo->posicaoOriginal - bloco->posicaoOriginal);
+    }
+    for (int deslocamento = 24; deslocamento >= 0; deslocamento -= 8)
+        escreverByteEscritor(escritor, (uint8_t)(tamanhoIndice >> deslocamento));
+    escreverBytesEscritor(escritor, ASSINATURA_INDICE, 4);
+    return (uint64_t)tamanhoIndice + TAMANHO_RODAPE_INDICE;
+}
+
+//TAMANHO DOS BLOCOS PEDIDO NAS OPÇÕES, DENTRO DO LIMITE ACEITO NA LEITURA
+static size_t tamanhoBlocoOpcoes(const OpcoesCompactacao *opcoes) {
+    size_t tamanhoBloco = opcoes->tamanhoBloco ? opcoes->tamanhoBloco : TAMANHO_BLOCO_PADRAO;
+    return tamanhoBloco < TAMANHO_BLOCO_MAXIMO ? tamanhoBloco : TAMANHO_BLOCO_MAXIMO;
+}
+
+// Estado da gravação dos blocos compactados, comum aos modos em lotes e em pipeline
+typedef struct {
+    EscritorBits *escritor;
+    const OpcoesCompactacao *opcoes;
+    IndiceBlocos indice;
+    uint64_t posicaoCompactada;
+    uint64_t posicaoOriginal;
+} GravacaoBlocos;
+
+//GRAVA UM BLOCO COMPACTADO, ANOTANDO-O NO ÍNDICE E SOMANDO SEU RELATÓRIO AO DO ARQUIVO
+static int gravarBlocoCompactado(void *contexto, TarefaBloco *tarefa) {
+    GravacaoBlocos *gravacao = contexto;
+    const OpcoesCompactacao *opcoes = gravacao->opcoes;
+    // Na memória, um estouro já torna inútil compactar o resto
+    if (!tarefa->sucesso || gravacao->escritor->estouro) return 0;
+    if (opcoes->indice) {
+        if (!anotarPosicaoIndice(&gravacao->indice, gravacao->posicaoCompactada, gravacao->posicaoOriginal))
+            return 0;
+        gravacao->indice.quantidadeBlocos++;
+    }
+    gravacao->posicaoCompactada += tarefa->tamanhoSaida;
+    gravacao->posicaoOriginal += tarefa->tamanhoEntrada;
+    double *fases = opcoes->estatisticas ? tarefa->relatorio.segundosFase : NULL;
+    double instante = iniciarFases(fases);
+    escreverBytesEscritor(gravacao->escritor, tarefa->saida, tarefa->tamanhoSaida);
+    marcarFase(fases, FASE_GRAVACAO, instante);
+    if (opcoes->estatisticas) {
+        // A gravação é feita por uma única thread, então as estatísticas do arquivo dispensam trava
+        somarEstatisticasBloco(opcoes->estatisticas, &tarefa->relatorio);
+        opcoes->estatisticas->bytesEntrada += tarefa->tamanhoEntrada;
+        opcoes->estatisticas->simbolos += tarefa->tamanhoEntrada;
+    }
+    if (opcoes->relatorio) {
+        opcoes->relatorio->bitsSemLimite += tarefa->relatorio.bitsSemLimite;
+        opcoes->relatorio->bitsCodificados += tarefa->relatorio.bitsCodificados;
+        opcoes->relatorio->blocosTans += tarefa->relatorio.blocosTans;
+        opcoes->relatorio->blocosOrdem1 += tarefa->relatorio.blocosOrdem1;
+        if (tarefa->relatorio.comprimentoMaximo > opcoes->relatorio->comprimentoMaximo)
+            opcoes->relatorio->comprimentoMaximo = tarefa->relatorio.comprimentoMaximo;
+    }
+    return 1;
+}
+
+//COMPACTA EM LOTES: CADA LOTE É LIDO, COMPACTADO EM PARALELO E GRAVADO NA ORDEM ORIGINAL ANTES DO PRÓXIMO
+static int compactarBlocosEmLotes(FILE *entrada, const MapeamentoArquivo *mapeamento, GravacaoBlocos *gravacao) {
+    const OpcoesCompactacao *opcoes = gravacao->opcoes;
+    size_t tamanhoBloco = tamanhoBlocoOpcoes(opcoes);
+    int threads = opcoes->threads > 0 ? opcoes->threads : threadsDisponiveis();
+    // Dois blocos por thread mantêm todas ocupadas enquanto os tamanhos variam
+    int lote = threads > 1 ? 2 * threads : 1;
+    size_t capacidadeSaida = tamanhoBloco;
+
+    // Com o tamanho conhecido, entradas pequenas não pagam por threads e buffers que não usariam
+    if (mapeamento) {
+        size_t blocos = (mapeamento->tamanho + tamanhoBloco - 1) / tamanhoBloco;
+        if (blocos < (size_t)threads) threads = blocos > 0 ? (int)blocos : 1;
+        if (blocos < (size_t)lote) lote = blocos > 0 ? (int)blocos : 1;
+        if (mapeamento->tamanho < capacidadeSaida) capacidadeSaida = mapeamento->tamanho;
+    }
+
+    TarefaBloco *tarefas = calloc(lote, sizeof(TarefaBloco));
+    GrupoThreads *grupo = criarGrupoThreads(threads);
+    int sucesso = tarefas && grupo;
+    for (int i = 0; sucesso && i < lote; i++) {
+        // Com o arquivo mapeado os blocos são lidos direto do mapeamento, sem cópia
+        sucesso = (mapeamento || reservarBuffer(&tarefas[i].entrada, &tarefas[i].capacidadeEntrada, tamanhoBloco)) &&
+                  reservarBuffer(&tarefas[i].saida, &tarefas[i].capacidadeSaida,
+                                 capacidadeSaida + MARGEM_CABECALHO_BLOCO);
+        tarefas[i].opcoes = opcoes;
+    }
+
+    size_t posicaoMapeamento = 0;
+    int fim = 0;
+    while (sucesso && !fim) {
+        int quantidade = 0;
+        while (quantidade < lote && !fim) {
+            TarefaBloco *tarefa = &tarefas[quantidade];
+            if (mapeamento) {
+                size_t restantes = mapeamento->tamanho - posicaoMapeamento;
+                tarefa->origem = mapeamento->dados + posicaoMapeamento;
+                tarefa->tamanhoEntrada = restantes < tamanhoBloco ? restantes : tamanhoBloco;
+                posicaoMapeamento += tarefa->tamanhoEntrada;
+            } else {
+                double *fases = opcoes->estatisticas ? tarefa->relatorio.segundosFase : NULL;
+                double instante = iniciarFases(fases);
+                tarefa->origem = tarefa->entrada;
+                tarefa->tamanhoEntrada = fread(tarefa->entrada, 1, tamanhoBloco, entrada);
+                marcarFase(fases, FASE_LEITURA, instante);
+                // Leitura curta por erro não é fim de arquivo: o resultado estaria truncado
+                if (tarefa->tamanhoEntrada < tamanhoBloco && ferror(entrada)) {
+                    sucesso = 0;
+                    break;
+                }
+            }
+            if (tarefa->tamanhoEntrada < tamanhoBloco) fim = 1;
+            if (tarefa->tamanhoEntrada == 0) break;
+            enviarTarefa(grupo, executarCompactacaoBloco, tarefa);
+            quantidade++;
+        }
+        aguardarTarefas(grupo);
+
+        // A ordem de gravação é a de leitura, qualquer que seja a thread que terminou antes
+        for (int i = 0; i < quantidade && sucesso; i++)
+            sucesso = gravarBlocoCompactado(gravacao, &tarefas[i]);
+    }
+
+    liberarTarefas(tarefas, lote);
+    destruirGrupoThreads(grupo);
+    return sucesso;
+}
+
+// Origem dos blocos no pipeline de compactação: o descritor do arquivo de entrada
+typedef struct {
+    int descritor;
+    off_t posicao;
+    int sequencial;             // pread não serve para pipes; nesse caso os blocos vêm de read
+    size_t tamanhoBloco;
+    int fim;
+} LeituraDescritor;
+
+//ESTÁGIO DE LEITURA DA COMPACTAÇÃO: LÊ O PRÓXIMO BLOCO INTEIRO DO DESCRITOR, COM pread OU read
+static int lerBlocoDescritor(void *contexto, TarefaBloco *tarefa) {
+    LeituraDescritor *leitura = contexto;
+    if (leitura->fim) return 0;
+    if (!reservarBuffer(&tarefa->entrada, &tarefa->capacidadeEntrada, leitura->tamanhoBloco) ||
+        !reservarBuffer(&tarefa->saida, &tarefa->capacidadeSaida, leitura->tamanhoBloco + MARGEM_CABECALHO_BLOCO))
+        return -1;
+
+    double *fases = tarefa->opcoes->estatisticas ? tarefa->relatorio.segundosFase : NULL;
+    double instante = iniciarFases(fases);
+    size_t lidos = 0;
+    while (lidos < leitura->tamanhoBloco) {
+        size_t restantes = leitura->tamanhoBloco - lidos;
+        ssize_t resultado = leitura->sequencial
+                                ? read(leitura->descritor, tarefa->entrada + lidos, restantes)
+                                : pread(leitura->descritor, tarefa->entrada + lidos, restantes,
+                                        leitura->posicao + (off_t)lidos);
+        if (resultado < 0 && errno == ESPIPE && !leitura->sequencial) {
+            leitura->sequencial = 1;
+            continue;
+        }
+        if (resultado < 0 && errno == EINTR) continue;
+        if (resultado < 0) return -1;
+        if (resultado == 0) break;
+        lidos += (size_t)resultado;
+    }
+    leitura->posicao += (off_t)lidos;
+    marcarFase(fases, FASE_LEITURA, instante);
+    if (lidos < leitura->tamanhoBloco) leitura->fim = 1;
+    if (lidos == 0) return 0;
+    tarefa->origem = tarefa->entrada;
+    tarefa->tamanhoEntrada = lidos;
+    return 1;
+}
+
+//GRAVA NO FORMATO EM BLOCOS, EM LOTES OU EM PIPELINE; O ESCRITOR É DE QUEM CHAMA E NÃO É FINALIZADO AQUI
+static int compactarFormatoBlocos(FILE *entrada, const MapeamentoArquivo *mapeamento, EscritorBits *escritor,
+                                  const OpcoesCompactacao *opcoes) {
+    GravacaoBlocos gravacao;
+    memset(&gravacao, 0, sizeof(gravacao));
+    gravacao.escritor = escritor;
+    gravacao.opcoes = opcoes;
+    gravacao.posicaoCompactada = 2;
+
+    if (opcoes->relatorio)
+        memset(opcoes->relatorio, 0, sizeof(RelatorioCompactacao));
+    escreverByteEscritor(escritor, MARCADOR_FORMATO);
+    escreverByteEscritor(escritor, FORMATO_BLOCOS);
+
+    int sucesso;
+    if (opcoes->pipeline && !mapeamento) {
+        // O pipeline lê o descritor a partir da posição atual, sem passar pelo buffer do FILE
+        LeituraDescritor leitura;
+        leitura.descritor = fileno(entrada);
+        leitura.posicao = ftello(entrada);
+        leitura.sequencial = leitura.posicao < 0;
+        leitura.tamanhoBloco = tamanhoBlocoOpcoes(opcoes);
+        leitura.fim = 0;
+        sucesso = executarPipeline(opcoes, lerBlocoDescritor, &leitura, executarCompactacaoBloco,
+                                   gravarBlocoCompactado, &gravacao);
+    } else {
+        sucesso = compactarBlocosEmLotes(entrada, mapeamento, &gravacao);
+    }
+
+    escreverByteEscritor(escritor, BLOCO_FIM);
+    uint64_t bytesIndice = 0;
+    if (opcoes->indice && sucesso) {
+        sucesso = anotarPosicaoIndice(&gravacao.indice, gravacao.posicaoCompactada, gravacao.posicaoOriginal);
+        if (sucesso) bytesIndice = escreverIndiceBlocos(escritor, &gravacao.indice);
+    }
+    liberarIndiceBlocos(&gravacao.indice);
+    // Sem posição que avance no arquivo de saída, o tamanho é o dos blocos, do marcador de fim e do índice
+    if (opcoes->estatisticas) opcoes->estatisticas->bytesSaida = gravacao.posicaoCompactada + 1 + bytesIndice;
+    return sucesso;
+}
+
+//COMPACTA NO FORMATO EM BLOCOS LENDO E GRAVANDO EM SEQUÊNCIA, SEM fseek: SERVE PARA PIPES E SOCKETS
+int compactarFluxo(FILE *entrada, FILE *saida, const OpcoesCompactacao *opcoes) {
+    EstatisticasCodec *estatisticas = opcoes->estatisticas;
+    double inicio = iniciarEstatisticas(estatisticas);
+    off_t inicioSaida = estatisticas ? ftello(saida) : -1;
+
+    // Arquivos comuns são lidos pelo mapeamento, a não ser que o pipeline cuide das leituras;
+    // pipes e falhas do mmap usam leituras com buffer
+    MapeamentoArquivo mapeamento;
+    EscritorBits escritor;
+    if (!inicializarEscritor(&escritor, saida)) return 0;
+    int mapeado = opcoes->mapearEntrada && !opcoes->pipeline && mapearArquivo(entrada, &mapeamento);
+    int sucesso = compactarFormatoBlocos(entrada, mapeado ? &mapeamento : NULL, &escritor, opcoes);
+    double instante = iniciarFases(estatisticas ? estatisticas->segundosFase : NULL);
+    finalizarEscritor(&escritor);
+    if (mapeado) desmapearArquivo(&mapeamento);
+    sucesso = sucesso && fflush(saida) == 0 && !ferror(saida);
+
+    if (estatisticas) {
+        marcarFase(estatisticas->segundosFase, FASE_GRAVACAO, instante);
+        estatisticas->bytesSaida = bytesDesde(saida, inicioSaida, estatisticas->bytesSaida);
+        estatisticas->segundos = relogio() - inicio;
+    }
+    return sucesso;
+}
+
+//REALIZA A COMPACTAÇÃO DO ARQUIVO NO FORMATO ESCOLHIDO; RETORNA 0 EM CASO DE ERRO
+int compactarHuffmanComOpcoes(const char *nomeEntrada, const char *nomeSaida, const OpcoesCompactacao *opcoes) {
+    FILE *entrada = fopen(nomeEntrada, "rb");
+    if (!entrada) return 0;
+    FILE *saida = fopen(nomeSaida, "wb");
+    if (!saida) {
+        fclose(entrada);
+        return 0;
+    }
+
+    int sucesso = 0;
+    if (opcoes->formato == FORMATO_BLOCOS) {
+        sucesso = compactarFluxo(entrada, saida, opcoes);
+    } else {
+        EstatisticasCodec *estatisticas = opcoes->estatisticas;
+        double *fases = estatisticas ? estatisticas->segundosFase : NULL;
+        double inicio = iniciarEstatisticas(estatisticas);
+
+        // Os outros formatos precisam do histograma do arquivo inteiro antes de codificar
+        MapeamentoArquivo mapeamento;
+        const MapeamentoArquivo *fonte =
+            (opcoes->mapearEntrada && mapearArquivo(entrada, &mapeamento)) ? &mapeamento : NULL;
+        uint64_t frequencias[TAMANHO_TABELA];
+        if (contarFrequenciasEntrada(entrada, fonte, frequencias)) {
+            double instante = marcarFase(fases, FASE_HISTOGRAMA, inicio);
+            if (opcoes->formato == FORMATO_ARVORE) {
+                ArenaNos *arena = criarArena();
+                if (arena) {
+                    No *raiz = construirArvoreHuffman(frequencias, arena);
+                    marcarFase(fases, FASE_ARVORE, instante);
+                    sucesso = compactarFormatoArvore(entrada, fonte, saida, raiz, frequencias, estatisticas);
+                }
+                liberarArena(arena);
+            } else {
+                sucesso = compactarFormatoCanonico(entrada, fonte, saida, frequencias, opcoes);
+            }
+        }
+        if (fonte) desmapearArquivo(&mapeamento);
+
+        if (sucesso && estatisticas) {
+            double instante = relogio();
+            sucesso = fflush(saida) == 0;
+            marcarFase(fases, FASE_GRAVACAO, instante);
+            // O formato original volta ao início para gravar o cabeçalho
+            fseeko(saida, 0, SEEK_END);
+            estatisticas->bytesSaida = bytesDesde(saida, 0, 0);
+            estatisticas->bytesEntrada = estatisticas->simbolos;
+            estatisticas->segundos = relogio() - inicio;
+        }
+    }
+
+    fclose(saida);
+    fclose(entrada);
+    return sucesso;
+}
+
+//REALIZA A COMPACTAÇÃO DO ARQUIVO UTILIZANDO HUFFMAN
+void compactarHuffman(const char *nomeEntrada, const char *nomeSaida) {
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    compactarHuffmanComOpcoes(nomeEntrada, nomeSaida, &opcoes);
+}
+
+//SEPARA OS DOIS BYTES DO CABEÇALHO ORIGINAL EM BITS DE LIXO E TAMANHO DA ÁRVORE
+static void separarCabecalho(int byte1, int byte2, int *bitsLixo, int *tamanhoArvore) {
+    *bitsLixo = byte1 >> 5;
+    *tamanhoArvore = (byte1 & 0x1F) << 8 | byte2;
+}
+
+//LÊ O CABEÇALHO DE UM ARQUIVO COMPACTADO, EXTRAINDO INFORMAÇÕES DO CONTROLE
+void lerCabecalho(FILE *arquivo, int *bitsLixo, int *tamanhoArvore) {
+    fseek(arquivo, 0, SEEK_SET);
+    int byte1 = fgetc(arquivo);
+    int byte2 = fgetc(arquivo);
+    separarCabecalho(byte1, byte2, bitsLixo, tamanhoArvore);
+}
+
+//RECONSTROI A ÁRVORE A PARTIR DE ARQUIVOS SEREALIZADOS, COM OS NÓS NA ARENA
+No *lerNo(FILE *arquivo, ArenaNos *arena) {
+    int caractere = fgetc(arquivo);
+    if (caractere == EOF) return NULL;
+
+    // Árvore com mais nós do que 256 símbolos permitem: arquivo corrompido
+    No *no = alocarNo(arena);
+    if (!no) return NULL;
+
+    if (caractere == '\\') {
+        no->simbolo = (unsigned char)fgetc(arquivo);
+    } else if (caractere == '*') {
+        no->esquerda = lerNo(arquivo, arena);
+        no->direita = lerNo(arquivo, arena);
+    } else {
+        no->simbolo = (unsigned char)caractere;
+    }
+    return no;
+}
+
+//PREENCHE A TABELA A PARTIR DOS PARES (CÓDIGO, TAMANHO) DE CADA SÍMBOLO
+static void preencherTabela(const CodigoHuffman codigos[], EntradaDecodificacao tabela[]) {
+    memset(tabela, 0, sizeof(EntradaDecodificacao) << BITS_TABELA);
+    for (int simbolo = 0; simbolo < TAMANHO_TABELA; simbolo++) {
+        int tamanho = codigos[simbolo].tamanho;
+        // Códigos mais longos que a tabela ficam com bits == 0 e são resolvidos à parte
+        if (tamanho == 0 || tamanho > BITS_TABELA) continue;
+        int livres = BITS_TABELA - tamanho;
+        uint32_t inicio = (uint32_t)codigos[simbolo].bits << livres;
+        for (uint32_t i = 0; i < (1u << livres); i++) {
+            tabela[inicio + i].simbolo = (uint8_t)simbolo;
+            tabela[inicio + i].bits = (uint8_t)tamanho;
+        }
+    }
+}
+
+//CONSTROI A TABELA QUE RESOLVE ATÉ BITS_TABELA BITS POR CONSULTA
+void construirTabelaDecodificacao(No *raiz, EntradaDecodificacao tabela[1 << BITS_TABELA]) {
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    if (!gerarCodigosInteiros(raiz, codigos))
+        memset(codigos, 0, sizeof(codigos));
+    preencherTabela(codigos, tabela);
+}
+
+//COMBINA PARES DE CÓDIGOS QUE CABEM JUNTOS EM BITS_TABELA BITS
+static void construirTabelaDupla(const EntradaDecodificacao tabela[], EntradaDupla dupla[]) {
+    const uint32_t mascara = (1u << BITS_TABELA) - 1;
+    for (uint32_t i = 0; i <= mascara; i++) {
+        EntradaDecodificacao primeiro = tabela[i];
+        dupla[i].simbolos[0] = primeiro.simbolo;
+        dupla[i].simbolos[1] = 0;
+        dupla[i].quantidade = primeiro.bits ? 1 : 0;
+        dupla[i].bits = primeiro.bits;
+        if (!primeiro.bits) continue;
+
+        // Os bits após o primeiro código determinam o segundo se ele couber no restante
+        EntradaDecodificacao segundo = tabela[(i << primeiro.bits) & mascara];
+        if (segundo.bits && segundo.bits <= BITS_TABELA - primeiro.bits) {
+            dupla[i].simbolos[1] = segundo.simbolo;
+            dupla[i].quantidade = 2;
+            dupla[i].bits = primeiro.bits + segundo.bits;
+        }
+    }
+}
+
+//PREPARA AS TABELAS E A LISTA ORDENADA DE CÓDIGOS LONGOS PARA QUALQUER CÓDIGO DE PREFIXO
+void construirDecodificador(const CodigoHuffman codigos[TAMANHO_TABELA], Decodificador *decodificador) {
+    preencherTabela(codigos, decodificador->tabela);
+    construirTabelaDupla(decodificador->tabela, decodificador->dupla);
+
+    // Códigos maiores que BITS_TABELA ficam agrupados por tamanho e ordenados pelo valor
+    memset(decodificador->inicioComprimento, 0, sizeof(decodificador->inicioComprimento));
+    decodificador->comprimentoMaximo = 0;
+    for (int simbolo = 0; simbolo < TAMANHO_TABELA; simbolo++) {
+        int tamanho = codigos[simbolo].tamanho;
+        if (tamanho > decodificador->comprimentoMaximo)
+            decodificador->comprimentoMaximo = tamanho;
+        if (tamanho > BITS_TABELA)
+            decodificador->inicioComprimento[tamanho + 1]++;
+    }
+    for (int tamanho = 1; tamanho <= 65; tamanho++)
+        decodificador->inicioComprimento[tamanho] += decodificador->inicioComprimento[tamanho - 1];
+
+    uint16_t proximo[65];
+    memcpy(proximo, decodificador->inicioComprimento, sizeof(proximo));
+    for (int simbolo = 0; simbolo < TAMANHO_TABELA; simbolo++) {
+        int tamanho = codigos[simbolo].tamanho;
+        if (tamanho <= BITS_TABELA) continue;
+        // Inserção ordenada dentro do grupo do mesmo tamanho (no máximo 256 códigos)
+        int posicao = proximo[tamanho]++;
+        while (posicao > decodificador->inicioComprimento[tamanho] &&
+               decodificador->codigosLongos[posicao - 1] > codigos[simbolo].bits) {
+            decodificador->codigosLongos[posicao] = decodificador->codigosLongos[posicao - 1];
+            decodificador->simbolosLongos[posicao] = decodificador->simbolosLongos[posicao - 1];
+            posicao--;
+        }
+        decodificador->codigosLongos[posicao] = codigos[simbolo].bits;
+        decodificador->simbolosLongos[posicao] = (uint8_t)simbolo;
+    }
+}
+
+//RESOLVE UM CÓDIGO MAIOR QUE BITS_TABELA LENDO UM BIT POR VEZ
+static int decodificarCodigoLongo(const Decodificador *decodificador, LeitorBits *leitor, int bitsLixo, uint8_t *simbolo) {
+    uint64_t codigo = 0;
+    for (int tamanho = 1; tamanho <= decodificador->comprimentoMaximo; tamanho++) {
+        if (leitor->bitsNoAcumulador == 0)
+            recarregarLeitor(leitor);
+        if (leitor->bitsNoAcumulador - (leitor->fimArquivo ? bitsLixo : 0) <= 0) return 0;
+        codigo = (codigo << 1) | (leitor->acumulador >> 63);
+        leitor->acumulador <<= 1;
+        leitor->bitsNoAcumulador--;
+        if (tamanho <= BITS_TABELA) continue;
+
+        // Busca binária entre os códigos desse tamanho
+        int inicio = decodificador->inicioComprimento[tamanho];
+        int fim = decodificador->inicioComprimento[tamanho + 1];
+        while (inicio < fim) {
+            int meio = (inicio + fim) / 2;
+            if (decodificador->codigosLongos[meio] < codigo)
+                inicio = meio + 1;
+            else
+                fim = meio;
+        }
+        if (inicio < decodificador->inicioComprimento[tamanho + 1] && decodificador->codigosLongos[inicio] == codigo) {
+            *simbolo = decodificador->simbolosLongos[inicio];
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//DECODIFICA ATÉ 'limite' SÍMBOLOS OU ATÉ O FIM DOS BITS EM 'destino', RETORNANDO QUANTOS FORAM ESCRITOS
+uint64_t decodificarParaMemoria(const Decodificador *decodificador, LeitorBits *leitor, int bitsLixo, uint8_t *destino,
+                                uint64_t limite) {
+    uint64_t posicao = 0;
+
+    while (posicao < limite) {
+        recarregarLeitor(leitor);
+        // No último byte, os bits de lixo não fazem parte do fluxo
+        int disponiveis = leitor->bitsNoAcumulador - (leitor->fimArquivo ? bitsLixo : 0);
+
+        // Caminho rápido: vários símbolos por recarga e até dois por consulta à tabela;
+        // com dois símbolos ainda faltando, gravar o segundo é sempre seguro
+        while (disponiveis >= BITS_TABELA && limite - posicao >= 2) {
+            EntradaDupla par = decodificador->dupla[leitor->acumulador >> (64 - BITS_TABELA)];
+            if (!par.bits) break;
+            destino[posicao] = par.simbolos[0];
+            destino[posicao + 1] = par.simbolos[1];
+            posicao += par.quantidade;
+            leitor->acumulador <<= par.bits;
+            leitor->bitsNoAcumulador -= par.bits;
+            disponiveis -= par.bits;
+        }
+        if (disponiveis < BITS_TABELA && !leitor->fimArquivo) continue;
+        if (disponiveis <= 0 || posicao == limite) break;
+
+        EntradaDecodificacao registro = decodificador->tabela[leitor->acumulador >> (64 - BITS_TABELA)];
+        if (registro.bits) {
+            // Código incompleto no fim do arquivo é descartado
+            if (registro.bits > disponiveis) break;
+            destino[posicao++] = registro.simbolo;
+            leitor->acumulador <<= registro.bits;
+            leitor->bitsNoAcumulador -= registro.bits;
+        } else {
+            uint8_t simbolo;
+            if (!decodificarCodigoLongo(decodificador, leitor, bitsLixo, &simbolo)) break;
+            destino[posicao++] = simbolo;
+        }
+    }
+    return posicao;
+}
+
+//DECODIFICA ATÉ 'limite' SÍMBOLOS OU ATÉ O FIM DOS BITS NO ARQUIVO, RETORNANDO QUANTOS FORAM ESCRITOS
+uint64_t decodificarSimbolos(const Decodificador *decodificador, LeitorBits *leitor, FILE *saida, int bitsLixo, uint64_t limite) {
+    uint8_t *bufferSaida = malloc(TAMANHO_BUFFER_GRANDE);
+    if (!bufferSaida) return 0;
+    uint64_t restantes = limite;
+
+    while (restantes > 0) {
+        uint64_t pedidos = restantes < TAMANHO_BUFFER_GRANDE ? restantes : TAMANHO_BUFFER_GRANDE;
+        uint64_t decodificados = decodificarParaMemoria(decodificador, leitor, bitsLixo, bufferSaida, pedidos);
+        fwrite(bufferSaida, 1, (size_t)decodificados, saida);
+        restantes -= decodificados;
+        if (decodificados < pedidos) break;
+    }
+
+    free(bufferSaida);
+    return limite - restantes;
+}
+
+//DECODIFICA DADOS COMPACTADOS NO FORMATO ORIGINAL A PARTIR DA ÁRVORE LIDA POR lerNo; RETORNA QUANTOS BYTES GRAVOU
+uint64_t decodificarBits(FILE *entrada, FILE *saida, No *raiz, int bitsLixo) {
+    // Árvore com uma única folha não gera bits (mesmo comportamento do formato original)
+    if (!raiz || (!raiz->esquerda && !raiz->direita)) return 0;
+
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    if (!gerarCodigosInteiros(raiz, codigos)) return 0;
+    Decodificador *decodificador = malloc(sizeof(Decodificador));
+    LeitorBits leitor;
+    if (!decodificador || !inicializarLeitor(&leitor, entrada)) {
+        free(decodificador);
+        return 0;
+    }
+    construirDecodificador(codigos, decodificador);
+    uint64_t gravados = decodificarSimbolos(decodificador, &leitor, saida, bitsLixo, UINT64_MAX);
+    liberarLeitor(&leitor);
+    free(decodificador);
+    return gravados;
+}
+
+//DECODIFICA O CORPO DE UM ARQUIVO NO FORMATO CANÔNICO, SEM CONSTRUIR NÓS DE ÁRVORE; 'gravados' RECEBE QUANTOS
+//BYTES FORAM PARA A SAÍDA
+static int descompactarFormatoCanonico(FILE *entrada, FILE *saida, double segundosFase[], uint64_t *gravados) {
+    double instante = iniciarFases(segundosFase);
+    uint64_t totalSimbolos;
+    uint8_t comprimentos[TAMANHO_TABELA];
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    LeitorBits leitor;
+    if (!inicializarLeitor(&leitor, entrada)) return 0;
+    if (!lerVarint(&leitor, &totalSimbolos) || !lerComprimentos(&leitor, comprimentos) ||
+        !gerarCodigosCanonicos(comprimentos, codigos)) {
+        liberarLeitor(&leitor);
+        return 0;
+    }
+
+    // Um único símbolo é gravado sem bits: basta repeti-lo
+    int unico = 0;
+    if (totalSimbolos == 0 || contarSimbolosUsados(comprimentos, &unico) == 1) {
+        *gravados = totalSimbolos;
+        uint8_t repetidos[TAMANHO_BUFFER];
+        memset(repetidos, unico, sizeof(repetidos));
+        while (totalSimbolos > 0) {
+            size_t parte = totalSimbolos < TAMANHO_BUFFER ? (size_t)totalSimbolos : TAMANHO_BUFFER;
+            fwrite(repetidos, 1, parte, saida);
+            totalSimbolos -= parte;
+        }
+        liberarLeitor(&leitor);
+        marcarFase(segundosFase, FASE_DECODIFICACAO, instante);
+        return 1;
+    }
+
+    Decodificador *decodificador = malloc(sizeof(Decodificador));
+    if (!decodificador) {
+        liberarLeitor(&leitor);
+        return 0;
+    }
+    construirDecodificador(codigos, decodificador);
+    instante = marcarFase(segundosFase, FASE_CABECALHO, instante);
+    *gravados = decodificarSimbolos(decodificador, &leitor, saida, 0, totalSimbolos);
+    int sucesso = *gravados == totalSimbolos;
+    marcarFase(segundosFase, FASE_DECODIFICACAO, instante);
+    liberarLeitor(&leitor);
+    free(decodificador);
+    return sucesso;
+}
+
+//LÊ O PRÓXIMO BLOCO COMPACTADO PARA A TAREFA; RETORNA 1, 0 NO MARCADOR DE FIM OU -1 SE ELE ESTIVER CORROMPIDO
+static int lerBlocoCompactado(void *contexto, TarefaBloco *tarefa) {
+    LeitorBits *leitor = contexto;
+    double *fases = tarefa->opcoes->estatisticas ? tarefa->relatorio.segundosFase : NULL;
+    double instante = iniciarFases(fases);
+    uint64_t tamanhoOriginal, tamanhoCorpo;
+    int tipo = lerByteLeitor(leitor);
+    if (tipo == BLOCO_FIM) return 0;
+    // Cada cabeçalho traz o tamanho do corpo, então os blocos são separados sem decodificar nada
+    if (tipo == EOF || !lerVarint(leitor, &tamanhoOriginal) || !lerVarint(leitor, &tamanhoCorpo) ||
+        tamanhoOriginal > TAMANHO_BLOCO_MAXIMO || tamanhoCorpo > tamanhoOriginal ||
+        !reservarBuffer(&tarefa->entrada, &tarefa->capacidadeEntrada, (size_t)tamanhoCorpo) ||
+        !reservarBuffer(&tarefa->saida, &tarefa->capacidadeSaida, (size_t)tamanhoOriginal) ||
+        lerBytesLeitor(leitor, tarefa->entrada, (size_t)tamanhoCorpo) != tamanhoCorpo)
+        return -1;
+    tarefa->tipo = tipo;
+    tarefa->origem = tarefa->entrada;
+    tarefa->tamanhoEntrada = (size_t)tamanhoCorpo;
+    tarefa->tamanhoSaida = (size_t)tamanhoOriginal;
+    marcarFase(fases, FASE_LEITURA, instante);
+    return 1;
+}
+
+//GRAVA NO ARQUIVO OS BYTES DE UM BLOCO DESCOMPACTADO
+static int gravarBlocoDescompactado(void *contexto, TarefaBloco *tarefa) {
+    EstatisticasCodec *estatisticas = tarefa->opcoes->estatisticas;
+    double instante = iniciarFases(estatisticas ? tarefa->relatorio.segundosFase : NULL);
+    int sucesso =
+        tarefa->sucesso && fwrite(tarefa->saida, 1, tarefa->tamanhoSaida, contexto) == tarefa->tamanhoSaida;
+    if (estatisticas) {
+        marcarFase(tarefa->relatorio.segundosFase, FASE_GRAVACAO, instante);
+        somarEstatisticasBloco(estatisticas, &tarefa->relatorio);
+        estatisticas->bytesEntrada += tarefa->tamanhoEntrada;
+        estatisticas->bytesSaida += tarefa->tamanhoSaida;
+    }
+    return sucesso;
+}
+
+//DESCOMPACTA EM LOTES: CADA LOTE DE BLOCOS É LIDO, DECODIFICADO EM PARALELO E GRAVADO ANTES DO PRÓXIMO
+static int descompactarBlocosEmLotes(LeitorBits *leitor, FILE *saida, const OpcoesCompactacao *opcoes) {
+    int threads = opcoes->threads > 0 ? opcoes->threads : threadsDisponiveis();
+    int lote = threads > 1 ? 2 * threads : 1;
+
+    TarefaBloco *tarefas = calloc(lote, sizeof(TarefaBloco));
+    GrupoThreads *grupo = criarGrupoThreads(threads);
+    int sucesso = tarefas && grupo, fim = 0;
+    for (int i = 0; sucesso && i < lote; i++)
+        tarefas[i].opcoes = opcoes;
+    while (sucesso && !fim) {
+        int quantidade = 0;
+        while (quantidade < lote) {
+            int resultado = lerBlocoCompactado(leitor, &tarefas[quantidade]);
+            if (resultado <= 0) {
+                fim = 1;
+                sucesso = resultado == 0;
+                break;
+            }
+            enviarTarefa(grupo, executarDescompactacaoBloco, &tarefas[quantidade]);
+            quantidade++;
+        }
+        aguardarTarefas(grupo);
+
+        // Os blocos íntegros anteriores a um erro ainda são gravados
+        for (int i = 0; i < quantidade; i++) {
+            if (!gravarBlocoDescompactado(saida, &tarefas[i])) {
+                sucesso = 0;
+                break;
+            }
+        }
+    }
+
+    liberarTarefas(tarefas, lote);
+    destruirGrupoThreads(grupo);
+    return sucesso;
+}
+
+//LÊ O FORMATO EM BLOCOS, EM LOTES OU EM PIPELINE, GRAVANDO OS BLOCOS NA ORDEM
+static int descompactarFormatoBlocos(FILE *entrada, FILE *saida, const OpcoesCompactacao *opcoes) {
+    LeitorBits leitor;
+    if (!inicializarLeitor(&leitor, entrada)) return 0;
+    int sucesso;
+    if (opcoes->pipeline)
+        sucesso = executarPipeline(opcoes, lerBlocoCompactado, &leitor, executarDescompactacaoBloco,
+                                   gravarBlocoDescompactado, saida);
+    else
+        sucesso = descompactarBlocosEmLotes(&leitor, saida, opcoes);
+    liberarLeitor(&leitor);
+    return sucesso;
+}
+
+//IDENTIFICA O FORMATO PELOS PRIMEIROS BYTES E DESCOMPACTA O RESTO DA ENTRADA
+static int descompactarQualquerFormato(FILE *entrada, FILE *saida, const OpcoesCompactacao *opcoes) {
+    EstatisticasCodec *estatisticas = opcoes->estatisticas;
+    double *fases = estatisticas ? estatisticas->segundosFase : NULL;
+    int primeiro = fgetc(entrada);
+    int sucesso = 0;
+    // O formato em blocos soma os bytes gravados nas estatísticas; os outros contam pelos decodificadores
+    uint64_t gravados = 0;
+
+    // Arquivos nos formatos novos começam com um byte que o formato original não produz
+    if (primeiro == MARCADOR_FORMATO) {
+        int formato = fgetc(entrada);
+        if (formato == FORMATO_CANONICO) {
+            sucesso = descompactarFormatoCanonico(entrada, saida, fases, &gravados);
+            if (estatisticas) estatisticas->bytesSaida = gravados;
+        } else if (formato == FORMATO_BLOCOS) {
+            sucesso = descompactarFormatoBlocos(entrada, saida, opcoes);
+        }
+        return sucesso && fflush(saida) == 0 && !ferror(saida);
+    }
+
+    // Os dois primeiros bytes trazem:
+    //  - bitsLixo: quantos zeros foram adicionados no último byte
+    //  - tamanhoArvore: quantos bytes a serialização da árvore ocupa
+    int segundo = fgetc(entrada);
+    if (primeiro == EOF || segundo == EOF) return 0;
+    int bitsLixo, tamanhoArvore;
+    separarCabecalho(primeiro, segundo, &bitsLixo, &tamanhoArvore);
+
+    // Reconstrói a árvore de Huffman a partir dos próximos bytes (percurso pré-ordem),
+    // com todos os nós em uma única arena
+    double instante = iniciarFases(fases);
+    ArenaNos *arena = criarArena();
+    No *raiz = arena ? lerNo(entrada, arena) : NULL;
+    instante = marcarFase(fases, FASE_CABECALHO, instante);
+    if (raiz) {
+        // Percorre o fluxo de bits restante, decodificando por tabela
+        // e escrevendo os símbolos no arquivo de saída
+        gravados = decodificarBits(entrada, saida, raiz, bitsLixo);
+        if (estatisticas) estatisticas->bytesSaida = gravados;
+        sucesso = fflush(saida) == 0 && !ferror(saida);
+        marcarFase(fases, FASE_DECODIFICACAO, instante);
+    }
+    liberarArena(arena);
+    return sucesso;
+}
+
+//DESCOMPACTA QUALQUER FORMATO LENDO E GRAVANDO EM SEQUÊNCIA, SEM fseek; RETORNA 0 SE A ENTRADA ESTIVER INCOMPLETA
+int descompactarFluxo(FILE *entrada, FILE *saida, const OpcoesCompactacao *opcoes) {
+    EstatisticasCodec *estatisticas = opcoes->estatisticas;
+    if (!estatisticas) return descompactarQualquerFormato(entrada, saida, opcoes);
+
+    // Todos os formatos contam os bytes gravados, o que vale para pipes e /dev/null. A entrada vem da posição
+    // sempre que possível, pois a contagem dos blocos omite os cabeçalhos
+    double inicio = iniciarEstatisticas(estatisticas);
+    off_t inicioEntrada = ftello(entrada), inicioSaida = ftello(saida);
+    int sucesso = descompactarQualquerFormato(entrada, saida, opcoes);
+    estatisticas->bytesEntrada = bytesDesde(entrada, inicioEntrada, estatisticas->bytesEntrada);
+    estatisticas->bytesSaida = bytesDesde(saida, inicioSaida, estatisticas->bytesSaida);
+    estatisticas->segundos = relogio() - inicio;
+    return sucesso;
+}
+
+//DESCOMPACTA UM ARQUIVO EM QUALQUER FORMATO; RETORNA 0 SE ELE NÃO PUDER SER LIDO POR INTEIRO
+int descompactarHuffmanComOpcoes(const char *nomeEntrada, const char *nomeSaida, const OpcoesCompactacao *opcoes) {
+    // Abre o arquivo compactado para leitura binária
+    FILE *entrada = fopen(nomeEntrada, "rb");
+    if (!entrada) 
+        return 0;  // Se não conseguir abrir, aborta
+
+    // Abre/Cria o arquivo de saída para escrita binária
+    FILE *saida = fopen(nomeSaida, "wb");
+    if (!saida) {
+        fclose(entrada);
+        return 0;  // Se falhar, garante fechar o de entrada antes de sair
+    }
+
+    int sucesso = descompactarFluxo(entrada, saida, opcoes);
+
+    // Fecha ambos os arquivos ao final da operação
+    fclose(entrada);
+    fclose(saida);
+    return sucesso;
+}
+
+// Descompacta um arquivo Huffman, lendo do arquivo de entrada e escrevendo no arquivo de saída
+void descompactarHuffman(const char *nomeEntrada, const char *nomeSaida) {
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    descompactarHuffmanComOpcoes(nomeEntrada, nomeSaida, &opcoes);
+}
+
+//GERA AUTOMATICAMENTE O NOME DE SAIDA .HUFF
+void gerarNomeArquivoComExtensaoHuff(char *entrada, char *saida) {
+    const char *ext = strrchr(entrada, '.');
+    size_t len = ext ? (size_t)(ext - entrada) : strlen(entrada);
+    memcpy(saida, entrada, len);
+    strcpy(saida + len, ".huff");
+}
+
+// ----------------------------------------------------
+// Funções para compactação em memória
+// ----------------------------------------------------
+
+//MAIOR TAMANHO QUE compactarMemoria PODE PRODUZIR PARA 'tamanho' BYTES (opcoes NULL = padrão): TODOS OS BLOCOS CRUS
+size_t limiteCompactacao(size_t tamanho, const OpcoesCompactacao *opcoes) {
+    OpcoesCompactacao padrao;
+    if (!opcoes) {
+        opcoesPadrao(&padrao);
+        opcoes = &padrao;
+    }
+    size_t tamanhoBloco = tamanhoBlocoOpcoes(opcoes);
+    size_t blocos = (tamanho + tamanhoBloco - 1) / tamanhoBloco;
+    // Marcador, formato e fim dos blocos, mais o tipo e os dois varints de cada bloco
+    size_t limite = 3 + tamanho + blocos * MARGEM_CABECALHO_BLOCO;
+    // O índice guarda a quantidade de blocos e dois varints por bloco, seguidos do rodapé
+    if (opcoes->indice)
+        limite += 10 + blocos * 20 + TAMANHO_RODAPE_INDICE;
+    return limite;
+}
+
+//COMPACTA UM TRECHO DE MEMÓRIA EM OUTRO NO FORMATO EM BLOCOS, SEM ABRIR ARQUIVOS (opcoes NULL = padrão);
+//RETORNA 0 SE 'capacidadeSaida' NÃO BASTAR, O QUE NÃO ACONTECE COM limiteCompactacao BYTES
+int compactarMemoria(const void *entrada, size_t tamanhoEntrada, void *saida, size_t capacidadeSaida,
+                     size_t *tamanhoSaida, const OpcoesCompactacao *opcoes) {
+    OpcoesCompactacao padrao;
+    if (!opcoes) {
+        opcoesPadrao(&padrao);
+        opcoes = &padrao;
+    }
+    if (opcoes->formato != FORMATO_BLOCOS) return 0;
+    double inicio = iniciarEstatisticas(opcoes->estatisticas);
+
+    // O escritor em memória exige 4 bytes; só a saída da entrada vazia (3 bytes) cabe em menos que isso
+    uint8_t reserva[4];
+    int pequena = capacidadeSaida < sizeof(reserva);
+    EscritorBits escritor;
+    inicializarEscritorMemoria(&escritor, pequena ? reserva : saida, pequena ? sizeof(reserva) : capacidadeSaida);
+
+    // A entrada faz o papel de um arquivo já mapeado
+    MapeamentoArquivo trecho;
+    trecho.dados = entrada;
+    trecho.tamanho = tamanhoEntrada;
+    trecho.base = NULL;
+    trecho.tamanhoMapeado = 0;
+    int sucesso = compactarFormatoBlocos(NULL, &trecho, &escritor, opcoes);
+    finalizarEscritor(&escritor);
+    if (opcoes->estatisticas) {
+        opcoes->estatisticas->bytesSaida = escritor.posicao;
+        opcoes->estatisticas->segundos = relogio() - inicio;
+    }
+    if (!sucesso || escritor.estouro || escritor.posicao > capacidadeSaida) return 0;
+
+    if (pequena) memcpy(saida, reserva, escritor.posicao);
+    *tamanhoSaida = escritor.posicao;
+    return 1;
+}
+
+//LÊ UM INTEIRO ESCRITO POR escreverVarint EM dados[*posicao], AVANÇANDO A POSIÇÃO
+static int lerVarintMemoria(const uint8_t *dados, size_t tamanho, size_t *posicao, uint64_t *valor) {
+    *valor = 0;
+    for (int deslocamento = 0; deslocamento < 64 && *posicao < tamanho; deslocamento += 7) {
+        uint8_t byte = dados[(*posicao)++];
+        *valor |= (uint64_t)(byte & 0x7F) << deslocamento;
+        if (!(byte & 0x80)) return 1;
+    }
+    return 0;
+}
+
+//PERCORRE OS CABEÇALHOS DOS BLOCOS EM MEMÓRIA, CONTANDO OS BLOCOS E SOMANDO OS TAMANHOS ORIGINAIS; COM 'tarefas',
+//PREENCHE UMA TAREFA POR BLOCO QUE DESCOMPACTA O CORPO DIRETO NA SUA POSIÇÃO EM 'saida'
+static int percorrerBlocosMemoria(const uint8_t *dados, size_t tamanho, TarefaBloco *tarefas, uint8_t *saida,
+                                  size_t *blocos, uint64_t *tamanhoOriginal) {
+    *blocos = 0;
+    *tamanhoOriginal = 0;
+    if (tamanho < 2 || dados[0] != MARCADOR_FORMATO || dados[1] != FORMATO_BLOCOS) return 0;
+
+    size_t posicao = 2;
+    while (posicao < tamanho) {
+        int tipo = dados[posicao++];
+        // O índice que pode vir depois do fim não é necessário aqui
+        if (tipo == BLOCO_FIM) return 1;
+        uint64_t tamanhoBloco, tamanhoCorpo;
+        if (!lerVarintMemoria(dados, tamanho, &posicao, &tamanhoBloco) ||
+            !lerVarintMemoria(dados, tamanho, &posicao, &tamanhoCorpo) || tamanhoBloco > TAMANHO_BLOCO_MAXIMO ||
+            tamanhoCorpo > tamanhoBloco || tamanhoCorpo > tamanho - posicao)
+            return 0;
+        if (tarefas) {
+            TarefaBloco *tarefa = &tarefas[*blocos];
+            tarefa->tipo = tipo;
+            tarefa->origem = dados + posicao;
+            tarefa->tamanhoEntrada = (size_t)tamanhoCorpo;
+            tarefa->saida = saida + *tamanhoOriginal;
+            tarefa->tamanhoSaida = (size_t)tamanhoBloco;
+        }
+        posicao += (size_t)tamanhoCorpo;
+        *tamanhoOriginal += tamanhoBloco;
+        (*blocos)++;
+    }
+    return 0;
+}
+
+//INFORMA QUANTOS BYTES A DESCOMPACTAÇÃO DE UM TRECHO NO FORMATO EM BLOCOS PRODUZ, SEM DECODIFICAR NADA
+int tamanhoDescompactadoMemoria(const void *entrada, size_t tamanhoEntrada, uint64_t *tamanhoOriginal) {
+    size_t blocos;
+    return percorrerBlocosMemoria(entrada, tamanhoEntrada, NULL, NULL, &blocos, tamanhoOriginal);
+}
+
+//DESCOMPACTA UM TRECHO DE MEMÓRIA NO FORMATO EM BLOCOS EM OUTRO, COM OS BLOCOS EM PARALELO (opcoes NULL = padrão);
+//RETORNA 0 SE A ENTRADA ESTIVER CORROMPIDA OU SE 'capacidadeSaida' NÃO BASTAR
+int descompactarMemoria(const void *entrada, size_t tamanhoEntrada, void *saida, size_t capacidadeSaida,
+                        size_t *tamanhoSaida, const OpcoesCompactacao *opcoes) {
+    EstatisticasCodec *estatisticas = opcoes ? opcoes->estatisticas : NULL;
+    double inicio = iniciarEstatisticas(estatisticas);
+    size_t blocos;
+    uint64_t tamanhoOriginal;
+    if (!percorrerBlocosMemoria(entrada, tamanhoEntrada, NULL, NULL, &blocos, &tamanhoOriginal) ||
+        tamanhoOriginal > capacidadeSaida)
+        return 0;
+
+    int threads = opcoes && opcoes->threads > 0 ? opcoes->threads : threadsDisponiveis();
+    if (blocos < (size_t)threads) threads = blocos > 0 ? (int)blocos : 1;
+    TarefaBloco *tarefas = calloc(blocos ? blocos : 1, sizeof(TarefaBloco));
+    GrupoThreads *grupo = criarGrupoThreads(threads);
+    int sucesso = tarefas && grupo;
+    if (sucesso) {
+        // Cada bloco vai direto para o seu lugar em 'saida', sem buffers intermediários
+        percorrerBlocosMemoria(entrada, tamanhoEntrada, tarefas, saida, &blocos, &tamanhoOriginal);
+        for (size_t i = 0; i < blocos; i++) {
+            tarefas[i].opcoes = opcoes;
+            enviarTarefa(grupo, executarDescompactacaoBloco, &tarefas[i]);
+        }
+        aguardarTarefas(grupo);
+        for (size_t i = 0; i < blocos; i++) {
+            if (!tarefas[i].sucesso) sucesso = 0;
+            if (estatisticas) somarEstatisticasBloco(estatisticas, &tarefas[i].relatorio);
+        }
+    }
+    free(tarefas);
+    destruirGrupoThreads(grupo);
+    if (sucesso) *tamanhoSaida = (size_t)tamanhoOriginal;
+    if (estatisticas) {
+        estatisticas->bytesEntrada = tamanhoEntrada;
+        estatisticas->bytesSaida = sucesso ? tamanhoOriginal : 0;
+        estatisticas->segundos = relogio() - inicio;
+    }
+    return sucesso;
+}
+
+// ----------------------------------------------------
+// Funções para dicionários de códigos
+// ----------------------------------------------------
+
+//GERA OS CÓDIGOS E A TABELA DE DECODIFICAÇÃO DOS TAMANHOS DO DICIONÁRIO; RECUSA TAMANHOS QUE A TABELA NÃO RESOLVA
+int prepararDicionario(Dicionario *dicionario) {
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        if (dicionario->comprimentos[s] > BITS_TABELA) return 0;
+    if (!gerarCodigosCanonicos(dicionario->comprimentos, dicionario->codigos)) return 0;
+    Decodificador *decodificador = malloc(sizeof(Decodificador));
+    if (!decodificador) return 0;
+    construirDecodificador(dicionario->codigos, decodificador);
+    memcpy(dicionario->tabela, decodificador->tabela, sizeof(dicionario->tabela));
+    free(decodificador);
+    return tabelaCompleta(dicionario->tabela);
+}
+
+//MONTA O DICIONÁRIO A PARTIR DE UM HISTOGRAMA DE AMOSTRAS. TODO BYTE GANHA UM CÓDIGO, MESMO SEM APARECER NAS
+//AMOSTRAS, E NENHUM PASSA DE BITS_TABELA BITS, PARA QUE A DECODIFICAÇÃO SEJA UMA CONSULTA POR SÍMBOLO
+int construirDicionario(const uint64_t frequencias[TAMANHO_TABELA], Dicionario *dicionario) {
+    uint64_t suavizadas[TAMANHO_TABELA];
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        suavizadas[s] = frequencias[s] + 1;
+    if (!escolherComprimentos(suavizadas, BITS_TABELA, dicionario->comprimentos, NULL)) return 0;
+    return prepararDicionario(dicionario);
+}
+
+//TREINA O DICIONÁRIO COM O HISTOGRAMA SOMADO DE VÁRIOS ARQUIVOS DE AMOSTRA
+int treinarDicionario(char *const nomesAmostras[], int quantidade, Dicionario *dicionario) {
+    uint64_t frequencias[TAMANHO_TABELA] = {0};
+    uint8_t *buffer = malloc(TAMANHO_BUFFER_GRANDE);
+    if (!buffer) return 0;
+    int sucesso = 1;
+    for (int i = 0; i < quantidade && sucesso; i++) {
+        FILE *amostra = fopen(nomesAmostras[i], "rb");
+        if (!amostra) {
+            sucesso = 0;
+            break;
+        }
+        size_t lidos;
+        while ((lidos = fread(buffer, 1, TAMANHO_BUFFER_GRANDE, amostra)) > 0)
+            acumularFrequencias(buffer, lidos, frequencias);
+        sucesso = !ferror(amostra);
+        fclose(amostra);
+    }
+    free(buffer);
+    return sucesso && construirDicionario(frequencias, dicionario);
+}
+
+//GRAVA O DICIONÁRIO: ASSINATURA SEGUIDA DA TABELA DE TAMANHOS NA REPRESENTAÇÃO MAIS CURTA
+int salvarDicionario(const char *nomeArquivo, const Dicionario *dicionario) {
+    FILE *arquivo = fopen(nomeArquivo, "wb");
+    if (!arquivo) return 0;
+    EscritorBits escritor;
+    int sucesso = fwrite(ASSINATURA_DICIONARIO, 1, 4, arquivo) == 4 && inicializarEscritor(&escritor, arquivo);
+    if (sucesso) {
+        escreverComprimentos(dicionario->comprimentos, &escritor);
+        finalizarEscritor(&escritor);
+    }
+    sucesso = sucesso && fflush(arquivo) == 0 && !ferror(arquivo);
+    return fclose(arquivo) == 0 && sucesso;
+}
+
+//LÊ UM DICIONÁRIO GRAVADO POR salvarDicionario
+int carregarDicionario(const char *nomeArquivo, Dicionario *dicionario) {
+    FILE *arquivo = fopen(nomeArquivo, "rb");
+    if (!arquivo) return 0;
+    char assinatura[4];
+    LeitorBits leitor;
+    int sucesso = fread(assinatura, 1, 4, arquivo) == 4 && memcmp(assinatura, ASSINATURA_DICIONARIO, 4) == 0 &&
+                  inicializarLeitor(&leitor, arquivo);
+    if (sucesso) {
+        sucesso = lerComprimentos(&leitor, dicionario->comprimentos) && prepararDicionario(dicionario);
+        liberarLeitor(&leitor);
+    }
+    fclose(arquivo);
+    return sucesso;
+}
+
+//MAIOR TAMANHO POSSÍVEL DE UMA MENSAGEM COMPACTADA: OS BYTES CRUS E UM VARINT
+size_t limiteMensagem(size_t tamanho) {
+    return tamanho + 10;
+}
+
+//GRAVA UM VARINT EM MEMÓRIA; RETORNA OS BYTES USADOS
+static size_t gravarVarintMemoria(uint8_t *destino, uint64_t valor) {
+    size_t usados = 0;
+    while (valor >= 0x80) {
+        destino[usados++] = (uint8_t)(valor | 0x80);
+        valor >>= 7;
+    }
+    destino[usados++] = (uint8_t)valor;
+    return usados;
+}
+
+//COMPACTA UMA MENSAGEM COM O DICIONÁRIO, SEM TABELA PRÓPRIA: UM VARINT COM O TAMANHO ORIGINAL E O MODO NO BIT
+//MAIS BAIXO, SEGUIDO DOS BITS OU, QUANDO A CODIFICAÇÃO NÃO COMPENSA, DOS BYTES CRUS. RETORNA 0 SE NÃO COUBER
+int compactarMensagem(const Dicionario *dicionario, const void *entrada, size_t tamanhoEntrada, void *saida,
+                      size_t capacidadeSaida, size_t *tamanhoSaida) {
+    const uint8_t *dados = entrada;
+    uint8_t *destino = saida;
+
+    // O tamanho codificado é conhecido antes: um símbolo sem código no dicionário força a mensagem crua
+    uint64_t bits = 0;
+    int codificar = 1;
+    for (size_t i = 0; i < tamanhoEntrada; i++) {
+        if (!dicionario->comprimentos[dados[i]]) codificar = 0;
+        bits += dicionario->comprimentos[dados[i]];
+    }
+    size_t tamanhoDados = (size_t)((bits + 7) / 8);
+    if (tamanhoDados >= tamanhoEntrada) codificar = 0;
+    if (!codificar) tamanhoDados = tamanhoEntrada;
+
+    uint8_t cabecalho[10];
+    size_t tamanhoCabecalho = gravarVarintMemoria(cabecalho, (uint64_t)tamanhoEntrada << 1 | (uint64_t)codificar);
+    if (tamanhoCabecalho + tamanhoDados > capacidadeSaida) return 0;
+    memcpy(destino, cabecalho, tamanhoCabecalho);
+    destino += tamanhoCabecalho;
+    *tamanhoSaida = tamanhoCabecalho + tamanhoDados;
+    if (!codificar) {
+        memcpy(destino, dados, tamanhoEntrada);
+        return 1;
+    }
+
+    // Os códigos têm até BITS_TABELA bits, então o acumulador nunca passa de 32 + BITS_TABELA bits pendentes
+    uint64_t acumulador = 0;
+    int pendentes = 0;
+    for (size_t i = 0; i < tamanhoEntrada; i++) {
+        const CodigoHuffman *codigo = &dicionario->codigos[dados[i]];
+        acumulador = (acumulador << codigo->tamanho) | codigo->bits;
+        pendentes += codigo->tamanho;
+        if (pendentes >= 32) {
+            pendentes -= 32;
+            gravarPalavraBigEndian(destino, (uint32_t)(acumulador >> pendentes));
+            destino += 4;
+        }
+    }
+    for (; pendentes > 0; pendentes -= 8)
+        *destino++ = (uint8_t)(pendentes >= 8 ? acumulador >> (pendentes - 8) : acumulador << (8 - pendentes));
+    return 1;
+}
+
+//LÊ DO CABEÇALHO DE UMA MENSAGEM O TAMANHO QUE ELA TERÁ DESCOMPACTADA
+int tamanhoMensagemDescompactada(const void *mensagem, size_t tamanhoMensagem, uint64_t *tamanhoOriginal) {
+    size_t posicao = 0;
+    uint64_t cabecalho;
+    if (!lerVarintMemoria(mensagem, tamanhoMensagem, &posicao, &cabecalho)) return 0;
+    *tamanhoOriginal = cabecalho >> 1;
+    return 1;
+}
+
+//DESCOMPACTA UMA MENSAGEM GRAVADA POR compactarMensagem COM O MESMO DICIONÁRIO; RETORNA 0 SE ELA ESTIVER
+//CORROMPIDA OU SE 'capacidadeSaida' NÃO BASTAR
+int descompactarMensagem(const Dicionario *dicionario, const void *mensagem, size_t tamanhoMensagem, void *saida,
+                         size_t capacidadeSaida, size_t *tamanhoSaida) {
+    const uint8_t *dados = mensagem;
+    uint8_t *destino = saida;
+    size_t posicao = 0;
+    uint64_t cabecalho;
+    if (!lerVarintMemoria(dados, tamanhoMensagem, &posicao, &cabecalho) || (cabecalho >> 1) > capacidadeSaida)
+        return 0;
+    size_t quantidade = (size_t)(cabecalho >> 1);
+    *tamanhoSaida = quantidade;
+    if (!(cabecalho & 1)) {
+        if (tamanhoMensagem - posicao != quantidade) return 0;
+        memcpy(destino, dados + posicao, quantidade);
+        return 1;
+    }
+
+    LeitorBits leitor;
+    inicializarLeitorMemoria(&leitor, dados + posicao, tamanhoMensagem - posicao);
+    size_t i = 0;
+    while (quantidade - i >= 5 && leitor.posicao + 8 <= leitor.tamanho) {
+        recarregarPalavra(&leitor);
+        for (int j = 0; j < 5; j++)
+            destino[i++] = consumirSimboloTabela(dicionario->tabela, &leitor);
+    }
+    for (; i < quantidade; i++) {
+        if (leitor.bitsNoAcumulador < BITS_TABELA)
+            recarregarLeitor(&leitor);
+        if (dicionario->tabela[leitor.acumulador >> (64 - BITS_TABELA)].bits > leitor.bitsNoAcumulador) return 0;
+        destino[i] = consumirSimboloTabela(dicionario->tabela, &leitor);
+    }
+    return 1;
+}
+
+// ----------------------------------------------------
+// Funções para acesso aleatório no formato em blocos
+// ----------------------------------------------------
+
+//LÊ UM INTEIRO ESCRITO POR escreverVarint DIRETO DO ARQUIVO, SEM BUFFER PRÓPRIO
+static int lerVarintArquivo(FILE *arquivo, uint64_t *valor) {
+    *valor = 0;
+    for (int deslocamento = 0; deslocamento < 64; deslocamento += 7) {
+        int byte = fgetc(arquivo);
+        if (byte == EOF) return 0;
+        *valor |= (uint64_t)(byte & 0x7F) << deslocamento;
+        if (!(byte & 0x80)) return 1;
+    }
+    return 0;
+}
+
+//LÊ O CABEÇALHO DO BLOCO NA POSIÇÃO ATUAL DO ARQUIVO; RETORNA 0 NO FIM DOS BLOCOS OU SE ELE ESTIVER CORROMPIDO
+static int lerCabecalhoBloco(FILE *arquivo, int *tipo, uint64_t *tamanhoOriginal, uint64_t *tamanhoCorpo) {
+    *tipo = fgetc(arquivo);
+    return *tipo != EOF && *tipo != BLOCO_FIM && lerVarintArquivo(arquivo, tamanhoOriginal) &&
+           lerVarintArquivo(arquivo, tamanhoCorpo) && *tamanhoOriginal <= TAMANHO_BLOCO_MAXIMO &&
+           *tamanhoCorpo <= *tamanhoOriginal;
+}
+
+//MONTA O ÍNDICE A PARTIR DO RODAPÉ; RETORNA 0 SE NÃO HOUVER RODAPÉ VÁLIDO
+static int lerRodapeIndice(FILE *arquivo, IndiceBlocos *indice) {
+    uint8_t rodape[TAMANHO_RODAPE_INDICE];
+    if (fseeko(arquivo, -TAMANHO_RODAPE_INDICE, SEEK_END) != 0 ||
+        fread(rodape, 1, TAMANHO_RODAPE_INDICE, arquivo) != TAMANHO_RODAPE_INDICE ||
+        memcmp(rodape + 4, ASSINATURA_INDICE, 4) != 0)
+        return 0;
+    uint64_t tamanhoArquivo = (uint64_t)ftello(arquivo);
+    uint32_t tamanhoIndice = (uint32_t)rodape[0] << 24 | (uint32_t)rodape[1] << 16 | (uint32_t)rodape[2] << 8 | rodape[3];
+    // Assinatura, marcador de fim e rodapé também ocupam espaço
+    if ((uint64_t)tamanhoIndice + TAMANHO_RODAPE_INDICE + 3 > tamanhoArquivo) return 0;
+
+    uint8_t *bytes = malloc(tamanhoIndice ? tamanhoIndice : 1);
+    if (!bytes) return 0;
+    if (fseeko(arquivo, (off_t)(tamanhoArquivo - TAMANHO_RODAPE_INDICE - tamanhoIndice), SEEK_SET) != 0 ||
+        fread(bytes, 1, tamanhoIndice, arquivo) != tamanhoIndice) {
+        free(bytes);
+        return 0;
+    }
+
+    LeitorBits leitor;
+    uint64_t quantidade, posicaoCompactada = 2, posicaoOriginal = 0;
+    inicializarLeitorMemoria(&leitor, bytes, tamanhoIndice);
+    int sucesso = lerVarint(&leitor, &quantidade) && quantidade <= tamanhoIndice;
+    for (uint64_t i = 0; sucesso && i < quantidade; i++) {
+        uint64_t tamanhoCompactado, tamanhoOriginal;
+        sucesso = lerVarint(&leitor, &tamanhoCompactado) && lerVarint(&leitor, &tamanhoOriginal) &&
+                  tamanhoOriginal <= TAMANHO_BLOCO_MAXIMO &&
+                  anotarPosicaoIndice(indice, posicaoCompactada, posicaoOriginal);
+        indice->quantidadeBlocos++;
+        posicaoCompactada += tamanhoCompactado;
+        posicaoOriginal += tamanhoOriginal;
+    }
+    free(bytes);
+
+    // Os blocos, o marcador de fim e o índice precisam ocupar exatamente o arquivo
+    return sucesso && anotarPosicaoIndice(indice, posicaoCompactada, posicaoOriginal) &&
+           posicaoCompactada + 1 + tamanhoIndice + TAMANHO_RODAPE_INDICE == tamanhoArquivo;
+}
+
+//MONTA O ÍNDICE PULANDO DE CABEÇALHO EM CABEÇALHO, SEM LER OS CORPOS DOS BLOCOS
+static int percorrerCabecalhosBlocos(FILE *arquivo, IndiceBlocos *indice) {
+    uint64_t posicaoCompactada = 2, posicaoOriginal = 0, tamanhoOriginal, tamanhoCorpo;
+    int tipo;
+    if (fseeko(arquivo, 2, SEEK_SET) != 0) return 0;
+    while (lerCabecalhoBloco(arquivo, &tipo, &tamanhoOriginal, &tamanhoCorpo)) {
+        if (!anotarPosicaoIndice(indice, posicaoCompactada, posicaoOriginal) ||
+            fseeko(arquivo, (off_t)tamanhoCorpo, SEEK_CUR) != 0)
+            return 0;
+        indice->quantidadeBlocos++;
+        posicaoCompactada = (uint64_t)ftello(arquivo);
+        posicaoOriginal += tamanhoOriginal;
+    }
+    return tipo == BLOCO_FIM && anotarPosicaoIndice(indice, posicaoCompactada, posicaoOriginal);
+}
+
+//CARREGA O ÍNDICE DE UM ARQUIVO NO FORMATO EM BLOCOS, PELO RODAPÉ OU, SEM ELE, PELOS CABEÇALHOS DOS BLOCOS
+int lerIndiceBlocos(FILE *arquivo, IndiceBlocos *indice) {
+    uint8_t assinatura[2];
+    memset(indice, 0, sizeof(IndiceBlocos));
+    if (fseeko(arquivo, 0, SEEK_SET) != 0 || fread(assinatura, 1, 2, arquivo) != 2 ||
+        assinatura[0] != MARCADOR_FORMATO || assinatura[1] != FORMATO_BLOCOS)
+        return 0;
+    if (lerRodapeIndice(arquivo, indice)) return 1;
+
+    indice->quantidadeBlocos = 0;
+    if (percorrerCabecalhosBlocos(arquivo, indice)) return 1;
+    liberarIndiceBlocos(indice);
+    return 0;
+}
+
+//LIBERA AS ENTRADAS DO ÍNDICE
+void liberarIndiceBlocos(IndiceBlocos *indice) {
+    free(indice->entradas);
+    memset(indice, 0, sizeof(IndiceBlocos));
+}
+
+//DESCOMPACTA 'tamanho' BYTES A PARTIR DE 'inicio' LENDO SÓ OS BLOCOS QUE OS CONTÊM; RETORNA QUANTOS FORAM COPIADOS
+size_t descompactarIntervaloComIndice(FILE *entrada, const IndiceBlocos *indice, uint64_t inicio, size_t tamanho,
+                                      void *destino) {
+    uint64_t total = indice->entradas ? indice->entradas[indice->quantidadeBlocos].posicaoOriginal : 0;
+    if (inicio >= total) return 0;
+    if (tamanho > total - inicio) tamanho = (size_t)(total - inicio);
+
+    // Busca binária pelo último bloco que começa antes de 'inicio'
+    size_t bloco = 0, fimBusca = indice->quantidadeBlocos;
+    while (fimBusca - bloco > 1) {
+        size_t meio = (bloco + fimBusca) / 2;
+        if (indice->entradas[meio].posicaoOriginal <= inicio)
+            bloco = meio;
+        else
+            fimBusca = meio;
+    }
+
+    uint8_t *saida = destino, *corpo = NULL, *temporario = NULL;
+    size_t capacidadeCorpo = 0, capacidadeTemporario = 0, copiados = 0;
+    while (copiados < tamanho) {
+        const EntradaIndice *atual = &indice->entradas[bloco++];
+        uint64_t tamanhoEsperado = atual[1].posicaoOriginal - atual->posicaoOriginal;
+        uint64_t tamanhoOriginal, tamanhoCorpo;
+        int tipo;
+        if (fseeko(entrada, (off_t)atual->posicaoCompactada, SEEK_SET) != 0 ||
+            !lerCabecalhoBloco(entrada, &tipo, &tamanhoOriginal, &tamanhoCorpo) || tamanhoOriginal != tamanhoEsperado ||
+            !reservarBuffer(&corpo, &capacidadeCorpo, (size_t)tamanhoCorpo) ||
+            fread(corpo, 1, (size_t)tamanhoCorpo, entrada) != tamanhoCorpo)
+            break;
+
+        // O bloco só é decodificado até o fim do trecho pedido; sem deslocamento, direto no destino
+        size_t deslocamento = (size_t)(inicio + copiados - atual->posicaoOriginal);
+        size_t parte = (size_t)tamanhoOriginal - deslocamento;
+        if (parte > tamanho - copiados) parte = tamanho - copiados;
+        if (deslocamento == 0) {
+            if (!descompactarInicioBloco(tipo, corpo, (size_t)tamanhoCorpo, saida + copiados, (size_t)tamanhoOriginal,
+                                         parte))
+                break;
+        } else {
+            if (!reservarBuffer(&temporario, &capacidadeTemporario, deslocamento + parte) ||
+                !descompactarInicioBloco(tipo, corpo, (size_t)tamanhoCorpo, temporario, (size_t)tamanhoOriginal,
+                                         deslocamento + parte))
+                break;
+            memcpy(saida + copiados, temporario + deslocamento, parte);
+        }
+        copiados += parte;
+    }
+
+    free(corpo);
+    free(temporario);
+    return copiados;
+}
+
+//DESCOMPACTA UM INTERVALO DOS DADOS ORIGINAIS, CARREGANDO O ÍNDICE A CADA CHAMADA
+size_t descompactarIntervalo(FILE *entrada, uint64_t inicio, size_t tamanho, void *destino) {
+    IndiceBlocos indice;
+    if (!lerIndiceBlocos(entrada, &indice)) return 0;
+    size_t copiados = descompactarIntervaloComIndice(entrada, &indice, inicio, tamanho, destino);
+    liberarIndiceBlocos(&indice);
+    return copiados;
+}
+
+
+// ----------------------------------------------------
+// Funções para pacotes de arquivos
+// ----------------------------------------------------
+
+// Um arquivo a incluir no pacote; os pequenos são compactados inteiros na memória por uma thread do grupo
+typedef struct {
+    char *caminho;              // Como foi encontrado no disco
+    const char *nome;           // Como fica no pacote, dentro de 'caminho'
+    uint64_t tamanhoOriginal;
+    uint64_t tamanhoCompactado;
+    int grande;                 // Compactado pela thread que grava, direto no pacote e com os blocos em paralelo
+    dev_t dispositivo;
+    ino_t inode;
+    uint8_t *compactado;
+    const OpcoesCompactacao *opcoes;
+    int sucesso;
+    int erro;                   // errno da abertura ou da leitura que falhou
+} TarefaPacote;
+
+// Caminhos dos arquivos comuns encontrados ao percorrer os diretórios
+typedef struct {
+    char **caminhos;
+    size_t quantidade;
+    size_t capacidade;
+} ListaCaminhos;
+
+//ACRESCENTA UMA CÓPIA DO CAMINHO À LISTA
+static int acrescentarCaminho(ListaCaminhos *lista, const char *caminho) {
+    if (lista->quantidade == lista->capacidade) {
+        size_t capacidade = lista->capacidade ? 2 * lista->capacidade : 64;
+        char **maior = realloc(lista->caminhos, capacidade * sizeof(char *));
+        if (!maior) return 0;
+        lista->caminhos = maior;
+        lista->capacidade = capacidade;
+    }
+    char *copia = strdup(caminho);
+    if (!copia) return 0;
+    lista->caminhos[lista->quantidade++] = copia;
+    return 1;
+}
+
+//GUARDA O PRIMEIRO CAMINHO QUE IMPEDIU O PACOTE, SE A CHAMADA PEDIU; RETORNA 0 PARA SER USADA COMO A FALHA
+static int registrarFalhaPacote(const OpcoesCompactacao *opcoes, const char *caminho, int codigo) {
+    FalhaPacote *falha = opcoes->falhaPacote;
+    if (falha && falha->caminho[0] == '\0') {
+        snprintf(falha->caminho, sizeof(falha->caminho), "%s", caminho);
+        falha->codigo = codigo;
+    }
+    return 0;
+}
+
+//PERCORRE O CAMINHO: ARQUIVOS COMUNS ENTRAM NA LISTA E DIRETÓRIOS SÃO PERCORRIDOS; LINKS SIMBÓLICOS,
+//DISPOSITIVOS E PIPES SÃO IGNORADOS
+static int coletarCaminhos(const char *caminho, ListaCaminhos *lista, const OpcoesCompactacao *opcoes) {
+    struct stat informacoes;
+    if (lstat(caminho, &informacoes) != 0) return registrarFalhaPacote(opcoes, caminho, errno);
+    if (S_ISREG(informacoes.st_mode)) return acrescentarCaminho(lista, caminho);
+    if (!S_ISDIR(informacoes.st_mode)) return 1;
+
+    DIR *diretorio = opendir(caminho);
+    if (!diretorio) return registrarFalhaPacote(opcoes, caminho, errno);
+    size_t tamanhoCaminho = strlen(caminho);
+    // Sem barra dupla quando o caminho já termina em '/'
+    const char *separador = tamanhoCaminho && caminho[tamanhoCaminho - 1] == '/' ? "" : "/";
+    int sucesso = 1;
+    struct dirent *item;
+    while (sucesso && (item = readdir(diretorio)) != NULL) {
+        if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0) continue;
+        char *filho = malloc(tamanhoCaminho + strlen(item->d_name) + 2);
+        sucesso = filho != NULL;
+        if (sucesso) {
+            sprintf(filho, "%s%s%s", caminho, separador, item->d_name);
+            sucesso = coletarCaminhos(filho, lista, opcoes);
+        }
+        free(filho);
+    }
+    closedir(diretorio);
+    return sucesso;
+}
+
+//NOME DE UM CAMINHO DENTRO DO PACOTE: SEM '/', './' E '../' NO INÍCIO, COMO FAZ O tar
+static const char *nomeNoPacote(const char *caminho) {
+    for (;;) {
+        if (caminho[0] == '/')
+            caminho++;
+        else if (strncmp(caminho, "./", 2) == 0)
+            caminho += 2;
+        else if (strncmp(caminho, "../", 3) == 0)
+            caminho += 3;
+        else
+            return caminho;
+    }
+}
+
+//UM NOME SÓ É EXTRAÍDO SE FICAR DENTRO DO DESTINO: RELATIVO, SEM COMPONENTES VAZIOS OU '..'
+static int nomeSeguro(const char *nome) {
+    const char *componente = nome;
+    for (;;) {
+        const char *barra = strchr(componente, '/');
+        size_t tamanho = barra ? (size_t)(barra - componente) : strlen(componente);
+        if (tamanho == 0 || (tamanho == 2 && componente[0] == '.' && componente[1] == '.')) return 0;
+        if (!barra) return 1;
+        componente = barra + 1;
+    }
+}
+
+//ORDENA AS TAREFAS PELO NOME NO PACOTE
+static int compararTarefasPacote(const void *a, const void *b) {
+    return strcmp(((const TarefaPacote *)a)->nome, ((const TarefaPacote *)b)->nome);
+}
+
+//TAREFA DE UMA THREAD: LÊ UM ARQUIVO PEQUENO INTEIRO E O COMPACTA NA MEMÓRIA
+static void executarCompactacaoEntrada(void *argumento) {
+    TarefaPacote *tarefa = argumento;
+    tarefa->sucesso = 0;
+    FILE *entrada = fopen(tarefa->caminho, "rb");
+    if (!entrada) {
+        tarefa->erro = errno;
+        return;
+    }
+
+    size_t tamanho = (size_t)tarefa->tamanhoOriginal, tamanhoCompactado = 0;
+    size_t limite = limiteCompactacao(tamanho, tarefa->opcoes);
+    uint8_t *dados = malloc(tamanho ? tamanho : 1);
+    tarefa->compactado = malloc(limite);
+    // O arquivo precisa ter o tamanho visto ao percorrer o diretório: um byte a mais indica que ele cresceu
+    int lido = dados && tarefa->compactado && fread(dados, 1, tamanho, entrada) == tamanho && fgetc(entrada) == EOF;
+    tarefa->erro = ferror(entrada) ? errno : 0;
+    fclose(entrada);
+    tarefa->sucesso = lido && compactarMemoria(dados, tamanho, tarefa->compactado, limite, &tamanhoCompactado,
+                                               tarefa->opcoes);
+    tarefa->tamanhoCompactado = tamanhoCompactado;
+    free(dados);
+}
+
+//COMPACTA UMA ENTRADA GRANDE DIRETO NO PACOTE, COM OS BLOCOS EM PARALELO
+static int gravarEntradaGrande(TarefaPacote *tarefa, FILE *pacote, const OpcoesCompactacao *opcoes) {
+    FILE *entrada = fopen(tarefa->caminho, "rb");
+    if (!entrada) return registrarFalhaPacote(opcoes, tarefa->caminho, errno);
+    OpcoesCompactacao opcoesEntrada = *opcoes;
+    EstatisticasCodec estatisticas;
+    opcoesEntrada.indice = 0;
+    opcoesEntrada.relatorio = NULL;
+    opcoesEntrada.estatisticas = &estatisticas;
+
+    off_t inicio = ftello(pacote);
+    int sucesso = inicio >= 0 && compactarFluxo(entrada, pacote, &opcoesEntrada);
+    if (!sucesso && ferror(entrada)) registrarFalhaPacote(opcoes, tarefa->caminho, errno);
+    fclose(entrada);
+    off_t fim = ftello(pacote);
+    tarefa->tamanhoOriginal = estatisticas.bytesEntrada;
+    tarefa->tamanhoCompactado = (uint64_t)(fim - inicio);
+    return sucesso && fim >= inicio;
+}
+
+//GRAVA O DIRETÓRIO CENTRAL E O RODAPÉ: QUANTIDADE DE ENTRADAS E, PARA CADA UMA, O NOME E OS TAMANHOS ORIGINAL E
+//COMPACTADO; AS POSIÇÕES SAEM DA SOMA DOS TAMANHOS COMPACTADOS, COMO NO ÍNDICE DOS BLOCOS
+static int escreverDiretorioPacote(FILE *pacote, const TarefaPacote *tarefas, size_t quantidade) {
+    EscritorBits escritor;
+    if (!inicializarEscritor(&escritor, pacote)) return 0;
+    uint64_t tamanhoDiretorio = (uint64_t)escreverVarint(&escritor, quantidade);
+    for (size_t i = 0; i < quantidade; i++) {
+        size_t tamanhoNome = strlen(tarefas[i].nome);
+        tamanhoDiretorio += (uint64_t)escreverVarint(&escritor, tamanhoNome) + tamanhoNome;
+        escreverBytesEscritor(&escritor, tarefas[i].nome, tamanhoNome);
+        tamanhoDiretorio += (uint64_t)escreverVarint(&escritor, tarefas[i].tamanhoOriginal);
+        tamanhoDiretorio += (uint64_t)escreverVarint(&escritor, tarefas[i].tamanhoCompactado);
+    }
+    for (int deslocamento = 24; deslocamento >= 0; deslocamento -= 8)
+        escreverByteEscritor(&escritor, (uint8_t)(tamanhoDiretorio >> deslocamento));
+    escreverBytesEscritor(&escritor, ASSINATURA_PACOTE, 4);
+    finalizarEscritor(&escritor);
+    return tamanhoDiretorio <= UINT32_MAX;
+}
+
+//EMPACOTA ARQUIVOS E ÁRVORES DE DIRETÓRIOS; CADA ENTRADA É COMPACTADA NO FORMATO EM BLOCOS E PODE SER EXTRAÍDA
+//SOZINHA PELO DIRETÓRIO CENTRAL NO FIM DO PACOTE
+int criarPacote(const char *nomePacote, char *const caminhos[], int quantidade, const OpcoesCompactacao *opcoes) {
+    ListaCaminhos lista;
+    memset(&lista, 0, sizeof(lista));
+    int sucesso = 1;
+    if (opcoes->falhaPacote) memset(opcoes->falhaPacote, 0, sizeof(FalhaPacote));
+    for (int i = 0; sucesso && i < quantidade; i++)
+        sucesso = coletarCaminhos(caminhos[i], &lista, opcoes);
+
+    // As pequenas usam uma thread cada; as grandes, todas as threads nos seus blocos
+    OpcoesCompactacao opcoesEntrada = *opcoes;
+    opcoesEntrada.threads = 1;
+    opcoesEntrada.indice = 0;
+    opcoesEntrada.relatorio = NULL;
+    opcoesEntrada.estatisticas = NULL;
+    uint64_t limiteMemoria = (uint64_t)BLOCOS_ENTRADA_PACOTE * tamanhoBlocoOpcoes(opcoes);
+
+    TarefaPacote *tarefas = sucesso ? calloc(lista.quantidade ? lista.quantidade : 1, sizeof(TarefaPacote)) : NULL;
+    sucesso = tarefas != NULL;
+    for (size_t i = 0; sucesso && i < lista.quantidade; i++) {
+        struct stat informacoes;
+        tarefas[i].caminho = lista.caminhos[i];
+        tarefas[i].nome = nomeNoPacote(lista.caminhos[i]);
+        tarefas[i].opcoes = &opcoesEntrada;
+        if (stat(tarefas[i].caminho, &informacoes) != 0)
+            sucesso = registrarFalhaPacote(opcoes, tarefas[i].caminho, errno);
+        else if (!nomeSeguro(tarefas[i].nome) || strlen(tarefas[i].nome) > TAMANHO_MAXIMO_NOME_PACOTE)
+            sucesso = registrarFalhaPacote(opcoes, tarefas[i].caminho, 0);
+        if (sucesso) {
+            tarefas[i].tamanhoOriginal = (uint64_t)informacoes.st_size;
+            tarefas[i].dispositivo = informacoes.st_dev;
+            tarefas[i].inode = informacoes.st_ino;
+            tarefas[i].grande = tarefas[i].tamanhoOriginal > limiteMemoria;
+        }
+    }
+
+    FILE *pacote = sucesso ? fopen(nomePacote, "wb") : NULL;
+    struct stat informacoesPacote;
+    sucesso = pacote && fstat(fileno(pacote), &informacoesPacote) == 0 && fwrite(ASSINATURA_PACOTE, 1, 4, pacote) == 4;
+
+    // Em ordem de nome, sem repetidos, que vêm de caminhos pedidos que se sobrepõem, e sem o próprio pacote
+    size_t total = 0;
+    if (sucesso) {
+        qsort(tarefas, lista.quantidade, sizeof(TarefaPacote), compararTarefasPacote);
+        for (size_t i = 0; i < lista.quantidade; i++) {
+            int repetido = total > 0 && strcmp(tarefas[total - 1].nome, tarefas[i].nome) == 0;
+            int proprioPacote = tarefas[i].dispositivo == informacoesPacote.st_dev &&
+                                tarefas[i].inode == informacoesPacote.st_ino;
+            if (!repetido && !proprioPacote) tarefas[total++] = tarefas[i];
+        }
+    }
+
+    int threads = opcoes->threads > 0 ? opcoes->threads : threadsDisponiveis();
+    GrupoThreads *grupo = sucesso ? criarGrupoThreads(threads) : NULL;
+    sucesso = grupo != NULL;
+
+    // Lotes de duas entradas por thread: enquanto um lote é gravado em ordem, nenhum outro ocupa memória
+    size_t lote = 2 * (size_t)threads;
+    for (size_t inicio = 0; sucesso && inicio < total; inicio += lote) {
+        size_t fim = inicio + lote < total ? inicio + lote : total;
+        for (size_t i = inicio; i < fim; i++)
+            if (!tarefas[i].grande) enviarTarefa(grupo, executarCompactacaoEntrada, &tarefas[i]);
+        aguardarTarefas(grupo);
+        for (size_t i = inicio; i < fim; i++) {
+            if (sucesso && tarefas[i].grande)
+                sucesso = gravarEntradaGrande(&tarefas[i], pacote, opcoes);
+            else if (sucesso && !tarefas[i].sucesso)
+                sucesso = registrarFalhaPacote(opcoes, tarefas[i].caminho, tarefas[i].erro);
+            else if (sucesso)
+                sucesso = fwrite(tarefas[i].compactado, 1, (size_t)tarefas[i].tamanhoCompactado, pacote) ==
+                          tarefas[i].tamanhoCompactado;
+            free(tarefas[i].compactado);
+            tarefas[i].compactado = NULL;
+        }
+    }
+    if (grupo) destruirGrupoThreads(grupo);
+
+    sucesso = sucesso && escreverDiretorioPacote(pacote, tarefas, total);
+    if (pacote) {
+        sucesso = fclose(pacote) == 0 && sucesso;
+        // Um pacote incompleto não pode ficar para trás
+        if (!sucesso) remove(nomePacote);
+    }
+
+    for (size_t i = 0; i < lista.quantidade; i++)
+        free(lista.caminhos[i]);
+    free(lista.caminhos);
+    free(tarefas);
+    return sucesso;
+}
+
+//LÊ O DIRETÓRIO CENTRAL PELO RODAPÉ; RETORNA 0 SE O ARQUIVO NÃO FOR UM PACOTE VÁLIDO
+int lerDiretorioPacote(FILE *pacote, DiretorioPacote *diretorio) {
+    uint8_t assinatura[4], rodape[TAMANHO_RODAPE_PACOTE];
+    memset(diretorio, 0, sizeof(DiretorioPacote));
+    if (fseeko(pacote, 0, SEEK_SET) != 0 || fread(assinatura, 1, 4, pacote) != 4 ||
+        memcmp(assinatura, ASSINATURA_PACOTE, 4) != 0 || fseeko(pacote, -TAMANHO_RODAPE_PACOTE, SEEK_END) != 0 ||
+        fread(rodape, 1, TAMANHO_RODAPE_PACOTE, pacote) != TAMANHO_RODAPE_PACOTE ||
+        memcmp(rodape + 4, ASSINATURA_PACOTE, 4) != 0)
+        return 0;
+    uint64_t tamanhoPacote = (uint64_t)ftello(pacote);
+    uint32_t tamanhoDiretorio = (uint32_t)rodape[0] << 24 | (uint32_t)rodape[1] << 16 | (uint32_t)rodape[2] << 8 |
+                                rodape[3];
+    if ((uint64_t)tamanhoDiretorio + TAMANHO_RODAPE_PACOTE + 4 > tamanhoPacote) return 0;
+
+    uint8_t *bytes = malloc(tamanhoDiretorio ? tamanhoDiretorio : 1);
+    if (!bytes) return 0;
+    if (fseeko(pacote, (off_t)(tamanhoPacote - TAMANHO_RODAPE_PACOTE - tamanhoDiretorio), SEEK_SET) != 0 ||
+        fread(bytes, 1, tamanhoDiretorio, pacote) != tamanhoDiretorio) {
+        free(bytes);
+        return 0;
+    }
+
+    LeitorBits leitor;
+    uint64_t quantidade, posicao = 4;
+    inicializarLeitorMemoria(&leitor, bytes, tamanhoDiretorio);
+    int sucesso = lerVarint(&leitor, &quantidade) && quantidade <= tamanhoDiretorio;
+    if (sucesso) {
+        diretorio->entradas = calloc(quantidade ? (size_t)quantidade : 1, sizeof(EntradaPacote));
+        sucesso = diretorio->entradas != NULL;
+    }
+    for (uint64_t i = 0; sucesso && i < quantidade; i++) {
+        EntradaPacote *entrada = &diretorio->entradas[i];
+        uint64_t tamanhoNome;
+        sucesso = lerVarint(&leitor, &tamanhoNome) && tamanhoNome > 0 && tamanhoNome <= TAMANHO_MAXIMO_NOME_PACOTE &&
+                  (entrada->nome = malloc((size_t)tamanhoNome + 1)) != NULL;
+        if (!sucesso) break;
+        diretorio->quantidade++;
+        sucesso = lerBytesLeitor(&leitor, entrada->nome, (size_t)tamanhoNome) == tamanhoNome &&
+                  memchr(entrada->nome, '\0', (size_t)tamanhoNome) == NULL &&
+                  lerVarint(&leitor, &entrada->tamanhoOriginal) && lerVarint(&leitor, &entrada->tamanhoCompactado) &&
+                  entrada->tamanhoCompactado <= tamanhoPacote - posicao;
+        entrada->nome[tamanhoNome] = '\0';
+        entrada->posicao = posicao;
+        posicao += entrada->tamanhoCompactado;
+        // Nomes em ordem estrita permitem a busca binária e descartam repetidos
+        if (sucesso && i > 0) sucesso = strcmp(diretorio->entradas[i - 1].nome, entrada->nome) < 0;
+    }
+    liberarLeitor(&leitor);
+    free(bytes);
+
+    // Assinatura, entradas, diretório e rodapé precisam ocupar exatamente o arquivo
+    sucesso = sucesso && posicao + tamanhoDiretorio + TAMANHO_RODAPE_PACOTE == tamanhoPacote;
+    if (!sucesso) liberarDiretorioPacote(diretorio);
+    return sucesso;
+}
+
+//LIBERA OS NOMES E AS ENTRADAS DO DIRETÓRIO
+void liberarDiretorioPacote(DiretorioPacote *diretorio) {
+    for (size_t i = 0; i < diretorio->quantidade; i++)
+        free(diretorio->entradas[i].nome);
+    free(diretorio->entradas);
+    memset(diretorio, 0, sizeof(DiretorioPacote));
+}
+
+//BUSCA BINÁRIA POR NOME; RETORNA NULL SE A ENTRADA NÃO ESTIVER NO PACOTE
+const EntradaPacote *buscarEntradaPacote(const DiretorioPacote *diretorio, const char *nome) {
+    size_t inicio = 0, fim = diretorio->quantidade;
+    while (inicio < fim) {
+        size_t meio = (inicio + fim) / 2;
+        int comparacao = strcmp(diretorio->entradas[meio].nome, nome);
+        if (comparacao == 0) return &diretorio->entradas[meio];
+        if (comparacao < 0)
+            inicio = meio + 1;
+        else
+            fim = meio;
+    }
+    return NULL;
+}
+
+//EXTRAI UMA ENTRADA PULANDO DIRETO PARA A SUA POSIÇÃO; RETORNA 0 SE O TAMANHO NÃO BATER COM O DO DIRETÓRIO
+int extrairEntradaPacote(FILE *pacote, const EntradaPacote *entrada, FILE *saida, const OpcoesCompactacao *opcoes) {
+    OpcoesCompactacao opcoesEntrada = *opcoes;
+    EstatisticasCodec estatisticas;
+    if (!opcoesEntrada.estatisticas) opcoesEntrada.estatisticas = &estatisticas;
+    if (fseeko(pacote, (off_t)entrada->posicao, SEEK_SET) != 0) return 0;
+    return descompactarFluxo(pacote, saida, &opcoesEntrada) &&
+           opcoesEntrada.estatisticas->bytesSaida == entrada->tamanhoOriginal;
+}
+
+// Uma entrada a extrair; as pequenas são lidas com pread e descompactadas na memória por uma thread do grupo
+typedef struct {
+    const EntradaPacote *entrada;
+    char *caminho;              // Nome da entrada dentro do destino
+    int grande;                 // Extraída pela thread que chama, com os blocos em paralelo
+    int descritor;
+    const OpcoesCompactacao *opcoes;
+    int sucesso;
+} TarefaExtracao;
+
+//JUNTA O DESTINO E O NOME DA ENTRADA; SEM DESTINO, O NOME FICA RELATIVO AO DIRETÓRIO ATUAL
+static char *caminhoNoDestino(const char *destino, const char *nome) {
+    if (!destino || !destino[0]) return strdup(nome);
+    char *caminho = malloc(strlen(destino) + strlen(nome) + 2);
+    if (caminho) sprintf(caminho, "%s/%s", destino, nome);
+    return caminho;
+}
+
+//CRIA OS DIRETÓRIOS QUE FALTAM ATÉ O ARQUIVO DO CAMINHO, COMO mkdir -p
+static int criarDiretoriosPais(const char *caminho) {
+    char *copia = strdup(caminho);
+    if (!copia) return 0;
+    int sucesso = 1;
+    for (char *barra = strchr(copia + 1, '/'); sucesso && barra; barra = strchr(barra + 1, '/')) {
+        *barra = '\0';
+        sucesso = mkdir(copia, 0777) == 0 || errno == EEXIST;
+        *barra = '/';
+    }
+    free(copia);
+    return sucesso;
+}
+
+//LÊ 'tamanho' BYTES DO DESCRITOR A PARTIR DE 'posicao' SEM MOVER A POSIÇÃO DO ARQUIVO
+static int lerTrechoDescritor(int descritor, uint8_t *destino, size_t tamanho, uint64_t posicao) {
+    size_t lidos = 0;
+    while (lidos < tamanho) {
+        ssize_t resultado = pread(descritor, destino + lidos, tamanho - lidos, (off_t)(posicao + lidos));
+        if (resultado < 0 && errno == EINTR) continue;
+        if (resultado <= 0) return 0;
+        lidos += (size_t)resultado;
+    }
+    return 1;
+}
+
+//TAREFA DE UMA THREAD: DESCOMPACTA UMA ENTRADA PEQUENA NA MEMÓRIA E GRAVA O ARQUIVO
+static void executarExtracaoEntrada(void *argumento) {
+    TarefaExtracao *tarefa = argumento;
+    const EntradaPacote *entrada = tarefa->entrada;
+    size_t tamanhoCompactado = (size_t)entrada->tamanhoCompactado, tamanhoSaida = 0;
+    uint8_t *compactado = malloc(tamanhoCompactado ? tamanhoCompactado : 1), *dados = NULL;
+    uint64_t tamanhoOriginal;
+    // O tamanho declarado pelos blocos precisa bater com o do diretório antes de qualquer alocação
+    int sucesso = compactado && lerTrechoDescritor(tarefa->descritor, compactado, tamanhoCompactado, entrada->posicao) &&
+                  tamanhoDescompactadoMemoria(compactado, tamanhoCompactado, &tamanhoOriginal) &&
+                  tamanhoOriginal == entrada->tamanhoOriginal &&
+                  (dados = malloc(tamanhoOriginal ? (size_t)tamanhoOriginal : 1)) != NULL &&
+                  descompactarMemoria(compactado, tamanhoCompactado, dados, (size_t)tamanhoOriginal, &tamanhoSaida,
+                                      tarefa->opcoes) &&
+                  criarDiretoriosPais(tarefa->caminho);
+    free(compactado);
+
+    FILE *saida = sucesso ? fopen(tarefa->caminho, "wb") : NULL;
+    sucesso = saida && fwrite(dados, 1, tamanhoSaida, saida) == tamanhoSaida;
+    if (saida) sucesso = fclose(saida) == 0 && sucesso;
+    free(dados);
+    tarefa->sucesso = sucesso;
+}
+
+//ORDENA AS TAREFAS NA ORDEM DAS ENTRADAS NO DIRETÓRIO, QUE É A DO PACOTE
+static int compararTarefasExtracao(const void *a, const void *b) {
+    const EntradaPacote *x = ((const TarefaExtracao *)a)->entrada, *y = ((const TarefaExtracao *)b)->entrada;
+    return x < y ? -1 : x > y;
+}
+
+//EXTRAI UMA ENTRADA GRANDE NA THREAD ATUAL, COM OS BLOCOS EM PARALELO
+static int extrairEntradaGrande(FILE *pacote, const TarefaExtracao *tarefa, const OpcoesCompactacao *opcoes) {
+    if (!criarDiretoriosPais(tarefa->caminho)) return 0;
+    FILE *saida = fopen(tarefa->caminho, "wb");
+    if (!saida) return 0;
+    int sucesso = extrairEntradaPacote(pacote, tarefa->entrada, saida, opcoes);
+    return fclose(saida) == 0 && sucesso;
+}
+
+//EXTRAI AS ENTRADAS PEDIDAS (OU TODAS, SEM NOMES) PARA DENTRO DO DESTINO; UM NOME AUSENTE DO PACOTE OU QUE
+//SAIRIA DO DESTINO É UM ERRO
+int extrairPacote(const char *nomePacote, const char *destino, char *const nomes[], int quantidade,
+                  const OpcoesCompactacao *opcoes) {
+    FILE *pacote = fopen(nomePacote, "rb");
+    if (!pacote) return 0;
+    DiretorioPacote diretorio;
+    if (!lerDiretorioPacote(pacote, &diretorio)) {
+        fclose(pacote);
+        return 0;
+    }
+
+    OpcoesCompactacao opcoesEntrada = *opcoes;
+    opcoesEntrada.threads = 1;
+    opcoesEntrada.estatisticas = NULL;
+    uint64_t limiteMemoria = (uint64_t)BLOCOS_ENTRADA_PACOTE * tamanhoBlocoOpcoes(opcoes);
+
+    size_t total = quantidade > 0 ? (size_t)quantidade : diretorio.quantidade;
+    TarefaExtracao *tarefas = calloc(total ? total : 1, sizeof(TarefaExtracao));
+    int sucesso = tarefas != NULL;
+    for (size_t i = 0; sucesso && i < total; i++) {
+        const EntradaPacote *entrada = quantidade > 0 ? buscarEntradaPacote(&diretorio, nomes[i])
+                                                      : &diretorio.entradas[i];
+        tarefas[i].entrada = entrada;
+        tarefas[i].descritor = fileno(pacote);
+        tarefas[i].opcoes = &opcoesEntrada;
+        tarefas[i].grande = entrada && (entrada->tamanhoOriginal > limiteMemoria ||
+                                        entrada->tamanhoCompactado > limiteCompactacao((size_t)limiteMemoria, opcoes));
+        sucesso = entrada && nomeSeguro(entrada->nome) &&
+                  (tarefas[i].caminho = caminhoNoDestino(destino, entrada->nome)) != NULL;
+    }
+
+    // Um nome pedido duas vezes seria gravado por duas threads ao mesmo tempo
+    size_t distintas = 0;
+    if (sucesso) {
+        qsort(tarefas, total, sizeof(TarefaExtracao), compararTarefasExtracao);
+        for (size_t i = 0; i < total; i++) {
+            if (distintas > 0 && tarefas[distintas - 1].entrada == tarefas[i].entrada)
+                free(tarefas[i].caminho);
+            else
+                tarefas[distintas++] = tarefas[i];
+        }
+        total = distintas;
+    }
+
+    int threads = opcoes->threads > 0 ? opcoes->threads : threadsDisponiveis();
+    GrupoThreads *grupo = sucesso ? criarGrupoThreads(threads) : NULL;
+    sucesso = grupo != NULL;
+
+    // As threads só usam pread; o FILE do pacote fica com as entradas grandes, depois de cada lote
+    size_t lote = 2 * (size_t)threads;
+    for (size_t inicio = 0; sucesso && inicio < total; inicio += lote) {
+        size_t fim = inicio + lote < total ? inicio + lote : total;
+        for (size_t i = inicio; i < fim; i++)
+            if (!tarefas[i].grande) enviarTarefa(grupo, executarExtracaoEntrada, &tarefas[i]);
+        aguardarTarefas(grupo);
+        for (size_t i = inicio; i < fim; i++) {
+            if (sucesso && tarefas[i].grande)
+                sucesso = extrairEntradaGrande(pacote, &tarefas[i], opcoes);
+            else
+                sucesso = sucesso && tarefas[i].sucesso;
+        }
+    }
+    if (grupo) destruirGrupoThreads(grupo);
+
+    for (size_t i = 0; tarefas && i < total; i++)
+        free(tarefas[i].caminho);
+    free(tarefas);
+    liberarDiretorioPacote(&diretorio);
+    fclose(pacote);
+    return sucesso;
+}
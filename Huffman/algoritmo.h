@@ -5,13 +5,60 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <pthread.h>
 
 #define TAMANHO_TABELA 256
 #define TAMANHO_BUFFER 4096
+#define TAMANHO_BUFFER_GRANDE (1 << 20)
+#define BITS_TABELA 11
+#define COMPRIMENTO_MAXIMO_CODIGO 64
+#define COMPRIMENTO_PADRAO 15
+#define TAMANHO_BLOCO_PADRAO (1 << 20)
+#define TAMANHO_BLOCO_MAXIMO (64 << 20)     // Maior bloco aceito na leitura, para não alocar tamanhos corrompidos
+#define MARGEM_CABECALHO_BLOCO 21           // Tipo e dois varints de até 10 bytes
+#define TAMANHO_MINIMO_QUATRO_FLUXOS 4096   // Abaixo disso os três tamanhos extras não compensam
+#define TANS_BITS_TABELA 11                 // Tabela de 2^11 estados do tANS, reduzida em blocos pequenos
+#define TANS_BITS_MINIMO 5
+#define TANS_BITS_MAXIMO 12
+#define MARGEM_TABELA_TANS 546              // Dois bytes, mapa de 32 bytes e 256 varints de até 2 bytes
+#define MAXIMO_TABELAS_CONTEXTO 8           // Grupos de contextos com tabela própria na ordem 1
+#define RODADAS_AGRUPAMENTO 6               // Rodadas de k-médias para agrupar os contextos
+#define TAMANHO_MINIMO_ORDEM1 4096          // Abaixo disso as tabelas extras não compensam
+
+// Primeiro byte dos formatos novos; no formato original ele exigiria uma árvore com mais de 7936 bytes
+#define MARCADOR_FORMATO 0xFF
+
+// Modos de gravação da tabela de tamanhos dos códigos canônicos
+#define TABELA_COMPLETA 0       // 256 bytes, um tamanho por símbolo
+#define TABELA_EM_CORRIDAS 1    // Pares (tamanho, repetições - 1)
+#define TABELA_ESPARSA 2        // Quantidade - 1, símbolos usados e tamanhos em meio byte
+#define TABELA_COMPACTA 3       // 256 tamanhos em meio byte
+
+// Tipos de bloco do formato em blocos
+#define BLOCO_FIM 0             // Marca o fim dos blocos
+#define BLOCO_HUFFMAN 1         // Tabela de tamanhos canônicos seguida dos bits
+#define BLOCO_CRU 2             // Bytes originais, quando a codificação não compensa
+#define BLOCO_HUFFMAN_4 3       // Tabela, tamanhos de três sub-fluxos e quatro sub-fluxos intercalados
+#define BLOCO_TANS 4            // Estados normalizados do tANS seguidos dos bits de quatro estados intercalados
+#define BLOCO_ORDEM1 5          // Grupo de cada byte anterior, uma tabela por grupo e os bits
+
+// Rodapé opcional do formato em blocos: índice, tamanho do índice em 4 bytes e a assinatura
+#define ASSINATURA_INDICE "HIDX"
+#define TAMANHO_RODAPE_INDICE 8
+
+// Assinatura do arquivo de dicionário, seguida da tabela de tamanhos
+#define ASSINATURA_DICIONARIO "HDIC"
+
+// Pacote de vários arquivos: assinatura, entradas no formato em blocos, diretório central e rodapé com o tamanho
+// do diretório em 4 bytes e a assinatura
+#define ASSINATURA_PACOTE "HPAK"
+#define TAMANHO_RODAPE_PACOTE 8
+#define TAMANHO_MAXIMO_NOME_PACOTE 4096
+#define BLOCOS_ENTRADA_PACOTE 4     // Entradas maiores não passam pela memória: vão em blocos paralelos
 
 typedef struct No {
     unsigned char simbolo;
-    unsigned int frequencia;
+    uint64_t frequencia;
     struct No *esquerda, *direita, *proximo;
 } No;
 
@@ -20,6 +67,12 @@ typedef struct {
     int tamanho;
 } ListaPrioridade;
 
+// Todos os nós de uma árvore em um único bloco: 256 folhas e 255 nós internos no máximo
+typedef struct {
+    No nos[2 * TAMANHO_TABELA - 1];
+    int usados;
+} ArenaNos;
+
 typedef struct {
     FILE *arquivo;
     uint8_t buffer;
@@ -27,6 +80,209 @@ typedef struct {
     int totalBits;
 } ControladorBits;
 
+typedef struct {
+    uint64_t bits;
+    uint8_t tamanho;
+} CodigoHuffman;
+
+// Sem arquivo, o escritor grava apenas na memória recebida e marca 'estouro' se ela não bastar
+typedef struct {
+    FILE *arquivo;
+    uint8_t *buffer;
+    size_t capacidade;
+    size_t posicao;
+    uint64_t acumulador;
+    int bitsNoAcumulador;
+    uint64_t totalBits;
+    int bufferProprio;
+    int estouro;
+} EscritorBits;
+
+// Entrada da tabela de decodificação: bits == 0 indica código maior que BITS_TABELA
+typedef struct {
+    uint8_t simbolo;
+    uint8_t bits;
+} EntradaDecodificacao;
+
+// Entrada que resolve até dois símbolos curtos com uma única consulta
+typedef struct {
+    uint8_t simbolos[2];
+    uint8_t quantidade;
+    uint8_t bits;
+} EntradaDupla;
+
+// Tabelas de decodificação para qualquer código de prefixo; códigos longos ficam ordenados por tamanho
+typedef struct {
+    EntradaDecodificacao tabela[1 << BITS_TABELA];
+    EntradaDupla dupla[1 << BITS_TABELA];
+    uint64_t codigosLongos[TAMANHO_TABELA];
+    uint8_t simbolosLongos[TAMANHO_TABELA];
+    uint16_t inicioComprimento[COMPRIMENTO_MAXIMO_CODIGO + 2];
+    int comprimentoMaximo;
+} Decodificador;
+
+// Tabela de códigos treinada com amostras: as mensagens compactadas com ela não levam árvore nem tabela
+typedef struct {
+    uint8_t comprimentos[TAMANHO_TABELA];
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    EntradaDecodificacao tabela[1 << BITS_TABELA];
+} Dicionario;
+
+// Sem arquivo, o leitor percorre apenas os dados em memória recebidos
+typedef struct {
+    FILE *arquivo;
+    uint8_t *buffer;
+    size_t tamanho;
+    size_t posicao;
+    uint64_t acumulador;
+    int bitsNoAcumulador;
+    int fimArquivo;
+    int bufferProprio;
+} LeitorBits;
+
+typedef enum {
+    FORMATO_ARVORE = 1,     // Formato original: árvore em pré-ordem e bits de lixo no cabeçalho
+    FORMATO_CANONICO = 2,   // Tabela com o tamanho de cada código canônico
+    FORMATO_BLOCOS = 3      // Blocos independentes, cada um com sua tabela, processados em paralelo
+} FormatoArquivo;
+
+// Codificador de entropia dos blocos; no automático cada bloco usa o que ficar menor
+typedef enum {
+    CODIFICADOR_AUTOMATICO = 0,
+    CODIFICADOR_HUFFMAN = 1,
+    CODIFICADOR_TANS = 2
+} CodificadorEntropia;
+
+// Etapas medidas pela instrumentação
+typedef enum {
+    FASE_LEITURA,           // Leitura dos blocos da entrada
+    FASE_HISTOGRAMA,        // Contagem das frequências
+    FASE_ARVORE,            // Árvore ou tamanhos dos códigos
+    FASE_CODIGOS,           // Geração dos códigos a partir da árvore ou dos tamanhos
+    FASE_CABECALHO,         // Árvore ou tabela gravada na compactação, lida na descompactação
+    FASE_CODIFICACAO,
+    FASE_DECODIFICACAO,
+    FASE_GRAVACAO,          // Gravação e descarga da saída
+    TOTAL_FASES
+} FaseCodec;
+
+// Preenchido pela compactação quando solicitado: o custo do limite é bitsCodificados / bitsSemLimite - 1
+typedef struct {
+    uint64_t bitsSemLimite;
+    uint64_t bitsCodificados;
+    int comprimentoMaximo;
+    uint64_t blocosTans;                // Blocos em que o tANS ficou menor que o Huffman
+    uint64_t blocosOrdem1;              // Blocos codificados com tabelas escolhidas pelo byte anterior
+    double bitsEntropia;                // Entropia de ordem 0 do bloco, só com estatísticas
+    double segundosFase[TOTAL_FASES];   // Somados pelo bloco, só com estatísticas
+} RelatorioCompactacao;
+
+// Preenchido pela compactação e pela descompactação quando solicitado; sem ele nenhuma etapa lê o relógio.
+// As fases somam o tempo de todas as threads e podem passar de 'segundos', que é o tempo decorrido
+typedef struct {
+    double segundos;
+    double segundosFase[TOTAL_FASES];
+    uint64_t bytesEntrada;
+    uint64_t bytesSaida;
+    uint64_t simbolos;                  // Bytes contados nos histogramas (só na compactação)
+    uint64_t bitsCodificados;           // Bits que os códigos de Huffman dão a esses bytes, sem tabelas
+    double bitsEntropia;                // Limite de ordem 0 para os mesmos bytes
+    int profundidadeMaxima;             // Maior código usado
+} EstatisticasCodec;
+
+// Preenchido pelo modo em pipeline quando solicitado; as filas são medidas a cada bloco gravado
+typedef struct {
+    uint64_t blocos;
+    uint64_t esperasLeitura;            // Blocos cuja leitura esperou espaço livre na fila
+    uint64_t esperasGravacao;           // Blocos cuja gravação esperou o processamento terminar
+    int capacidadeFila;
+    int maximoFilaProcessamento;        // Blocos lidos e ainda não processados
+    int maximoFilaGravacao;             // Blocos processados e ainda não gravados
+    double mediaFilaProcessamento;
+    double mediaFilaGravacao;
+} EstatisticasPipeline;
+
+// Preenchido por criarPacote quando solicitado: o primeiro caminho que impediu o pacote e o errno da falha
+// ('codigo' é 0 quando o caminho foi recusado sem erro do sistema)
+typedef struct {
+    char caminho[TAMANHO_MAXIMO_NOME_PACOTE + 1];
+    int codigo;
+} FalhaPacote;
+
+typedef struct {
+    FormatoArquivo formato;
+    int comprimentoMaximo;              // Limite dos códigos canônicos (0 = sem limite); o formato original não é limitado
+    RelatorioCompactacao *relatorio;    // Opcional
+    size_t tamanhoBloco;                // Bytes por bloco no formato em blocos
+    int threads;                        // Threads do formato em blocos (0 = uma por processador)
+    int indice;                         // Grava no fim do arquivo o índice dos blocos, para acesso aleatório
+    int mapearEntrada;                  // Lê a entrada por mmap quando ela é um arquivo comum
+    int quatroFluxos;                   // Divide cada bloco em quatro sub-fluxos decodificados juntos
+    int pipeline;                       // Lê, processa e grava os blocos em estágios simultâneos, sem mmap
+    CodificadorEntropia codificador;    // Codificador dos blocos no formato em blocos
+    int ordem1;                         // Tenta também tabelas escolhidas pelo byte anterior em cada bloco
+    EstatisticasPipeline *estatisticasPipeline;     // Opcional
+    EstatisticasCodec *estatisticas;                // Opcional
+    FalhaPacote *falhaPacote;                       // Opcional
+} OpcoesCompactacao;
+
+// Arquivo inteiro mapeado na memória; 'dados' começa na posição em que o arquivo estava ao ser mapeado
+typedef struct {
+    const uint8_t *dados;
+    size_t tamanho;
+    void *base;
+    size_t tamanhoMapeado;
+} MapeamentoArquivo;
+
+// Início de um bloco no arquivo compactado e nos dados originais
+typedef struct {
+    uint64_t posicaoCompactada;
+    uint64_t posicaoOriginal;
+} EntradaIndice;
+
+// Uma entrada por bloco e mais uma marcando onde os blocos terminam
+typedef struct {
+    EntradaIndice *entradas;
+    size_t quantidadeBlocos;
+    size_t capacidade;
+} IndiceBlocos;
+
+// Um arquivo do pacote: 'posicao' é onde o seu fluxo no formato em blocos começa
+typedef struct {
+    char *nome;
+    uint64_t tamanhoOriginal;
+    uint64_t tamanhoCompactado;
+    uint64_t posicao;
+} EntradaPacote;
+
+// Diretório central do pacote, com as entradas em ordem de nome
+typedef struct {
+    EntradaPacote *entradas;
+    size_t quantidade;
+} DiretorioPacote;
+
+typedef void (*FuncaoTarefa)(void *argumento);
+
+typedef struct {
+    FuncaoTarefa funcao;
+    void *argumento;
+} Tarefa;
+
+// Fila circular de tarefas atendida por um conjunto fixo de threads
+typedef struct {
+    pthread_t *threads;
+    int quantidadeThreads;          // 0: as tarefas rodam na própria chamada de enviarTarefa
+    Tarefa *fila;
+    int capacidadeFila;
+    int inicioFila;
+    int tamanhoFila;
+    int pendentes;                  // Enviadas e ainda não concluídas
+    int encerrar;
+    pthread_mutex_t trava;
+    pthread_cond_t temTarefa;
+    pthread_cond_t concluidas;
+} GrupoThreads;
+
 // ----------------------------------------------------
 // Funções para gerenciamento da lista de prioridade
 // ----------------------------------------------------
@@ -34,16 +290,34 @@ typedef struct {
 void inicializarLista(ListaPrioridade *lista);
 void inserirOrdenado(No *no, ListaPrioridade *lista);
 No *removerPrimeiro(ListaPrioridade *lista);
-void contarFrequencias(const char *nomeArquivo, unsigned int frequencias[]);
+void contarFrequencias(const char *nomeArquivo, uint64_t frequencias[]);
+void acumularFrequencias(const uint8_t *dados, size_t tamanho, uint64_t frequencias[]);
 
 // ----------------------------------------------------
 // Funções para construção da árvore de Huffman
 // ----------------------------------------------------
 
-No *criarFolha(unsigned char simbolo, unsigned int frequencia);
+ArenaNos *criarArena(void);
+No *alocarNo(ArenaNos *arena);
+void liberarArena(ArenaNos *arena);
+No *criarFolha(unsigned char simbolo, uint64_t frequencia);
 No *criarNoInterno(No *esquerdo, No *direito);
-No *construirArvoreHuffman(unsigned int frequencias[]);
+No *construirArvoreHuffman(const uint64_t frequencias[], ArenaNos *arena);
 void gerarCodigos(No *no, char caminho[], int posicao, char tabelaCodigos[TAMANHO_TABELA][TAMANHO_TABELA]);
+int gerarCodigosInteiros(No *raiz, CodigoHuffman codigos[TAMANHO_TABELA]);
+
+// ----------------------------------------------------
+// Funções para códigos canônicos
+// ----------------------------------------------------
+
+void calcularComprimentos(No *raiz, uint8_t comprimentos[TAMANHO_TABELA]);
+int calcularComprimentosLimitados(const uint64_t frequencias[], int limite, uint8_t comprimentos[TAMANHO_TABELA]);
+uint64_t contarBitsCodificados(const uint64_t frequencias[], const uint8_t comprimentos[TAMANHO_TABELA]);
+int gerarCodigosCanonicos(const uint8_t comprimentos[TAMANHO_TABELA], CodigoHuffman codigos[TAMANHO_TABELA]);
+int escreverVarint(EscritorBits *escritor, uint64_t valor);
+int lerVarint(LeitorBits *leitor, uint64_t *valor);
+int escreverComprimentos(const uint8_t comprimentos[TAMANHO_TABELA], EscritorBits *escritor);
+int lerComprimentos(LeitorBits *leitor, uint8_t comprimentos[TAMANHO_TABELA]);
 
 // ----------------------------------------------------
 // Funções para escrita de bits no arquivo
@@ -53,16 +327,125 @@ void inicializarControlador(ControladorBits *controlador, FILE *arquivo);
 void escreverBit(ControladorBits *controlador, int bit);
 void finalizarEscrita(ControladorBits *controlador);
 int escreverArvore(No *no, FILE *arquivo);
+int inicializarEscritor(EscritorBits *escritor, FILE *arquivo);
+int inicializarEscritorMemoria(EscritorBits *escritor, uint8_t *destino, size_t capacidade);
+void escreverCodigo(EscritorBits *escritor, uint64_t codigo, int tamanho);
+void alinharEscritor(EscritorBits *escritor);
+void escreverByteEscritor(EscritorBits *escritor, uint8_t byte);
+void escreverBytesEscritor(EscritorBits *escritor, const void *dados, size_t tamanho);
+void finalizarEscritor(EscritorBits *escritor);
+
+// ----------------------------------------------------
+// Funções para leitura de bits do arquivo
+// ----------------------------------------------------
+
+int inicializarLeitor(LeitorBits *leitor, FILE *arquivo);
+void inicializarLeitorMemoria(LeitorBits *leitor, const uint8_t *dados, size_t tamanho);
+void recarregarLeitor(LeitorBits *leitor);
+int lerByteLeitor(LeitorBits *leitor);
+size_t lerBytesLeitor(LeitorBits *leitor, void *destino, size_t tamanho);
+void liberarLeitor(LeitorBits *leitor);
+
+// ----------------------------------------------------
+// Funções para mapeamento do arquivo de entrada
+// ----------------------------------------------------
+
+int mapearArquivo(FILE *arquivo, MapeamentoArquivo *mapeamento);
+void desmapearArquivo(MapeamentoArquivo *mapeamento);
+
+// ----------------------------------------------------
+// Funções para o grupo de threads
+// ----------------------------------------------------
+
+int threadsDisponiveis(void);
+GrupoThreads *criarGrupoThreads(int quantidade);
+void enviarTarefa(GrupoThreads *grupo, FuncaoTarefa funcao, void *argumento);
+void aguardarTarefas(GrupoThreads *grupo);
+void destruirGrupoThreads(GrupoThreads *grupo);
+
+// ----------------------------------------------------
+// Funções para instrumentação
+// ----------------------------------------------------
+
+void escreverEstatisticasJson(FILE *saida, const char *operacao, const char *nome,
+                              const EstatisticasCodec *estatisticas);
+
+// ----------------------------------------------------
+// Funções para o formato em blocos
+// ----------------------------------------------------
+
+int compactarBloco(const uint8_t *dados, size_t tamanho, const OpcoesCompactacao *opcoes, EscritorBits *saida,
+                   RelatorioCompactacao *relatorio);
+int descompactarBloco(int tipo, const uint8_t *corpo, size_t tamanhoCorpo, uint8_t *destino, size_t tamanhoOriginal);
 
 // ----------------------------------------------------
 // Funções principais de compactação e descompactação
 // ----------------------------------------------------
 
+void opcoesPadrao(OpcoesCompactacao *opcoes);
+int compactarFluxo(FILE *entrada, FILE *saida, const OpcoesCompactacao *opcoes);
+int compactarHuffmanComOpcoes(const char *nomeEntrada, const char *nomeSaida, const OpcoesCompactacao *opcoes);
 void compactarHuffman(const char *nomeEntrada, const char *nomeSaida);
 void lerCabecalho(FILE *arquivo, int *bitsLixo, int *tamanhoArvore);
-No *lerNo(FILE *arquivo);
-void decodificarBits(FILE *entrada, FILE *saida, No *raiz, int bitsLixo);
+No *lerNo(FILE *arquivo, ArenaNos *arena);
+void construirTabelaDecodificacao(No *raiz, EntradaDecodificacao tabela[1 << BITS_TABELA]);
+void construirDecodificador(const CodigoHuffman codigos[TAMANHO_TABELA], Decodificador *decodificador);
+uint64_t decodificarParaMemoria(const Decodificador *decodificador, LeitorBits *leitor, int bitsLixo, uint8_t *destino,
+                                uint64_t limite);
+uint64_t decodificarSimbolos(const Decodificador *decodificador, LeitorBits *leitor, FILE *saida, int bitsLixo, uint64_t limite);
+uint64_t decodificarBits(FILE *entrada, FILE *saida, No *raiz, int bitsLixo);
+int descompactarFluxo(FILE *entrada, FILE *saida, const OpcoesCompactacao *opcoes);
+int descompactarHuffmanComOpcoes(const char *nomeEntrada, const char *nomeSaida, const OpcoesCompactacao *opcoes);
 void descompactarHuffman(const char *nomeEntrada, const char *nomeSaida);
 void gerarNomeArquivoComExtensaoHuff(char *entrada, char *saida);
 
+// ----------------------------------------------------
+// Funções para compactação em memória
+// ----------------------------------------------------
+
+size_t limiteCompactacao(size_t tamanho, const OpcoesCompactacao *opcoes);
+int compactarMemoria(const void *entrada, size_t tamanhoEntrada, void *saida, size_t capacidadeSaida,
+                     size_t *tamanhoSaida, const OpcoesCompactacao *opcoes);
+int tamanhoDescompactadoMemoria(const void *entrada, size_t tamanhoEntrada, uint64_t *tamanhoOriginal);
+int descompactarMemoria(const void *entrada, size_t tamanhoEntrada, void *saida, size_t capacidadeSaida,
+                        size_t *tamanhoSaida, const OpcoesCompactacao *opcoes);
+
+// ----------------------------------------------------
+// Funções para dicionários de códigos
+// ----------------------------------------------------
+
+int construirDicionario(const uint64_t frequencias[TAMANHO_TABELA], Dicionario *dicionario);
+int prepararDicionario(Dicionario *dicionario);
+int treinarDicionario(char *const nomesAmostras[], int quantidade, Dicionario *dicionario);
+int salvarDicionario(const char *nomeArquivo, const Dicionario *dicionario);
+int carregarDicionario(const char *nomeArquivo, Dicionario *dicionario);
+size_t limiteMensagem(size_t tamanho);
+int compactarMensagem(const Dicionario *dicionario, const void *entrada, size_t tamanhoEntrada, void *saida,
+                      size_t capacidadeSaida, size_t *tamanhoSaida);
+int tamanhoMensagemDescompactada(const void *mensagem, size_t tamanhoMensagem, uint64_t *tamanhoOriginal);
+int descompactarMensagem(const Dicionario *dicionario, const void *mensagem, size_t tamanhoMensagem, void *saida,
+                         size_t capacidadeSaida, size_t *tamanhoSaida);
+
+// ----------------------------------------------------
+// Funções para acesso aleatório no formato em blocos
+// ----------------------------------------------------
+
+int lerIndiceBlocos(FILE *arquivo, IndiceBlocos *indice);
+void liberarIndiceBlocos(IndiceBlocos *indice);
+size_t descompactarIntervaloComIndice(FILE *entrada, const IndiceBlocos *indice, uint64_t inicio, size_t tamanho,
+                                      void *destino);
+size_t descompactarIntervalo(FILE *entrada, uint64_t inicio, size_t tamanho, void *destino);
+
+// ----------------------------------------------------
+// Funções para pacotes de arquivos
+// ----------------------------------------------------
+
+int criarPacote(const char *nomePacote, char *const caminhos[], int quantidade, const OpcoesCompactacao *opcoes);
+int lerDiretorioPacote(FILE *pacote, DiretorioPacote *diretorio);
+void liberarDiretorioPacote(DiretorioPacote *diretorio);
+const EntradaPacote *buscarEntradaPacote(const DiretorioPacote *diretorio, const char *nome);
+int extrairEntradaPacote(FILE *pacote, const EntradaPacote *entrada, FILE *saida, const OpcoesCompactacao *opcoes);
+int extrairPacote(const char *nomePacote, const char *destino, char *const nomes[], int quantidade,
+                  const OpcoesCompactacao *opcoes);
+
 #endif
\ No newline at end of file
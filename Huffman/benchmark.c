@@ -0,0 +1,426 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "algoritmo.h"
+
+// Mede a vazão da compactação e da descompactação em memória sobre corpora gerados sempre com os mesmos bytes,
+// mais os arquivos reais passados na linha de comando. Cada corpus roda em um processo próprio, para que o pico
+// de memória seja só dele. Compilação: gcc -O2 -pthread -o benchmark benchmark.c algoritmo.c
+
+#define SEMENTE_CORPORA 0x9E3779B97F4A7C15ull
+#define VOCABULARIO_ZIPF 8192
+#define TOLERANCIA_RAZAO 0.001          // A razão não depende da máquina: só o arredondamento é tolerado
+
+// Resultado de um corpus, enviado do processo filho ao pai
+typedef struct {
+    char nome[64];
+    uint64_t bytes;
+    uint64_t bytesCompactados;
+    double segundosCompactacao;         // Menores tempos das repetições
+    double segundosDescompactacao;
+    long picoRssKb;
+    int sucesso;
+} ResultadoCorpus;
+
+typedef void (*GeradorCorpus)(uint8_t *dados, size_t tamanho, uint64_t *estado);
+
+//PRÓXIMO VALOR DO GERADOR xorshift64*: RÁPIDO E IGUAL EM QUALQUER MÁQUINA
+static uint64_t proximoAleatorio(uint64_t *estado) {
+    *estado ^= *estado >> 12;
+    *estado ^= *estado << 25;
+    *estado ^= *estado >> 27;
+    return *estado * 0x2545F4914F6CDD1Dull;
+}
+
+//INTEIRO EM [0, limite)
+static uint32_t aleatorioAte(uint64_t *estado, uint32_t limite) {
+    return (uint32_t)((proximoAleatorio(estado) >> 32) * limite >> 32);
+}
+
+//BYTES UNIFORMES: O PIOR CASO, EM QUE TODO BLOCO DEVE SAIR CRU
+static void gerarAleatorio(uint8_t *dados, size_t tamanho, uint64_t *estado) {
+    for (size_t i = 0; i < tamanho; i++)
+        dados[i] = (uint8_t)(proximoAleatorio(estado) >> 56);
+}
+
+//TEXTO COM PALAVRAS SORTEADAS PELA LEI DE ZIPF: A PALAVRA DE POSIÇÃO k APARECE COM PESO 1 / k
+static void gerarZipf(uint8_t *dados, size_t tamanho, uint64_t *estado) {
+    static char palavras[VOCABULARIO_ZIPF][12];
+    static double acumulado[VOCABULARIO_ZIPF];
+    // Letras mais comuns primeiro, repetidas para imitar as frequências de um texto
+    static const char letras[] = "eeeeeaaaaoooossrriinnddmmuttccllppvvgghqbfzjxkwy";
+    double total = 0;
+    for (int k = 0; k < VOCABULARIO_ZIPF; k++) {
+        int tamanhoPalavra = 1 + (int)aleatorioAte(estado, 4) + (int)aleatorioAte(estado, 6) * (k > 64);
+        for (int j = 0; j < tamanhoPalavra; j++)
+            palavras[k][j] = letras[aleatorioAte(estado, sizeof(letras) - 1)];
+        palavras[k][tamanhoPalavra] = '\0';
+        total += 1.0 / (k + 1);
+        acumulado[k] = total;
+    }
+
+    size_t posicao = 0;
+    int naLinha = 0;
+    while (posicao < tamanho) {
+        double sorteio = (proximoAleatorio(estado) >> 11) * (1.0 / 9007199254740992.0) * total;
+        int inicio = 0, fim = VOCABULARIO_ZIPF - 1;
+        while (inicio < fim) {
+            int meio = (inicio + fim) / 2;
+            if (acumulado[meio] < sorteio) inicio = meio + 1;
+            else fim = meio;
+        }
+        for (const char *c = palavras[inicio]; *c && posicao < tamanho; c++)
+            dados[posicao++] = (uint8_t)*c;
+        if (posicao < tamanho && aleatorioAte(estado, 16) == 0) dados[posicao++] = ',';
+        if (posicao < tamanho) dados[posicao++] = ++naLinha % 12 == 0 ? '\n' : ' ';
+    }
+}
+
+//SEQUÊNCIAS LONGAS DE POUCOS VALORES, COMO EM BITMAPS E ARQUIVOS ESPARSOS
+static void gerarSequencias(uint8_t *dados, size_t tamanho, uint64_t *estado) {
+    static const uint8_t valores[] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0x20, 0x80};
+    size_t posicao = 0;
+    while (posicao < tamanho) {
+        uint8_t valor = aleatorioAte(estado, 32) == 0 ? (uint8_t)aleatorioAte(estado, 256)
+                                                     : valores[aleatorioAte(estado, sizeof(valores))];
+        size_t repeticoes = 16 + aleatorioAte(estado, 4096);
+        while (repeticoes-- > 0 && posicao < tamanho)
+            dados[posicao++] = valor;
+    }
+}
+
+// Instruções comuns de x86-64: bytes fixos seguidos de deslocamentos ou imediatos
+typedef struct {
+    uint8_t fixos[5];
+    uint8_t quantidadeFixos;
+    uint8_t quantidadeVariaveis;
+} ModeloInstrucao;
+
+//EXECUTÁVEL SINTÉTICO: SEÇÕES DE CÓDIGO, PONTEIROS, TABELAS DE NOMES E PREENCHIMENTO COM ZEROS
+static void gerarExecutavel(uint8_t *dados, size_t tamanho, uint64_t *estado) {
+    static const ModeloInstrucao instrucoes[] = {
+        {{0x48, 0x89, 0xC7}, 3, 0}, {{0x48, 0x8B, 0x45}, 3, 1}, {{0x48, 0x89, 0x45}, 3, 1}, {{0xE8}, 1, 4},
+        {{0x0F, 0x1F, 0x44, 0x00, 0x00}, 5, 0}, {{0xC3}, 1, 0}, {{0x55}, 1, 0}, {{0x5D}, 1, 0},
+        {{0x31, 0xC0}, 2, 0}, {{0x48, 0x83, 0xEC}, 3, 1}, {{0x48, 0x83, 0xC4}, 3, 1}, {{0x74}, 1, 1},
+        {{0x75}, 1, 1}, {{0xEB}, 1, 1}, {{0x89, 0xC6}, 2, 0}, {{0x8B, 0x45}, 2, 1}, {{0x48, 0x8D, 0x3D}, 3, 4},
+        {{0x41, 0x54}, 2, 0}, {{0x41, 0x5C}, 2, 0}, {{0x0F, 0x84}, 2, 4}, {{0x85, 0xC0}, 2, 0},
+        {{0x48, 0x85, 0xC0}, 3, 0}, {{0xBA}, 1, 4}, {{0xBE}, 1, 4}, {{0xBF}, 1, 4}, {{0x48, 0x8B, 0x05}, 3, 4},
+    };
+    static const char nomes[] = "abcdefghijklmnopqrstuvwxyz_";
+    size_t quantidadeInstrucoes = sizeof(instrucoes) / sizeof(instrucoes[0]);
+    size_t posicao = 0;
+    while (posicao < tamanho) {
+        uint32_t secao = aleatorioAte(estado, 20);
+        size_t fim = posicao + 256 + aleatorioAte(estado, 8192);
+        if (fim > tamanho) fim = tamanho;
+        if (secao < 12) {
+            while (posicao < fim) {
+                const ModeloInstrucao *modelo = &instrucoes[aleatorioAte(estado, (uint32_t)quantidadeInstrucoes)];
+                for (int j = 0; j < modelo->quantidadeFixos && posicao < fim; j++)
+                    dados[posicao++] = modelo->fixos[j];
+                // Deslocamentos pequenos, em complemento de dois: os bytes altos são quase sempre 00 ou FF
+                int32_t deslocamento = (int32_t)aleatorioAte(estado, 4096) - 2048;
+                for (int j = 0; j < modelo->quantidadeVariaveis && posicao < fim; j++)
+                    dados[posicao++] = (uint8_t)(deslocamento >> (8 * j));
+            }
+        } else if (secao < 15) {
+            uint64_t base = 0x401000 + aleatorioAte(estado, 0x10000);
+            while (posicao < fim) {
+                uint64_t ponteiro = base + 8 * aleatorioAte(estado, 512);
+                for (int j = 0; j < 8 && posicao < fim; j++)
+                    dados[posicao++] = (uint8_t)(ponteiro >> (8 * j));
+            }
+        } else if (secao < 18) {
+            while (posicao < fim) {
+                int tamanhoNome = 3 + (int)aleatorioAte(estado, 14);
+                for (int j = 0; j < tamanhoNome && posicao < fim; j++)
+                    dados[posicao++] = (uint8_t)nomes[aleatorioAte(estado, sizeof(nomes) - 1)];
+                if (posicao < fim) dados[posicao++] = 0;
+            }
+        } else {
+            memset(dados + posicao, 0, fim - posicao);
+            posicao = fim;
+        }
+    }
+}
+
+//UM ÚNICO SÍMBOLO REPETIDO: O CASO SEM BITS DE CÓDIGO
+static void gerarUnico(uint8_t *dados, size_t tamanho, uint64_t *estado) {
+    (void)estado;
+    memset(dados, 'A', tamanho);
+}
+
+//INSTANTE ATUAL EM SEGUNDOS
+static double agora(void) {
+    struct timespec instante;
+    clock_gettime(CLOCK_MONOTONIC, &instante);
+    return (double)instante.tv_sec + (double)instante.tv_nsec * 1e-9;
+}
+
+//COMPACTA E DESCOMPACTA O CORPUS 'repeticoes' VEZES DEPOIS DE UMA RODADA DE AQUECIMENTO, CONFERINDO OS BYTES.
+//FICA O MENOR TEMPO DE CADA OPERAÇÃO: O RUÍDO DE OUTROS PROCESSOS SÓ AUMENTA OS TEMPOS
+static int medirCorpus(const uint8_t *dados, size_t tamanho, int repeticoes, const OpcoesCompactacao *opcoes,
+                       ResultadoCorpus *resultado) {
+    size_t limite = limiteCompactacao(tamanho, opcoes), tamanhoCompactado = 0, tamanhoRestaurado = 0;
+    uint8_t *compactado = malloc(limite);
+    uint8_t *restaurado = malloc(tamanho ? tamanho : 1);
+    int sucesso = compactado && restaurado;
+    resultado->segundosCompactacao = resultado->segundosDescompactacao = 1e30;
+
+    for (int i = -1; sucesso && i < repeticoes; i++) {
+        double inicio = agora();
+        sucesso = compactarMemoria(dados, tamanho, compactado, limite, &tamanhoCompactado, opcoes);
+        double meio = agora();
+        sucesso = sucesso && descompactarMemoria(compactado, tamanhoCompactado, restaurado, tamanho,
+                                                 &tamanhoRestaurado, opcoes);
+        double fim = agora();
+        if (i < 0) {
+            sucesso = sucesso && tamanhoRestaurado == tamanho && memcmp(restaurado, dados, tamanho) == 0;
+            continue;
+        }
+        if (meio - inicio < resultado->segundosCompactacao) resultado->segundosCompactacao = meio - inicio;
+        if (fim - meio < resultado->segundosDescompactacao) resultado->segundosDescompactacao = fim - meio;
+    }
+    resultado->bytesCompactados = tamanhoCompactado;
+    free(compactado);
+    free(restaurado);
+    return sucesso;
+}
+
+//LÊ UM ARQUIVO REAL INTEIRO PARA A MEMÓRIA
+static uint8_t *lerArquivo(const char *nome, size_t *tamanho) {
+    FILE *arquivo = fopen(nome, "rb");
+    if (!arquivo) return NULL;
+    uint8_t *dados = NULL;
+    if (fseeko(arquivo, 0, SEEK_END) == 0) {
+        off_t fim = ftello(arquivo);
+        rewind(arquivo);
+        dados = fim >= 0 ? malloc(fim ? (size_t)fim : 1) : NULL;
+        *tamanho = fim >= 0 ? (size_t)fim : 0;
+        if (dados && fread(dados, 1, *tamanho, arquivo) != *tamanho) {
+            free(dados);
+            dados = NULL;
+        }
+    }
+    fclose(arquivo);
+    return dados;
+}
+
+//RODA UM CORPUS EM UM PROCESSO FILHO (GERADO OU, SEM GERADOR, LIDO DO ARQUIVO 'nome') E RECOLHE O PICO DE MEMÓRIA
+static int executarCorpus(const char *nome, GeradorCorpus gerador, size_t tamanho, int repeticoes,
+                          const OpcoesCompactacao *opcoes, ResultadoCorpus *resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    const char *base = strrchr(nome, '/');
+    snprintf(resultado->nome, sizeof(resultado->nome), "%s", base ? base + 1 : nome);
+
+    int canal[2];
+    if (pipe(canal) != 0) return 0;
+    fflush(NULL);
+    pid_t filho = fork();
+    if (filho < 0) {
+        close(canal[0]);
+        close(canal[1]);
+        return 0;
+    }
+    if (filho == 0) {
+        close(canal[0]);
+        uint64_t estado = SEMENTE_CORPORA;
+        uint8_t *dados = gerador ? malloc(tamanho ? tamanho : 1) : lerArquivo(nome, &tamanho);
+        if (dados && gerador) gerador(dados, tamanho, &estado);
+        resultado->bytes = tamanho;
+        resultado->sucesso = dados && medirCorpus(dados, tamanho, repeticoes, opcoes, resultado);
+        free(dados);
+        ssize_t escritos = write(canal[1], resultado, sizeof(*resultado));
+        _exit(escritos == (ssize_t)sizeof(*resultado) ? 0 : 1);
+    }
+
+    close(canal[1]);
+    ssize_t lidos = read(canal[0], resultado, sizeof(*resultado));
+    close(canal[0]);
+    int situacao;
+    struct rusage uso;
+    if (wait4(filho, &situacao, 0, &uso) < 0 || lidos != (ssize_t)sizeof(*resultado)) {
+        resultado->sucesso = 0;
+        return 0;
+    }
+    resultado->picoRssKb = uso.ru_maxrss;
+    return resultado->sucesso;
+}
+
+//MEGABYTES POR SEGUNDO DOS BYTES ORIGINAIS
+static double vazao(uint64_t bytes, double segundos) {
+    return segundos > 0 ? (double)bytes / 1e6 / segundos : 0;
+}
+
+//GRAVA OS RESULTADOS EM JSON, COM UM CORPUS POR LINHA PARA QUE A COMPARAÇÃO OS LEIA LINHA A LINHA
+static void escreverResultados(FILE *saida, const ResultadoCorpus resultados[], int quantidade, size_t tamanho,
+                               int repeticoes, int threads) {
+    fprintf(saida, "{\"versao\":1,\"tamanho\":%zu,\"repeticoes\":%d,\"threads\":%d,\"corpora\":[\n", tamanho,
+            repeticoes, threads);
+    for (int i = 0; i < quantidade; i++) {
+        const ResultadoCorpus *r = &resultados[i];
+        fprintf(saida,
+                "{\"nome\":\"%s\",\"bytes\":%llu,\"bytes_compactados\":%llu,\"razao\":%.6f,"
+                "\"compactar_mb_s\":%.1f,\"descompactar_mb_s\":%.1f,\"pico_rss_kb\":%ld}%s\n",
+                r->nome, (unsigned long long)r->bytes, (unsigned long long)r->bytesCompactados,
+                r->bytes ? (double)r->bytesCompactados / (double)r->bytes : 0.0,
+                vazao(r->bytes, r->segundosCompactacao), vazao(r->bytes, r->segundosDescompactacao), r->picoRssKb,
+                i + 1 < quantidade ? "," : "");
+    }
+    fprintf(saida, "]}\n");
+}
+
+//LÊ O VALOR NUMÉRICO DE "chave": EM UMA LINHA DE RESULTADO
+static int lerCampo(const char *linha, const char *chave, double *valor) {
+    char procurado[64];
+    snprintf(procurado, sizeof(procurado), "\"%s\":", chave);
+    const char *encontrado = strstr(linha, procurado);
+    return encontrado && sscanf(encontrado + strlen(procurado), "%lf", valor) == 1;
+}
+
+//ACUSA UMA REGRESSÃO QUANDO 'atual' PIORA MAIS QUE 'margem' EM RELAÇÃO À BASE; 'maiorMelhor' DIZ O SENTIDO
+static int conferirMetrica(const char *corpus, const char *metrica, double base, double atual, double margem,
+                           int maiorMelhor) {
+    double limite = maiorMelhor ? base - margem : base + margem;
+    int regressao = maiorMelhor ? atual < limite : atual > limite;
+    double variacao = base != 0 ? 100.0 * (atual - base) / base : 0;
+    fprintf(stderr, "%-14s %-18s %12.4f %12.4f %+8.1f%%%s\n", corpus, metrica, base, atual, variacao,
+            regressao ? "  REGRESSÃO" : "");
+    return regressao;
+}
+
+//COMPARA OS RESULTADOS COM A BASE GRAVADA: A VAZÃO NÃO PODE CAIR NEM A MEMÓRIA SUBIR MAIS QUE A TOLERÂNCIA,
+//E A RAZÃO, QUE É DETERMINÍSTICA, NÃO PODE PIORAR. RETORNA QUANTAS MÉTRICAS REGREDIRAM, OU -1 SEM BASE
+static int compararComBase(const char *nomeBase, const ResultadoCorpus resultados[], int quantidade, size_t tamanho,
+                           double tolerancia) {
+    FILE *arquivo = fopen(nomeBase, "r");
+    if (!arquivo) return -1;
+    int regressoes = 0;
+    char linha[1024];
+    fprintf(stderr, "%-14s %-18s %12s %12s %9s\n", "corpus", "métrica", "base", "atual", "variação");
+    while (fgets(linha, sizeof(linha), arquivo)) {
+        const char *inicioNome = strstr(linha, "\"nome\":\"");
+        double tamanhoBase;
+        if (!inicioNome && lerCampo(linha, "tamanho", &tamanhoBase) && tamanhoBase != (double)tamanho)
+            fprintf(stderr, "aviso: a base foi medida com corpora de %.0f bytes\n", tamanhoBase);
+        if (!inicioNome) continue;
+        inicioNome += strlen("\"nome\":\"");
+        const char *fimNome = strchr(inicioNome, '"');
+        if (!fimNome) continue;
+
+        const ResultadoCorpus *r = NULL;
+        for (int i = 0; i < quantidade && !r; i++)
+            if (strlen(resultados[i].nome) == (size_t)(fimNome - inicioNome) &&
+                strncmp(resultados[i].nome, inicioNome, fimNome - inicioNome) == 0)
+                r = &resultados[i];
+        if (!r) {
+            fprintf(stderr, "%-14.*s ausente nesta execução\n", (int)(fimNome - inicioNome), inicioNome);
+            continue;
+        }
+        double razao, compactar, descompactar, pico;
+        if (!r->sucesso || !lerCampo(linha, "razao", &razao) || !lerCampo(linha, "compactar_mb_s", &compactar) ||
+            !lerCampo(linha, "descompactar_mb_s", &descompactar) || !lerCampo(linha, "pico_rss_kb", &pico))
+            continue;
+
+        double razaoAtual = r->bytes ? (double)r->bytesCompactados / (double)r->bytes : 0;
+        regressoes += conferirMetrica(r->nome, "razao", razao, razaoAtual, TOLERANCIA_RAZAO, 0);
+        regressoes += conferirMetrica(r->nome, "compactar_mb_s", compactar, vazao(r->bytes, r->segundosCompactacao),
+                                      compactar * tolerancia, 1);
+        regressoes += conferirMetrica(r->nome, "descompactar_mb_s", descompactar,
+                                      vazao(r->bytes, r->segundosDescompactacao), descompactar * tolerancia, 1);
+        regressoes += conferirMetrica(r->nome, "pico_rss_kb", pico, (double)r->picoRssKb, pico * tolerancia, 0);
+    }
+    fclose(arquivo);
+    return regressoes;
+}
+
+//MOSTRA AS OPÇÕES DA LINHA DE COMANDO
+static int exibirUso(void) {
+    fprintf(stderr, "Uso: benchmark [-m megabytes] [-r repeticoes] [-j threads] [-b base.json] [-l tolerancia] "
+                    "[-s saida.json] [arquivos...]\n"
+                    "  -m  tamanho de cada corpus gerado (padrão: 16)\n"
+                    "  -r  repetições medidas, após uma de aquecimento (padrão: 5)\n"
+                    "  -j  threads da compactação (padrão: 1, para medidas estáveis)\n"
+                    "  -b  compara com uma base gravada e termina com 1 se houver regressão\n"
+                    "  -l  tolerância em %% para vazão e memória (padrão: 10)\n"
+                    "  -s  grava os resultados nesse arquivo em vez da saída padrão\n"
+                    "Os arquivos são corpora reais, medidos além dos gerados.\n");
+    return 2;
+}
+
+int main(int argc, char *argv[]) {
+    static const struct {
+        const char *nome;
+        GeradorCorpus gerador;
+    } corpora[] = {
+        {"aleatorio", gerarAleatorio}, {"zipf", gerarZipf},   {"sequencias", gerarSequencias},
+        {"executavel", gerarExecutavel}, {"unico", gerarUnico},
+    };
+    int quantidadeGerados = (int)(sizeof(corpora) / sizeof(corpora[0]));
+    size_t tamanho = (size_t)16 << 20;
+    int repeticoes = 5, threads = 1, i = 1;
+    double tolerancia = 10;
+    const char *nomeBase = NULL, *nomeSaida = NULL;
+
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (i + 1 == argc) return exibirUso();
+        if (strcmp(argv[i], "-m") == 0 && atoi(argv[i + 1]) > 0)
+            tamanho = (size_t)atoi(argv[++i]) << 20;
+        else if (strcmp(argv[i], "-r") == 0 && atoi(argv[i + 1]) > 0)
+            repeticoes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && atoi(argv[i + 1]) > 0)
+            threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-l") == 0 && atof(argv[i + 1]) >= 0)
+            tolerancia = atof(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0)
+            nomeBase = argv[++i];
+        else if (strcmp(argv[i], "-s") == 0)
+            nomeSaida = argv[++i];
+        else
+            return exibirUso();
+    }
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.threads = threads;
+
+    int quantidade = quantidadeGerados + (argc - i), falhas = 0;
+    ResultadoCorpus *resultados = calloc(quantidade, sizeof(ResultadoCorpus));
+    if (!resultados) return 1;
+    for (int c = 0; c < quantidade; c++) {
+        int gerado = c < quantidadeGerados;
+        const char *nome = gerado ? corpora[c].nome : argv[i + c - quantidadeGerados];
+        if (!executarCorpus(nome, gerado ? corpora[c].gerador : NULL, tamanho, repeticoes, &opcoes,
+                            &resultados[c])) {
+            fprintf(stderr, "%s: falhou\n", nome);
+            falhas++;
+            continue;
+        }
+        const ResultadoCorpus *r = &resultados[c];
+        fprintf(stderr, "%-14s razão %.4f, compactar %.1f MB/s, descompactar %.1f MB/s, pico %ld KB\n", r->nome,
+                r->bytes ? (double)r->bytesCompactados / (double)r->bytes : 0.0,
+                vazao(r->bytes, r->segundosCompactacao), vazao(r->bytes, r->segundosDescompactacao), r->picoRssKb);
+    }
+
+    FILE *saida = nomeSaida ? fopen(nomeSaida, "w") : stdout;
+    if (!saida) {
+        fprintf(stderr, "benchmark: não foi possível criar %s\n", nomeSaida);
+        free(resultados);
+        return 1;
+    }
+    escreverResultados(saida, resultados, quantidade, tamanho, repeticoes, threads);
+    if (nomeSaida) fclose(saida);
+
+    int regressoes = 0;
+    if (nomeBase) {
+        regressoes = compararComBase(nomeBase, resultados, quantidade, tamanho, tolerancia / 100);
+        if (regressoes < 0) fprintf(stderr, "benchmark: base inválida: %s\n", nomeBase);
+        else if (regressoes > 0) fprintf(stderr, "benchmark: %d métricas regrediram\n", regressoes);
+    }
+    free(resultados);
+    return falhas || regressoes != 0 ? 1 : 0;
+}
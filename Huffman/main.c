@@ -1,4 +1,6 @@
 #include "algoritmo.h"
+#include <sys/stat.h>
+#include <time.h>
 
 void exibirInterface() {
     printf("╔════════════════════════════════════════════╗\n");
@@ -18,8 +20,424 @@ void pausar() {
     getchar();
 }
 
-int main() {
+typedef enum {
+    MODO_COMPACTAR,
+    MODO_DESCOMPACTAR,
+    MODO_TESTAR,
+    MODO_TREINAR,
+    MODO_EMPACOTAR,
+    MODO_EXTRAIR,
+    MODO_LISTAR
+} ModoLinhaComando;
+
+// Um arquivo da fila do modo em lote e o resultado do seu processamento
+typedef struct {
+    const char *nome;
+    ModoLinhaComando modo;
+    const OpcoesCompactacao *opcoes;
+    const Dicionario *dicionario;       // Com dicionário, cada arquivo é uma mensagem sem tabela própria
+    int silencioso;
+    int estatisticas;                   // Troca a linha do arquivo pelas estatísticas em JSON
+    uint64_t bytesEntrada;
+    uint64_t bytesSaida;
+    double segundos;
+    int sucesso;
+} ArquivoLote;
+
+double agoraEmSegundos() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (double)agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+uint64_t tamanhoDoArquivo(const char *nome) {
+    struct stat informacoes;
+    return stat(nome, &informacoes) == 0 ? (uint64_t)informacoes.st_size : 0;
+}
+
+double megabytesPorSegundo(uint64_t bytes, double segundos) {
+    return segundos > 0 ? bytes / 1e6 / segundos : 0;
+}
+
+// Nome da operação nas estatísticas em JSON
+const char *nomeOperacao(ModoLinhaComando modo) {
+    return modo == MODO_COMPACTAR ? "compactar" : modo == MODO_DESCOMPACTAR ? "descompactar" : "testar";
+}
+
+// Descompacta só para verificar a integridade, descartando a saída
+int testarFluxo(FILE *entrada, const OpcoesCompactacao *opcoes) {
+    FILE *descarte = fopen("/dev/null", "wb");
+    if (!descarte) return 0;
+    int sucesso = descompactarFluxo(entrada, descarte, opcoes);
+    fclose(descarte);
+    return sucesso;
+}
+
+// Lê a entrada inteira para a memória; as mensagens de um dicionário são pequenas
+uint8_t *lerEntradaInteira(FILE *entrada, size_t *tamanho) {
+    size_t capacidade = TAMANHO_BUFFER, lidos;
+    uint8_t *dados = malloc(capacidade);
+    *tamanho = 0;
+    while (dados && (lidos = fread(dados + *tamanho, 1, capacidade - *tamanho, entrada)) > 0) {
+        *tamanho += lidos;
+        if (*tamanho == capacidade) {
+            uint8_t *maior = realloc(dados, capacidade * 2);
+            if (!maior) free(dados);
+            dados = maior;
+            capacidade *= 2;
+        }
+    }
+    if (dados && ferror(entrada)) {
+        free(dados);
+        dados = NULL;
+    }
+    return dados;
+}
+
+// Compacta, descompacta ou testa uma mensagem inteira com o dicionário
+int processarMensagem(ModoLinhaComando modo, const Dicionario *dicionario, FILE *entrada, FILE *saida) {
+    size_t tamanhoEntrada, tamanhoSaida = 0;
+    uint64_t tamanhoOriginal = 0;
+    uint8_t *dados = lerEntradaInteira(entrada, &tamanhoEntrada);
+    if (!dados) return 0;
+    if (modo != MODO_COMPACTAR && !tamanhoMensagemDescompactada(dados, tamanhoEntrada, &tamanhoOriginal)) {
+        free(dados);
+        return 0;
+    }
+
+    size_t capacidade = modo == MODO_COMPACTAR ? limiteMensagem(tamanhoEntrada) : (size_t)tamanhoOriginal;
+    uint8_t *resultado = malloc(capacidade ? capacidade : 1);
+    int sucesso = resultado != NULL;
+    if (sucesso && modo == MODO_COMPACTAR)
+        sucesso = compactarMensagem(dicionario, dados, tamanhoEntrada, resultado, capacidade, &tamanhoSaida);
+    else if (sucesso)
+        sucesso = descompactarMensagem(dicionario, dados, tamanhoEntrada, resultado, capacidade, &tamanhoSaida);
+    if (sucesso && modo != MODO_TESTAR)
+        sucesso = fwrite(resultado, 1, tamanhoSaida, saida) == tamanhoSaida && fflush(saida) == 0;
+    free(dados);
+    free(resultado);
+    return sucesso;
+}
+
+int processarFluxo(ModoLinhaComando modo, const OpcoesCompactacao *opcoes, const Dicionario *dicionario) {
+    int sucesso;
+    if (dicionario)
+        sucesso = processarMensagem(modo, dicionario, stdin, stdout);
+    else if (modo == MODO_COMPACTAR)
+        sucesso = compactarFluxo(stdin, stdout, opcoes);
+    else if (modo == MODO_DESCOMPACTAR)
+        sucesso = descompactarFluxo(stdin, stdout, opcoes);
+    else
+        sucesso = testarFluxo(stdin, opcoes);
+    if (!sucesso)
+        fprintf(stderr, "huff: falha ao processar a entrada\n");
+    else if (opcoes->estatisticas && !dicionario)
+        escreverEstatisticasJson(stderr, nomeOperacao(modo), NULL, opcoes->estatisticas);
+    return sucesso ? 0 : 1;
+}
+
+// Processa um arquivo como mensagem do dicionário, gravando em 'nomeSaida' (NULL ao testar)
+int processarArquivoMensagem(const ArquivoLote *arquivo, const char *nomeSaida) {
+    FILE *entrada = fopen(arquivo->nome, "rb");
+    if (!entrada) return 0;
+    FILE *saida = nomeSaida ? fopen(nomeSaida, "wb") : NULL;
+    int sucesso = (saida || !nomeSaida) && processarMensagem(arquivo->modo, arquivo->dicionario, entrada, saida);
+    if (saida && fclose(saida) != 0) sucesso = 0;
+    fclose(entrada);
+    return sucesso;
+}
+
+// Tarefa do grupo de threads: compacta em 'nome.huff', descompacta 'nome.huff' em 'nome' ou só testa
+void processarArquivoLote(void *argumento) {
+    ArquivoLote *arquivo = argumento;
+    size_t tamanhoNome = strlen(arquivo->nome);
+    char *nomeSaida = malloc(tamanhoNome + sizeof(".huff"));
+    double inicio = agoraEmSegundos();
+    arquivo->sucesso = 0;
+
+    // As opções são de todo o lote; as estatísticas, de cada arquivo
+    OpcoesCompactacao opcoes = *arquivo->opcoes;
+    EstatisticasCodec estatisticas;
+    opcoes.estatisticas = arquivo->estatisticas && !arquivo->dicionario ? &estatisticas : NULL;
+
+    if (!nomeSaida) {
+        fprintf(stderr, "%s: memória insuficiente\n", arquivo->nome);
+    } else if (arquivo->modo == MODO_COMPACTAR) {
+        sprintf(nomeSaida, "%s.huff", arquivo->nome);
+        arquivo->sucesso = arquivo->dicionario ? processarArquivoMensagem(arquivo, nomeSaida)
+                                               : compactarHuffmanComOpcoes(arquivo->nome, nomeSaida, &opcoes);
+    } else if (arquivo->modo == MODO_DESCOMPACTAR) {
+        if (tamanhoNome <= 5 || strcmp(arquivo->nome + tamanhoNome - 5, ".huff") != 0) {
+            fprintf(stderr, "%s: o nome não termina em .huff\n", arquivo->nome);
+            free(nomeSaida);
+            return;
+        }
+        memcpy(nomeSaida, arquivo->nome, tamanhoNome - 5);
+        nomeSaida[tamanhoNome - 5] = '\0';
+        arquivo->sucesso = arquivo->dicionario ? processarArquivoMensagem(arquivo, nomeSaida)
+                                               : descompactarHuffmanComOpcoes(arquivo->nome, nomeSaida, &opcoes);
+    } else if (arquivo->dicionario) {
+        arquivo->sucesso = processarArquivoMensagem(arquivo, NULL);
+    } else {
+        FILE *entrada = fopen(arquivo->nome, "rb");
+        arquivo->sucesso = entrada && testarFluxo(entrada, &opcoes);
+        if (entrada) fclose(entrada);
+    }
+    arquivo->segundos = agoraEmSegundos() - inicio;
+
+    arquivo->bytesEntrada = tamanhoDoArquivo(arquivo->nome);
+    arquivo->bytesSaida = arquivo->modo == MODO_TESTAR ? 0 : tamanhoDoArquivo(nomeSaida);
+    free(nomeSaida);
+
+    // Cada linha sai em uma única chamada, então as threads não misturam o texto
+    if (!arquivo->sucesso)
+        fprintf(stderr, "%s: falhou\n", arquivo->nome);
+    else if (opcoes.estatisticas)
+        escreverEstatisticasJson(stderr, nomeOperacao(arquivo->modo), arquivo->nome, &estatisticas);
+    else if (arquivo->silencioso)
+        return;
+    else if (arquivo->modo == MODO_TESTAR)
+        fprintf(stderr, "%s: OK, %llu bytes, %.1f MB/s\n", arquivo->nome, (unsigned long long)arquivo->bytesEntrada,
+                megabytesPorSegundo(arquivo->bytesEntrada, arquivo->segundos));
+    else
+        fprintf(stderr, "%s: %llu -> %llu bytes, %.1f MB/s\n", arquivo->nome,
+                (unsigned long long)arquivo->bytesEntrada, (unsigned long long)arquivo->bytesSaida,
+                megabytesPorSegundo(arquivo->modo == MODO_COMPACTAR ? arquivo->bytesEntrada : arquivo->bytesSaida,
+                                    arquivo->segundos));
+}
+
+// Distribui os arquivos entre as threads; a vazão total é medida no tempo de parede do lote
+int processarLote(ModoLinhaComando modo, char *nomes[], int quantidade, int paralelos, int silencioso,
+                  int estatisticas, OpcoesCompactacao *opcoes, const Dicionario *dicionario) {
+    // Com mais arquivos que threads, cada arquivo usa uma só; com poucos, as threads sobrando vão para os blocos
+    if (paralelos > quantidade) {
+        opcoes->threads = paralelos / quantidade;
+        paralelos = quantidade;
+    } else {
+        opcoes->threads = 1;
+    }
+
+    ArquivoLote *arquivos = calloc(quantidade, sizeof(ArquivoLote));
+    GrupoThreads *grupo = criarGrupoThreads(paralelos);
+    if (!arquivos || !grupo) {
+        fprintf(stderr, "huff: memória insuficiente\n");
+        free(arquivos);
+        destruirGrupoThreads(grupo);
+        return 1;
+    }
+
+    double inicio = agoraEmSegundos();
+    for (int i = 0; i < quantidade; i++) {
+        arquivos[i].nome = nomes[i];
+        arquivos[i].modo = modo;
+        arquivos[i].opcoes = opcoes;
+        arquivos[i].dicionario = dicionario;
+        arquivos[i].silencioso = silencioso;
+        arquivos[i].estatisticas = estatisticas;
+        enviarTarefa(grupo, processarArquivoLote, &arquivos[i]);
+    }
+    aguardarTarefas(grupo);
+    double segundos = agoraEmSegundos() - inicio;
+
+    uint64_t bytesEntrada = 0, bytesSaida = 0;
+    int falhas = 0;
+    for (int i = 0; i < quantidade; i++) {
+        if (!arquivos[i].sucesso) {
+            falhas++;
+            continue;
+        }
+        bytesEntrada += arquivos[i].bytesEntrada;
+        bytesSaida += arquivos[i].bytesSaida;
+    }
+    if (modo == MODO_TESTAR)
+        fprintf(stderr, "total: %d arquivos, %d falhas, %llu bytes em %.3f s, %.1f MB/s\n", quantidade, falhas,
+                (unsigned long long)bytesEntrada, segundos, megabytesPorSegundo(bytesEntrada, segundos));
+    else
+        fprintf(stderr, "total: %d arquivos, %d falhas, %llu -> %llu bytes em %.3f s, %.1f MB/s\n", quantidade,
+                falhas, (unsigned long long)bytesEntrada, (unsigned long long)bytesSaida, segundos,
+                megabytesPorSegundo(modo == MODO_COMPACTAR ? bytesEntrada : bytesSaida, segundos));
+
+    free(arquivos);
+    destruirGrupoThreads(grupo);
+    return falhas ? 1 : 0;
+}
+
+// Cria, extrai ou lista um pacote; sem nomes, a extração inclui todas as entradas
+int processarPacote(ModoLinhaComando modo, const char *nomePacote, char *nomes[], int quantidade, const char *destino,
+                    int silencioso, const OpcoesCompactacao *opcoes) {
+    double inicio = agoraEmSegundos();
+    int sucesso = 1;
+    if (modo == MODO_EMPACOTAR) {
+        FalhaPacote falha;
+        OpcoesCompactacao opcoesPacote = *opcoes;
+        opcoesPacote.falhaPacote = &falha;
+        sucesso = criarPacote(nomePacote, nomes, quantidade, &opcoesPacote);
+        if (!sucesso && falha.caminho[0] != '\0')
+            fprintf(stderr, "huff: %s: %s\n", falha.caminho,
+                    falha.codigo ? strerror(falha.codigo) : "nome inválido ou arquivo alterado durante a leitura");
+    } else if (modo == MODO_EXTRAIR) {
+        sucesso = extrairPacote(nomePacote, destino, nomes, quantidade, opcoes);
+    }
+    if (!sucesso) {
+        fprintf(stderr, "huff: falha ao %s o pacote %s\n", modo == MODO_EMPACOTAR ? "criar" : "extrair", nomePacote);
+        return 1;
+    }
+    double segundos = agoraEmSegundos() - inicio;
+
+    // O resumo e a listagem vêm do diretório central, sem descompactar nada
+    FILE *pacote = fopen(nomePacote, "rb");
+    DiretorioPacote diretorio;
+    if (!pacote || !lerDiretorioPacote(pacote, &diretorio)) {
+        fprintf(stderr, "huff: pacote inválido: %s\n", nomePacote);
+        if (pacote) fclose(pacote);
+        return 1;
+    }
+    // Na extração de nomes escolhidos, o total conta só as entradas pedidas, e cada uma uma vez, como foram extraídas
+    int escolhidas = modo == MODO_EXTRAIR && quantidade > 0;
+    size_t pedidas = escolhidas ? (size_t)quantidade : diretorio.quantidade, total = 0;
+    unsigned char *contadas = calloc(diretorio.quantidade ? diretorio.quantidade : 1, 1);
+    if (!contadas) {
+        fprintf(stderr, "huff: memória insuficiente\n");
+        liberarDiretorioPacote(&diretorio);
+        fclose(pacote);
+        return 1;
+    }
+    uint64_t bytesEntrada = 0, bytesSaida = 0;
+    for (size_t i = 0; i < pedidas; i++) {
+        const EntradaPacote *entrada = escolhidas ? buscarEntradaPacote(&diretorio, nomes[i]) : &diretorio.entradas[i];
+        size_t posicao = (size_t)(entrada - diretorio.entradas);
+        if (contadas[posicao]) continue;
+        contadas[posicao] = 1;
+        total++;
+        if (modo == MODO_LISTAR && !silencioso)
+            printf("%12llu %12llu  %s\n", (unsigned long long)entrada->tamanhoOriginal,
+                   (unsigned long long)entrada->tamanhoCompactado, entrada->nome);
+        bytesEntrada += entrada->tamanhoOriginal;
+        bytesSaida += entrada->tamanhoCompactado;
+    }
+    if (modo == MODO_LISTAR)
+        fprintf(stderr, "total: %zu arquivos, %llu -> %llu bytes\n", total,
+                (unsigned long long)bytesEntrada, (unsigned long long)bytesSaida);
+    else
+        fprintf(stderr, "total: %zu arquivos, %llu -> %llu bytes em %.3f s, %.1f MB/s\n", total,
+                (unsigned long long)bytesEntrada, (unsigned long long)bytesSaida, segundos,
+                megabytesPorSegundo(bytesEntrada, segundos));
+    free(contadas);
+    liberarDiretorioPacote(&diretorio);
+    fclose(pacote);
+    return 0;
+}
+
+int exibirUso() {
+    fprintf(stderr, "Uso: huff (-c | -d | -t) [-e huffman|tans] [-o] [-D dicionario] [-j threads] [-p] [-q] "
+                    "[--stats] [arquivos...]\n"
+                    "     huff -T dicionario amostras...\n"
+                    "     huff [-j threads] [-q] (-a pacote caminhos... | -x pacote [-C destino] [nomes...] | -l pacote)\n"
+                    "  -c  compacta cada arquivo em arquivo.huff\n"
+                    "  -d  descompacta cada arquivo.huff em arquivo\n"
+                    "  -t  testa a integridade, sem gravar nada\n"
+                    "  -e  codificador dos blocos (padrão: o menor em cada bloco)\n"
+                    "  -o  tenta também tabelas escolhidas pelo byte anterior (ordem 1)\n"
+                    "  -D  trata cada arquivo como mensagem curta codificada pelo dicionário\n"
+                    "  -T  treina um dicionário com as amostras e o grava\n"
+                    "  -a  empacota arquivos e diretórios inteiros em um só arquivo\n"
+                    "  -x  extrai as entradas pedidas do pacote (padrão: todas), cada uma sem ler as outras\n"
+                    "  -l  lista as entradas do pacote com os tamanhos original e compactado\n"
+                    "  -C  diretório onde o pacote é extraído (padrão: o atual)\n"
+                    "  -j  arquivos processados ao mesmo tempo (padrão: um por processador)\n"
+                    "  -p  lê, processa e grava os blocos em estágios simultâneos\n"
+                    "  -q  mostra apenas o total\n"
+                    "  --stats  mostra as fases, a entropia e a vazão de cada arquivo em uma linha JSON\n"
+                    "Sem arquivos, lê da entrada padrão e grava na saída padrão.\n");
+    return 2;
+}
+
+int processarLinhaComando(int argc, char *argv[]) {
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    int modo = -1, paralelos = 0, silencioso = 0, estatisticas = 0, i = 1;
+    const char *nomeDicionario = NULL, *nomePacote = NULL, *destino = NULL;
+
+    for (; i < argc && argv[i][0] == '-' && argv[i][1] != '\0'; i++) {
+        if (strcmp(argv[i], "-c") == 0) {
+            modo = MODO_COMPACTAR;
+        } else if (strcmp(argv[i], "-d") == 0) {
+            modo = MODO_DESCOMPACTAR;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            modo = MODO_TESTAR;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            silencioso = 1;
+        } else if (strcmp(argv[i], "-o") == 0) {
+            opcoes.ordem1 = 1;
+        } else if (strcmp(argv[i], "-p") == 0) {
+            opcoes.pipeline = 1;
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc && strcmp(argv[i + 1], "huffman") == 0) {
+            opcoes.codificador = CODIFICADOR_HUFFMAN;
+            i++;
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc && strcmp(argv[i + 1], "tans") == 0) {
+            opcoes.codificador = CODIFICADOR_TANS;
+            i++;
+        } else if ((strcmp(argv[i], "-D") == 0 || strcmp(argv[i], "-T") == 0) && i + 1 < argc) {
+            if (argv[i][1] == 'T') modo = MODO_TREINAR;
+            nomeDicionario = argv[++i];
+        } else if ((strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "-x") == 0 || strcmp(argv[i], "-l") == 0) &&
+                   i + 1 < argc) {
+            modo = argv[i][1] == 'a' ? MODO_EMPACOTAR : argv[i][1] == 'x' ? MODO_EXTRAIR : MODO_LISTAR;
+            nomePacote = argv[++i];
+        } else if (strcmp(argv[i], "-C") == 0 && i + 1 < argc) {
+            destino = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc && atoi(argv[i + 1]) > 0) {
+            paralelos = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--stats") == 0) {
+            estatisticas = 1;
+        } else if (strcmp(argv[i], "--") == 0) {
+            i++;
+            break;
+        } else {
+            return exibirUso();
+        }
+    }
+    if (modo < 0) return exibirUso();
+
+    if (modo == MODO_EMPACOTAR || modo == MODO_EXTRAIR || modo == MODO_LISTAR) {
+        // No pacote, -j é o número de threads; as entradas e os blocos dividem as mesmas threads
+        if ((modo == MODO_EMPACOTAR && i == argc) || (modo == MODO_LISTAR && i < argc)) return exibirUso();
+        opcoes.threads = paralelos;
+        return processarPacote((ModoLinhaComando)modo, nomePacote, argv + i, argc - i, destino, silencioso, &opcoes);
+    }
+
+    Dicionario dicionario;
+    if (modo == MODO_TREINAR) {
+        if (i == argc) return exibirUso();
+        if (!treinarDicionario(argv + i, argc - i, &dicionario) || !salvarDicionario(nomeDicionario, &dicionario)) {
+            fprintf(stderr, "huff: falha ao treinar o dicionário %s\n", nomeDicionario);
+            return 1;
+        }
+        return 0;
+    }
+    if (nomeDicionario && !carregarDicionario(nomeDicionario, &dicionario)) {
+        fprintf(stderr, "huff: dicionário inválido: %s\n", nomeDicionario);
+        return 1;
+    }
+
+    const Dicionario *usado = nomeDicionario ? &dicionario : NULL;
+    if (i == argc) {
+        EstatisticasCodec estatisticasFluxo;
+        if (estatisticas) opcoes.estatisticas = &estatisticasFluxo;
+        return processarFluxo((ModoLinhaComando)modo, &opcoes, usado);
+    }
+    if (paralelos == 0) paralelos = threadsDisponiveis();
+    return processarLote((ModoLinhaComando)modo, argv + i, argc - i, paralelos, silencioso, estatisticas, &opcoes,
+                         usado);
+}
+
+int main(int argc, char *argv[]) {
     char opcao, arquivoEntrada[256], arquivoSaida[256];
+
+    // Com argumentos, roda sem o menu: em lote sobre arquivos ou da entrada padrão para a saída padrão
+    if (argc > 1)
+        return processarLinhaComando(argc, argv);
+
     do {
         system("clear || cls");
         exibirInterface();
@@ -1,6 +1,9 @@
 #include <assert.h>
+#include <errno.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "algoritmo.h"
 
 // Protótipo da função de geração de nome com extensão .huff (do main.c)
@@ -37,7 +40,7 @@ static void test_contarFrequencias() {
     fputs("ABA", f);
     fclose(f);
 
-    unsigned int frequencias[TAMANHO_TABELA] = {0};
+    uint64_t frequencias[TAMANHO_TABELA] = {0};
     contarFrequencias(nome, frequencias);
     assert(frequencias[(unsigned char)'A'] == 2);
     assert(frequencias[(unsigned char)'B'] == 1);
@@ -47,12 +50,36 @@ static void test_contarFrequencias() {
     remove(nome);
 }
 
+//TESTA OS SUB-HISTOGRAMAS CONTRA A CONTAGEM SIMPLES, COM CORRIDAS, SOBRAS E INÍCIO DESALINHADO
+static void test_acumularFrequencias() {
+    size_t tamanho = 100003;
+    uint8_t *dados = malloc(tamanho);
+    uint32_t semente = 99;
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        // Trechos alternados de zeros, espaços e bytes aleatórios
+        dados[i] = (i / 500) % 3 == 0 ? 0 : (i / 500) % 3 == 1 ? ' ' : (uint8_t)(semente >> 24);
+    }
+    for (size_t inicio = 0; inicio < 3; inicio++) {
+        uint64_t esperado[TAMANHO_TABELA] = {0}, frequencias[TAMANHO_TABELA] = {0};
+        for (size_t i = inicio; i < tamanho; i++) esperado[dados[i]]++;
+        acumularFrequencias(dados + inicio, tamanho - inicio, frequencias);
+        assert(memcmp(esperado, frequencias, sizeof(esperado)) == 0);
+        // A contagem soma às frequências existentes
+        acumularFrequencias(dados + inicio, 100, frequencias);
+        for (size_t i = inicio; i < inicio + 100; i++) esperado[dados[i]]++;
+        assert(memcmp(esperado, frequencias, sizeof(esperado)) == 0);
+    }
+    free(dados);
+}
+
 //TESTA A CONSTRUÇÃO DA ARVORE E GERAÇÃO DE CÓDIGOS PARA 2 SÍMBOLOS
 static void test_construirArvoreHuffman_e_gerarCodigos() {
-    unsigned int freq[TAMANHO_TABELA] = {0};
+    uint64_t freq[TAMANHO_TABELA] = {0};
     freq[(unsigned char)'A'] = 2;
     freq[(unsigned char)'B'] = 3;
-    No *raiz = construirArvoreHuffman(freq);
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
     assert(raiz != NULL);
     assert(raiz->frequencia == 5);
     assert(raiz->esquerda->simbolo == (unsigned char)'A');
@@ -64,18 +91,83 @@ static void test_construirArvoreHuffman_e_gerarCodigos() {
     assert(strcmp(tabela[(unsigned char)'A'], "0") == 0);
     assert(strcmp(tabela[(unsigned char)'B'], "1") == 0);
 
-    // Liberação simplificada da árvore
-    free(raiz->esquerda);
-    free(raiz->direita);
-    free(raiz);
+    liberarArena(arena);
+}
+
+//TESTA OS CÓDIGOS INTEIROS PARA A=1, B=00 E C=01
+static void test_gerarCodigosInteiros() {
+    uint64_t freq[TAMANHO_TABELA] = {0};
+    freq[(unsigned char)'A'] = 4;
+    freq[(unsigned char)'B'] = 1;
+    freq[(unsigned char)'C'] = 2;
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
+
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    assert(gerarCodigosInteiros(raiz, codigos));
+    assert(codigos['A'].bits == 1 && codigos['A'].tamanho == 1);
+    assert(codigos['B'].bits == 0 && codigos['B'].tamanho == 2);
+    assert(codigos['C'].bits == 1 && codigos['C'].tamanho == 2);
+    assert(codigos['D'].tamanho == 0);
+    liberarArena(arena);
+}
+
+//TESTA O EMPACOTAMENTO DE CÓDIGOS CURTOS E LONGOS PELO ESCRITOR DE BITS
+static void test_escreverCodigo() {
+    const char *nome = "escritor_test.bin";
+    FILE *f = fopen(nome, "wb");
+    assert(f != NULL);
+    EscritorBits escritor;
+    assert(inicializarEscritor(&escritor, f));
+    escreverCodigo(&escritor, 0x5, 3);                  // 101
+    escreverCodigo(&escritor, 0x123456789ULL, 36);      // código maior que 32 bits
+    escreverCodigo(&escritor, 0x1, 1);                  // 1
+    assert(escritor.totalBits == 40);
+    finalizarEscritor(&escritor);
+    fclose(f);
+
+    FILE *g = fopen(nome, "rb");
+    assert(g != NULL);
+    unsigned char lido[8] = {0};
+    size_t lidos = fread(lido, 1, sizeof(lido), g);
+    fclose(g);
+    assert(lidos == 5);
+    // 101 + 0001 0010 0011 0100 0101 0110 0111 1000 1001 + 1
+    const unsigned char esperado[5] = {0xA2, 0x46, 0x8A, 0xCF, 0x13};
+    assert(memcmp(lido, esperado, 5) == 0);
+    remove(nome);
+}
+
+//TESTA QUE TODOS OS NÓS VÊM DA ARENA E QUE EMPATES FAVORECEM AS FOLHAS, COMO NA LISTA ORDENADA
+static void test_construirArvoreHuffman_naArena() {
+    uint64_t freq[TAMANHO_TABELA] = {0};
+    freq[(unsigned char)'A'] = 1;
+    freq[(unsigned char)'B'] = 1;
+    freq[(unsigned char)'C'] = 2;
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
+    assert(arena->usados == 5);
+    assert(raiz >= arena->nos && raiz < arena->nos + arena->usados);
+    assert(raiz->frequencia == 4);
+    // A+B (2) empata com a folha C (2): a folha sai primeiro e fica à esquerda
+    assert(raiz->esquerda->simbolo == 'C' && !raiz->esquerda->esquerda);
+    assert(raiz->direita->esquerda->simbolo == 'A');
+    assert(raiz->direita->direita->simbolo == 'B');
+
+    // A arena é reaproveitada a cada construção
+    uint64_t vazio[TAMANHO_TABELA] = {0};
+    assert(construirArvoreHuffman(vazio, arena) == NULL);
+    assert(arena->usados == 0);
+    liberarArena(arena);
 }
 
 //TESTA A SERIALIZAÇÃO PRÉ ORDEM DÁ ÁRVORE
 static void test_escreverArvore() {
-    unsigned int freq[TAMANHO_TABELA] = {0};
+    uint64_t freq[TAMANHO_TABELA] = {0};
     freq[(unsigned char)'A'] = 1;
     freq[(unsigned char)'B'] = 1;
-    No *raiz = construirArvoreHuffman(freq);
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
 
     const char *nome = "arvore_test.bin";
     FILE *f = fopen(nome, "wb");
@@ -94,9 +186,1008 @@ static void test_escreverArvore() {
     assert((buffer[1] == 'A' && buffer[2] == 'B') || (buffer[1] == 'B' && buffer[2] == 'A'));
     remove(nome);
 
-    free(raiz->esquerda);
-    free(raiz->direita);
-    free(raiz);
+    liberarArena(arena);
+}
+
+//TESTA A TABELA DE DECODIFICAÇÃO PARA OS CÓDIGOS A=1, B=00 E C=01
+static void test_construirTabelaDecodificacao() {
+    uint64_t freq[TAMANHO_TABELA] = {0};
+    freq[(unsigned char)'A'] = 4;
+    freq[(unsigned char)'B'] = 1;
+    freq[(unsigned char)'C'] = 2;
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
+
+    EntradaDecodificacao tabela[1 << BITS_TABELA];
+    construirTabelaDecodificacao(raiz, tabela);
+    for (int i = 0; i < (1 << BITS_TABELA); i++) {
+        int prefixo = i >> (BITS_TABELA - 2);
+        if (prefixo >= 2) {
+            assert(tabela[i].simbolo == 'A' && tabela[i].bits == 1);
+        } else if (prefixo == 0) {
+            assert(tabela[i].simbolo == 'B' && tabela[i].bits == 2);
+        } else {
+            assert(tabela[i].simbolo == 'C' && tabela[i].bits == 2);
+        }
+    }
+    liberarArena(arena);
+}
+
+//COMPACTA E DESCOMPACTA UM ARQUIVO, CONFERINDO SE O CONTEÚDO VOLTOU IGUAL
+static void verificarIdaEVoltaComOpcoes(const unsigned char *dados, size_t tamanho, const OpcoesCompactacao *opcoes) {
+    const char *original = "ida_volta.txt";
+    const char *compactado = "ida_volta.huff";
+    const char *restaurado = "ida_volta.out";
+
+    FILE *f = fopen(original, "wb");
+    assert(f != NULL);
+    fwrite(dados, 1, tamanho, f);
+    fclose(f);
+
+    assert(compactarHuffmanComOpcoes(original, compactado, opcoes));
+    descompactarHuffman(compactado, restaurado);
+
+    FILE *g = fopen(restaurado, "rb");
+    assert(g != NULL);
+    unsigned char *lido = malloc(tamanho + 1);
+    size_t lidos = fread(lido, 1, tamanho + 1, g);
+    fclose(g);
+    assert(lidos == tamanho);
+    assert(memcmp(lido, dados, tamanho) == 0);
+    free(lido);
+
+    remove(original);
+    remove(compactado);
+    remove(restaurado);
+}
+
+static void verificarIdaEVolta(const unsigned char *dados, size_t tamanho, FormatoArquivo formato) {
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.formato = formato;
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+}
+
+//TESTA A DECODIFICAÇÃO POR TABELA COM CÓDIGOS CURTOS, LONGOS E SÍMBOLOS ESCAPADOS
+static void test_decodificarBits() {
+    const char *texto = "ABRACADABRA * \\ ABRACADABRA";
+    verificarIdaEVolta((const unsigned char *)texto, strlen(texto), FORMATO_ARVORE);
+
+    // Frequências de Fibonacci geram códigos maiores que BITS_TABELA
+    size_t tamanho = 0, fib[20] = {1, 1};
+    for (int i = 2; i < 20; i++) fib[i] = fib[i - 1] + fib[i - 2];
+    for (int i = 0; i < 20; i++) tamanho += fib[i];
+    unsigned char *dados = malloc(tamanho);
+    size_t posicao = 0;
+    for (int i = 0; i < 20; i++) {
+        for (size_t j = 0; j < fib[i]; j++)
+            dados[posicao++] = (unsigned char)(i * 7 + 3);
+    }
+    // Embaralha de forma determinística
+    for (size_t i = tamanho - 1; i > 0; i--) {
+        size_t j = (i * 2654435761u) % (i + 1);
+        unsigned char temp = dados[i];
+        dados[i] = dados[j];
+        dados[j] = temp;
+    }
+    verificarIdaEVolta(dados, tamanho, FORMATO_ARVORE);
+    verificarIdaEVolta(dados, tamanho, FORMATO_CANONICO);
+
+    // Sem limite os códigos longos passam pela busca ordenada; com limite de 11 bits tudo sai da tabela.
+    // Os quatro sub-fluxos limitariam os códigos por conta própria, então ficam desligados
+    OpcoesCompactacao opcoes;
+    RelatorioCompactacao relatorio;
+    opcoesPadrao(&opcoes);
+    opcoes.relatorio = &relatorio;
+    opcoes.quatroFluxos = 0;
+    opcoes.comprimentoMaximo = 0;
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+    assert(relatorio.comprimentoMaximo == 19);
+    assert(relatorio.bitsCodificados == relatorio.bitsSemLimite);
+    opcoes.comprimentoMaximo = BITS_TABELA;
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+    assert(relatorio.comprimentoMaximo == BITS_TABELA);
+    assert(relatorio.bitsCodificados > relatorio.bitsSemLimite);
+    free(dados);
+}
+
+//TESTA OS CÓDIGOS CANÔNICOS: MESMO TAMANHO QUE A ÁRVORE, ATRIBUÍDOS EM ORDEM DE TAMANHO E SÍMBOLO
+static void test_gerarCodigosCanonicos() {
+    uint64_t freq[TAMANHO_TABELA] = {0};
+    freq[(unsigned char)'A'] = 4;
+    freq[(unsigned char)'B'] = 1;
+    freq[(unsigned char)'C'] = 2;
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
+
+    uint8_t comprimentos[TAMANHO_TABELA];
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    calcularComprimentos(raiz, comprimentos);
+    assert(comprimentos['A'] == 1 && comprimentos['B'] == 2 && comprimentos['C'] == 2);
+    assert(gerarCodigosCanonicos(comprimentos, codigos));
+    assert(codigos['A'].bits == 0 && codigos['A'].tamanho == 1);
+    assert(codigos['B'].bits == 2 && codigos['B'].tamanho == 2);
+    assert(codigos['C'].bits == 3 && codigos['C'].tamanho == 2);
+
+    // Três códigos de 1 bit violam a desigualdade de Kraft
+    comprimentos['D'] = 1;
+    comprimentos['B'] = 1;
+    assert(!gerarCodigosCanonicos(comprimentos, codigos));
+    liberarArena(arena);
+}
+
+//TESTA O PACKAGE-MERGE: SEM LIMITE EFETIVO É IGUAL A HUFFMAN, COM LIMITE RESPEITA O TETO
+static void test_calcularComprimentosLimitados() {
+    uint64_t freq[TAMANHO_TABELA] = {0};
+    unsigned int a = 1, b = 1;
+    for (int i = 0; i < 10; i++) {
+        freq['a' + i] = a;
+        unsigned int c = a + b;
+        a = b;
+        b = c;
+    }
+    ArenaNos *arena = criarArena();
+    No *raiz = construirArvoreHuffman(freq, arena);
+    uint8_t otimos[TAMANHO_TABELA], limitados[TAMANHO_TABELA];
+    calcularComprimentos(raiz, otimos);
+    assert(otimos['a'] == 9);
+
+    assert(calcularComprimentosLimitados(freq, 64, limitados));
+    assert(contarBitsCodificados(freq, limitados) == contarBitsCodificados(freq, otimos));
+
+    CodigoHuffman codigos[TAMANHO_TABELA];
+    assert(calcularComprimentosLimitados(freq, 4, limitados));
+    for (int i = 0; i < TAMANHO_TABELA; i++) {
+        assert(limitados[i] <= 4);
+        assert((limitados[i] > 0) == (freq[i] > 0));
+    }
+    assert(gerarCodigosCanonicos(limitados, codigos));
+    assert(contarBitsCodificados(freq, limitados) > contarBitsCodificados(freq, otimos));
+
+    // Dez símbolos não cabem em códigos de 3 bits
+    assert(!calcularComprimentosLimitados(freq, 3, limitados));
+    liberarArena(arena);
+}
+
+//GRAVA E RELÊ UMA TABELA DE TAMANHOS, CONFERINDO O MODO ESCOLHIDO
+static void verificarComprimentos(const uint8_t comprimentos[], int modoEsperado) {
+    uint8_t bytes[1 + TAMANHO_TABELA];
+    EscritorBits escritor;
+    assert(inicializarEscritorMemoria(&escritor, bytes, sizeof(bytes)));
+    int escritos = escreverComprimentos(comprimentos, &escritor);
+    finalizarEscritor(&escritor);
+    assert(!escritor.estouro && escritor.posicao == (size_t)escritos);
+    assert(bytes[0] == modoEsperado);
+
+    uint8_t lidos[TAMANHO_TABELA];
+    LeitorBits leitor;
+    inicializarLeitorMemoria(&leitor, bytes, escritos);
+    assert(lerComprimentos(&leitor, lidos));
+    assert(lerByteLeitor(&leitor) == EOF);
+    assert(memcmp(lidos, comprimentos, TAMANHO_TABELA) == 0);
+}
+
+//TESTA OS QUATRO MODOS DE GRAVAÇÃO DA TABELA DE TAMANHOS
+static void test_escreverComprimentos() {
+    uint8_t comprimentos[TAMANHO_TABELA] = {0};
+    comprimentos['a'] = 1;
+    comprimentos['z'] = 2;
+    comprimentos['!'] = 2;
+    verificarComprimentos(comprimentos, TABELA_ESPARSA);
+
+    for (int i = 0; i < TAMANHO_TABELA; i++) comprimentos[i] = 8;
+    verificarComprimentos(comprimentos, TABELA_EM_CORRIDAS);
+
+    for (int i = 0; i < TAMANHO_TABELA; i++) comprimentos[i] = (uint8_t)(1 + i % 15);
+    verificarComprimentos(comprimentos, TABELA_COMPACTA);
+
+    for (int i = 0; i < TAMANHO_TABELA; i++) comprimentos[i] = (uint8_t)(1 + i % 40);
+    verificarComprimentos(comprimentos, TABELA_COMPLETA);
+}
+
+//TESTA O FORMATO CANÔNICO COM ARQUIVO VAZIO, UM ÚNICO SÍMBOLO E O FORMATO ORIGINAL AINDA LEGÍVEL
+static void test_formatoCanonico() {
+    verificarIdaEVolta((const unsigned char *)"", 0, FORMATO_CANONICO);
+    verificarIdaEVolta((const unsigned char *)"zzzzzzzzzz", 10, FORMATO_CANONICO);
+    const char *texto = "o rato roeu a roupa do rei de roma";
+    verificarIdaEVolta((const unsigned char *)texto, strlen(texto), FORMATO_CANONICO);
+    verificarIdaEVolta((const unsigned char *)texto, strlen(texto), FORMATO_ARVORE);
+}
+
+//TESTA O FORMATO EM BLOCOS COM VÁRIAS THREADS, BLOCOS CRUS E BLOCOS DE UM ÚNICO SÍMBOLO
+static void test_formatoBlocos() {
+    size_t tamanho = 40000;
+    unsigned char *dados = malloc(tamanho);
+    const char *texto = "o rato roeu a roupa do rei de roma ";
+    uint32_t semente = 12345;
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        if (i < 15000) dados[i] = (unsigned char)texto[i % strlen(texto)];
+        else if (i < 25000) dados[i] = (unsigned char)(semente >> 24);
+        else dados[i] = 'x';
+    }
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 1000;
+    for (int threads = 1; threads <= 4; threads += 3) {
+        opcoes.threads = threads;
+        verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+        verificarIdaEVoltaComOpcoes(dados, 0, &opcoes);
+        verificarIdaEVoltaComOpcoes(dados, 1, &opcoes);
+    }
+
+    // Bytes aleatórios ficam crus; um único símbolo grava só a tabela
+    uint8_t bloco[1000 + MARGEM_CABECALHO_BLOCO], restaurado[1000];
+    EscritorBits escritor;
+    assert(inicializarEscritorMemoria(&escritor, bloco, sizeof(bloco)));
+    assert(compactarBloco(dados + 15000, 1000, &opcoes, &escritor, NULL));
+    finalizarEscritor(&escritor);
+    assert(!escritor.estouro && bloco[0] == BLOCO_CRU);
+    assert(escritor.posicao == 1 + 2 + 2 + 1000);
+    assert(descompactarBloco(BLOCO_CRU, bloco + 5, 1000, restaurado, 1000));
+    assert(memcmp(restaurado, dados + 15000, 1000) == 0);
+
+    assert(inicializarEscritorMemoria(&escritor, bloco, sizeof(bloco)));
+    assert(compactarBloco(dados + 30000, 1000, &opcoes, &escritor, NULL));
+    finalizarEscritor(&escritor);
+    assert(bloco[0] == BLOCO_HUFFMAN && escritor.posicao < 10);
+    assert(descompactarBloco(BLOCO_HUFFMAN, bloco + 4, escritor.posicao - 4, restaurado, 1000));
+    assert(memcmp(restaurado, dados + 30000, 1000) == 0);
+
+    // Memória insuficiente é detectada em vez de ultrapassada
+    assert(inicializarEscritorMemoria(&escritor, bloco, 100));
+    compactarBloco(dados + 15000, 1000, &opcoes, &escritor, NULL);
+    finalizarEscritor(&escritor);
+    assert(escritor.estouro);
+    free(dados);
+}
+
+//TESTA OS BLOCOS EM QUATRO SUB-FLUXOS INTERCALADOS, INCLUSIVE COM TAMANHOS QUE NÃO SÃO MÚLTIPLOS DE 4
+static void test_quatroFluxos() {
+    size_t tamanho = 30003;
+    unsigned char *dados = malloc(tamanho), *restaurado = malloc(tamanho);
+    uint8_t *bloco = malloc(tamanho + MARGEM_CABECALHO_BLOCO);
+    uint32_t semente = 7;
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        // Símbolos com probabilidades bem diferentes, para que a árvore passe de BITS_TABELA
+        int nivel = 0;
+        while (nivel < 20 && (semente >> (31 - nivel)) & 1) nivel++;
+        dados[i] = (unsigned char)('a' + nivel);
+    }
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.comprimentoMaximo = 0;
+    opcoes.codificador = CODIFICADOR_HUFFMAN;
+    RelatorioCompactacao relatorio;
+    EscritorBits escritor;
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, &relatorio));
+    finalizarEscritor(&escritor);
+    assert(!escritor.estouro && bloco[0] == BLOCO_HUFFMAN_4);
+    assert(relatorio.comprimentoMaximo == BITS_TABELA);
+
+    LeitorBits leitor;
+    uint64_t tamanhoOriginal, tamanhoCorpo;
+    inicializarLeitorMemoria(&leitor, bloco + 1, escritor.posicao - 1);
+    assert(lerVarint(&leitor, &tamanhoOriginal) && lerVarint(&leitor, &tamanhoCorpo));
+    const uint8_t *corpo = bloco + escritor.posicao - tamanhoCorpo;
+    for (size_t quantidade = tamanho - 3; quantidade <= tamanho; quantidade++) {
+        memset(restaurado, 0, tamanho);
+        assert(descompactarBloco(BLOCO_HUFFMAN_4, corpo, (size_t)tamanhoCorpo, restaurado, quantidade));
+        assert(memcmp(restaurado, dados, quantidade) == 0);
+    }
+    // Sub-fluxos truncados são recusados
+    assert(!descompactarBloco(BLOCO_HUFFMAN_4, corpo, (size_t)tamanhoCorpo - 1, restaurado, tamanho));
+
+    // Blocos pequenos ou com a opção desligada usam um único fluxo
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, TAMANHO_MINIMO_QUATRO_FLUXOS - 1, &opcoes, &escritor, NULL));
+    assert(bloco[0] == BLOCO_HUFFMAN);
+    opcoes.quatroFluxos = 0;
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, NULL));
+    assert(bloco[0] == BLOCO_HUFFMAN);
+
+    opcoes.comprimentoMaximo = COMPRIMENTO_PADRAO;
+    opcoes.tamanhoBloco = 8191;
+    for (int quatroFluxos = 0; quatroFluxos <= 1; quatroFluxos++) {
+        opcoes.quatroFluxos = quatroFluxos;
+        verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+        verificarIdaEVoltaComOpcoes(dados, 4100, &opcoes);
+    }
+    free(dados);
+    free(restaurado);
+    free(bloco);
+}
+
+//TESTA O CODIFICADOR tANS: ESCOLHA AUTOMÁTICA, DECODIFICAÇÃO PARCIAL, CORPO TRUNCADO E TABELAS DE VÁRIOS TAMANHOS
+static void test_tans() {
+    size_t tamanho = 50001;
+    unsigned char *dados = malloc(tamanho), *restaurado = malloc(tamanho);
+    uint8_t *bloco = malloc(tamanho + MARGEM_CABECALHO_BLOCO);
+    uint32_t semente = 11;
+    // Dois símbolos com 90% e 10%: o Huffman gasta um bit por símbolo, o tANS menos da metade
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        dados[i] = (semente >> 16) % 10 ? 'a' : 'b';
+    }
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    RelatorioCompactacao relatorio;
+    EscritorBits escritor;
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, &relatorio));
+    finalizarEscritor(&escritor);
+    assert(!escritor.estouro && bloco[0] == BLOCO_TANS && relatorio.blocosTans == 1);
+    assert(escritor.posicao < tamanho / 16);
+
+    LeitorBits leitor;
+    uint64_t tamanhoOriginal, tamanhoCorpo;
+    inicializarLeitorMemoria(&leitor, bloco + 1, escritor.posicao - 1);
+    assert(lerVarint(&leitor, &tamanhoOriginal) && lerVarint(&leitor, &tamanhoCorpo));
+    const uint8_t *corpo = bloco + escritor.posicao - tamanhoCorpo;
+    for (size_t quantidade = tamanho - 5; quantidade <= tamanho; quantidade++) {
+        memset(restaurado, 0, tamanho);
+        assert(descompactarBloco(BLOCO_TANS, corpo, (size_t)tamanhoCorpo, restaurado, quantidade));
+        assert(memcmp(restaurado, dados, quantidade) == 0);
+    }
+    assert(!descompactarBloco(BLOCO_TANS, corpo, (size_t)tamanhoCorpo / 2, restaurado, tamanho));
+    assert(!descompactarBloco(BLOCO_TANS, corpo, 1, restaurado, tamanho));
+
+    // Com o Huffman escolhido para o arquivo, o tANS não é usado
+    opcoes.codificador = CODIFICADOR_HUFFMAN;
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, &relatorio));
+    assert(bloco[0] == BLOCO_HUFFMAN_4 && relatorio.blocosTans == 0);
+
+    // Todos os bytes presentes: a tabela vai em mapa de bits e blocos pequenos usam tabelas menores
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        dados[i] = (unsigned char)((semente >> 24) & (semente >> 16));
+    }
+    opcoes.tamanhoBloco = 7000;
+    for (int codificador = CODIFICADOR_AUTOMATICO; codificador <= CODIFICADOR_TANS; codificador++) {
+        opcoes.codificador = (CodificadorEntropia)codificador;
+        verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+        verificarIdaEVoltaComOpcoes(dados, 40, &opcoes);
+    }
+    opcoes.codificador = CODIFICADOR_TANS;
+    for (size_t tamanhoBloco = 1; tamanhoBloco <= 300; tamanhoBloco += 37) {
+        opcoes.tamanhoBloco = tamanhoBloco;
+        verificarIdaEVoltaComOpcoes(dados, 2000, &opcoes);
+    }
+
+    free(dados);
+    free(restaurado);
+    free(bloco);
+}
+
+//TESTA O MODO DE ORDEM 1: DADOS QUE DEPENDEM DO BYTE ANTERIOR, DECODIFICAÇÃO PARCIAL E GRUPOS DE UM SÍMBOLO
+static void test_ordem1() {
+    size_t tamanho = 60000;
+    unsigned char *dados = malloc(tamanho), *restaurado = malloc(tamanho);
+    uint8_t *bloco = malloc(tamanho + MARGEM_CABECALHO_BLOCO);
+    uint32_t semente = 5;
+    // Cada byte costuma ser o sucessor do anterior dentro de 16 letras: sem contexto, todas parecem igualmente prováveis
+    unsigned char anterior = 'a';
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        int salto = (semente >> 16) % 8 ? 1 : (int)((semente >> 20) % 16);
+        anterior = (unsigned char)('a' + (anterior - 'a' + salto) % 16);
+        dados[i] = anterior;
+    }
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.ordem1 = 1;
+    RelatorioCompactacao relatorio;
+    EscritorBits escritor;
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, &relatorio));
+    finalizarEscritor(&escritor);
+    assert(!escritor.estouro && bloco[0] == BLOCO_ORDEM1 && relatorio.blocosOrdem1 == 1);
+    // Ordem 0 gasta 4 bits por símbolo; com o contexto, o sucessor mais provável custa um bit
+    assert(escritor.posicao < tamanho * 3 / 8);
+
+    LeitorBits leitor;
+    uint64_t tamanhoOriginal, tamanhoCorpo;
+    inicializarLeitorMemoria(&leitor, bloco + 1, escritor.posicao - 1);
+    assert(lerVarint(&leitor, &tamanhoOriginal) && lerVarint(&leitor, &tamanhoCorpo));
+    const uint8_t *corpo = bloco + escritor.posicao - tamanhoCorpo;
+    for (size_t quantidade = tamanho - 6; quantidade <= tamanho; quantidade++) {
+        memset(restaurado, 0, tamanho);
+        assert(descompactarBloco(BLOCO_ORDEM1, corpo, (size_t)tamanhoCorpo, restaurado, quantidade));
+        assert(memcmp(restaurado, dados, quantidade) == 0);
+    }
+    assert(!descompactarBloco(BLOCO_ORDEM1, corpo, (size_t)tamanhoCorpo / 2, restaurado, tamanho));
+    assert(!descompactarBloco(BLOCO_ORDEM1, corpo, 20, restaurado, tamanho));
+
+    // Sem a opção, o bloco fica em ordem 0
+    opcoes.ordem1 = 0;
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, &relatorio));
+    assert(bloco[0] != BLOCO_ORDEM1 && relatorio.blocosOrdem1 == 0);
+
+    opcoes.ordem1 = 1;
+    opcoes.tamanhoBloco = 9000;
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+
+    // Ciclo de três letras: cada contexto tem um único sucessor, e os grupos ficam com um símbolo só
+    for (size_t i = 0; i < tamanho; i++)
+        dados[i] = (unsigned char)('x' + i % 3);
+    assert(inicializarEscritorMemoria(&escritor, bloco, tamanho + MARGEM_CABECALHO_BLOCO));
+    assert(compactarBloco(dados, tamanho, &opcoes, &escritor, NULL));
+    assert(bloco[0] == BLOCO_ORDEM1);
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        dados[i] = (unsigned char)(semente >> 24);
+    }
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+
+    free(dados);
+    free(restaurado);
+    free(bloco);
+}
+
+//TESTA O DICIONÁRIO TREINADO: MENSAGENS CURTAS SEM TABELA, FALLBACK CRU, ARQUIVO DO DICIONÁRIO E CORRUPÇÃO
+static void test_dicionario() {
+    const char *amostra = "{\"id\": 17, \"evento\": \"login\", \"usuario\": \"ana\"}";
+    const char *nomeAmostra = "amostra_dicionario.json";
+    const char *nomeDicionario = "teste.dic";
+    FILE *f = fopen(nomeAmostra, "wb");
+    for (int i = 0; i < 50; i++) fputs(amostra, f);
+    fclose(f);
+
+    Dicionario dicionario, carregado;
+    char *amostras[] = {(char *)nomeAmostra};
+    assert(treinarDicionario(amostras, 1, &dicionario));
+    // Todo byte tem código, mesmo os que não aparecem nas amostras
+    for (int s = 0; s < TAMANHO_TABELA; s++)
+        assert(dicionario.comprimentos[s] >= 1 && dicionario.comprimentos[s] <= BITS_TABELA);
+    assert(salvarDicionario(nomeDicionario, &dicionario));
+    assert(carregarDicionario(nomeDicionario, &carregado));
+    assert(memcmp(carregado.comprimentos, dicionario.comprimentos, TAMANHO_TABELA) == 0);
+    assert(!carregarDicionario(nomeAmostra, &carregado));
+
+    const char *mensagem = "{\"id\": 4242, \"evento\": \"logout\", \"usuario\": \"bruno\"}";
+    size_t tamanho = strlen(mensagem), compactado, descompactado;
+    uint8_t saida[256], restaurado[256];
+    uint64_t original;
+    assert(compactarMensagem(&carregado, mensagem, tamanho, saida, sizeof(saida), &compactado));
+    assert(compactado < tamanho * 3 / 4 && compactado <= limiteMensagem(tamanho));
+    assert(tamanhoMensagemDescompactada(saida, compactado, &original) && original == tamanho);
+    assert(descompactarMensagem(&dicionario, saida, compactado, restaurado, sizeof(restaurado), &descompactado));
+    assert(descompactado == tamanho && memcmp(restaurado, mensagem, tamanho) == 0);
+    // Saída exata basta, um byte a menos não; capacidade de descompactação pequena demais e corpo truncado falham
+    assert(compactarMensagem(&dicionario, mensagem, tamanho, saida, compactado, &compactado));
+    assert(!compactarMensagem(&dicionario, mensagem, tamanho, saida, compactado - 1, &compactado));
+    assert(!descompactarMensagem(&dicionario, saida, compactado, restaurado, tamanho - 1, &descompactado));
+    assert(!descompactarMensagem(&dicionario, saida, compactado / 2, restaurado, sizeof(restaurado), &descompactado));
+
+    // Todos os prefixos da mensagem, inclusive o vazio, e bytes que o dicionário codifica mal vão crus
+    for (size_t parte = 0; parte <= tamanho; parte++) {
+        assert(compactarMensagem(&dicionario, mensagem, parte, saida, limiteMensagem(parte), &compactado));
+        assert(descompactarMensagem(&dicionario, saida, compactado, restaurado, parte, &descompactado));
+        assert(descompactado == parte && memcmp(restaurado, mensagem, parte) == 0);
+    }
+    uint8_t estranhos[40];
+    for (int i = 0; i < 40; i++) estranhos[i] = (uint8_t)(200 + i);
+    assert(compactarMensagem(&dicionario, estranhos, 40, saida, limiteMensagem(40), &compactado));
+    assert(compactado == 41 && saida[0] == 80);
+    assert(descompactarMensagem(&dicionario, saida, compactado, restaurado, 40, &descompactado));
+    assert(descompactado == 40 && memcmp(restaurado, estranhos, 40) == 0);
+    assert(!descompactarMensagem(&dicionario, saida, compactado - 1, restaurado, 40, &descompactado));
+
+    remove(nomeAmostra);
+    remove(nomeDicionario);
+}
+
+//TESTA A COMPACTAÇÃO DE MEMÓRIA PARA MEMÓRIA, COM O LIMITE DO PIOR CASO E SAÍDAS PEQUENAS DEMAIS
+static void test_compactarMemoria() {
+    size_t tamanho = 70001;
+    unsigned char *dados = malloc(tamanho), *restaurado = malloc(tamanho);
+    uint32_t semente = 11;
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        dados[i] = i < 40000 ? (unsigned char)("memoria "[i % 8]) : (unsigned char)(semente >> 24);
+    }
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 5000;
+    size_t tamanhos[] = {0, 1, 3, 4096, tamanho};
+    for (int indice = 0; indice <= 1; indice++) {
+        opcoes.indice = indice;
+        for (int t = 0; t < 5; t++) {
+            for (int threads = 1; threads <= 3; threads += 2) {
+                opcoes.threads = threads;
+                size_t limite = limiteCompactacao(tamanhos[t], &opcoes), compactado, descompactado;
+                uint8_t *saida = malloc(limite);
+                uint64_t original;
+                assert(compactarMemoria(dados, tamanhos[t], saida, limite, &compactado, &opcoes));
+                assert(compactado <= limite);
+                assert(tamanhoDescompactadoMemoria(saida, compactado, &original) && original == tamanhos[t]);
+                assert(descompactarMemoria(saida, compactado, restaurado, tamanho, &descompactado, &opcoes));
+                assert(descompactado == tamanhos[t] && memcmp(restaurado, dados, descompactado) == 0);
+
+                // Exatamente o tamanho da saída basta; um byte a menos não
+                assert(compactarMemoria(dados, tamanhos[t], saida, compactado, &compactado, &opcoes));
+                assert(!compactarMemoria(dados, tamanhos[t], saida, compactado - 1, &compactado, &opcoes));
+                if (tamanhos[t] > 0)
+                    assert(!descompactarMemoria(saida, compactado, restaurado, tamanhos[t] - 1, &descompactado, NULL));
+                // Sem o marcador de fim a entrada está truncada
+                if (!indice)
+                    assert(!descompactarMemoria(saida, compactado - 1, restaurado, tamanho, &descompactado, NULL));
+                free(saida);
+            }
+        }
+    }
+
+    // Dados aleatórios atingem o limite do pior caso sem passar dele
+    size_t limite = limiteCompactacao(30000, NULL), compactado;
+    uint8_t *saida = malloc(limite);
+    assert(compactarMemoria(dados + 40000, 30000, saida, limite, &compactado, NULL));
+    assert(compactado <= limite && compactado > 30000);
+    free(saida);
+
+    // Só o formato em blocos é produzido em memória
+    opcoes.formato = FORMATO_CANONICO;
+    assert(!compactarMemoria(dados, tamanho, restaurado, tamanho, &compactado, &opcoes));
+    free(dados);
+    free(restaurado);
+}
+
+//TESTA A LEITURA DE INTERVALOS COM O ÍNDICE NO RODAPÉ E PERCORRENDO OS CABEÇALHOS DOS BLOCOS
+static void test_descompactarIntervalo() {
+    size_t tamanho = 50000;
+    unsigned char *dados = malloc(tamanho), *lido = malloc(tamanho);
+    uint32_t semente = 777;
+    for (size_t i = 0; i < tamanho; i++) {
+        semente = semente * 1103515245u + 12345u;
+        dados[i] = (i / 7000) % 2 ? (unsigned char)(semente >> 24) : (unsigned char)('a' + (semente >> 28));
+    }
+    const char *original = "intervalo.txt";
+    const char *compactado = "intervalo.huff";
+    FILE *f = fopen(original, "wb");
+    assert(f != NULL);
+    fwrite(dados, 1, tamanho, f);
+    fclose(f);
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 1000;
+    for (opcoes.indice = 1; opcoes.indice >= 0; opcoes.indice--) {
+        assert(compactarHuffmanComOpcoes(original, compactado, &opcoes));
+        FILE *g = fopen(compactado, "rb");
+        assert(g != NULL);
+
+        IndiceBlocos indice;
+        assert(lerIndiceBlocos(g, &indice));
+        assert(indice.quantidadeBlocos == 50);
+        assert(indice.entradas[0].posicaoCompactada == 2);
+        assert(indice.entradas[50].posicaoOriginal == tamanho);
+        liberarIndiceBlocos(&indice);
+
+        const size_t intervalos[][2] = {{0, 10}, {999, 2}, {12345, 20000}, {0, 50000}, {49990, 100}, {50000, 1}};
+        for (int i = 0; i < 6; i++) {
+            size_t inicio = intervalos[i][0], pedidos = intervalos[i][1];
+            size_t esperados = inicio >= tamanho ? 0 : (pedidos < tamanho - inicio ? pedidos : tamanho - inicio);
+            assert(descompactarIntervalo(g, inicio, pedidos, lido) == esperados);
+            assert(memcmp(lido, dados + inicio, esperados) == 0);
+        }
+        fclose(g);
+    }
+
+    // Com o rodapé a descompactação completa continua igual
+    opcoes.indice = 1;
+    verificarIdaEVoltaComOpcoes(dados, tamanho, &opcoes);
+    verificarIdaEVoltaComOpcoes(dados, 0, &opcoes);
+    remove(original);
+    remove(compactado);
+    free(dados);
+    free(lido);
+}
+
+//LÊ UM ARQUIVO INTEIRO PARA A MEMÓRIA
+static unsigned char *lerArquivoInteiro(const char *nome, size_t *tamanho) {
+    FILE *f = fopen(nome, "rb");
+    assert(f != NULL);
+    fseek(f, 0, SEEK_END);
+    *tamanho = (size_t)ftell(f);
+    rewind(f);
+    unsigned char *dados = malloc(*tamanho + 1);
+    assert(fread(dados, 1, *tamanho, f) == *tamanho);
+    fclose(f);
+    return dados;
+}
+
+//TESTA QUE A ENTRADA MAPEADA GERA OS MESMOS BYTES QUE A LEITURA COM BUFFER E QUE PIPES NÃO SÃO MAPEADOS
+static void test_mapearArquivo() {
+    const char *original = "mapeado.txt";
+    FILE *f = fopen(original, "wb");
+    assert(f != NULL);
+    for (int i = 0; i < 30000; i++)
+        fputc("abracadabra"[i % 11] + (i % 97 == 0), f);
+    fclose(f);
+
+    FILE *g = fopen(original, "rb");
+    assert(g != NULL);
+    MapeamentoArquivo mapeamento;
+    fseek(g, 100, SEEK_SET);
+    assert(mapearArquivo(g, &mapeamento));
+    assert(mapeamento.tamanho == 29900 && mapeamento.dados[0] == "abracadabra"[100 % 11]);
+    desmapearArquivo(&mapeamento);
+    fclose(g);
+
+    const FormatoArquivo formatos[] = {FORMATO_ARVORE, FORMATO_CANONICO, FORMATO_BLOCOS};
+    for (int i = 0; i < 3; i++) {
+        OpcoesCompactacao opcoes;
+        opcoesPadrao(&opcoes);
+        opcoes.formato = formatos[i];
+        opcoes.tamanhoBloco = 4096;
+        size_t tamanhoMapeado, tamanhoLido;
+        assert(compactarHuffmanComOpcoes(original, "mapeado.huff", &opcoes));
+        unsigned char *mapeado = lerArquivoInteiro("mapeado.huff", &tamanhoMapeado);
+        opcoes.mapearEntrada = 0;
+        assert(compactarHuffmanComOpcoes(original, "mapeado.huff", &opcoes));
+        unsigned char *lido = lerArquivoInteiro("mapeado.huff", &tamanhoLido);
+        assert(tamanhoMapeado == tamanhoLido && memcmp(mapeado, lido, tamanhoLido) == 0);
+        free(mapeado);
+        free(lido);
+    }
+
+    int descritores[2];
+    assert(pipe(descritores) == 0);
+    FILE *leitura = fdopen(descritores[0], "rb");
+    assert(!mapearArquivo(leitura, &mapeamento));
+    fclose(leitura);
+    close(descritores[1]);
+    remove(original);
+    remove("mapeado.huff");
+}
+
+//TESTA A COMPACTAÇÃO E A DESCOMPACTAÇÃO ENTRE PIPES, QUE NÃO ACEITAM fseek
+static void test_fluxo() {
+    unsigned char dados[20000], lido[20001];
+    for (size_t i = 0; i < sizeof(dados); i++)
+        dados[i] = (unsigned char)("o rato roeu a roupa"[i % 19] ^ (i % 1000 == 0));
+
+    int original[2], compactado[2], restaurado[2];
+    assert(pipe(original) == 0 && pipe(compactado) == 0 && pipe(restaurado) == 0);
+    assert(write(original[1], dados, sizeof(dados)) == (ssize_t)sizeof(dados));
+    close(original[1]);
+
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 4096;
+    opcoes.threads = 2;
+    FILE *entrada = fdopen(original[0], "rb"), *saida = fdopen(compactado[1], "wb");
+    assert(compactarFluxo(entrada, saida, &opcoes));
+    fclose(entrada);
+    fclose(saida);
+
+    entrada = fdopen(compactado[0], "rb");
+    saida = fdopen(restaurado[1], "wb");
+    assert(descompactarFluxo(entrada, saida, &opcoes));
+    fclose(entrada);
+    fclose(saida);
+
+    FILE *resultado = fdopen(restaurado[0], "rb");
+    assert(fread(lido, 1, sizeof(lido), resultado) == sizeof(dados));
+    assert(memcmp(lido, dados, sizeof(dados)) == 0);
+    fclose(resultado);
+}
+
+//TESTA O MODO EM PIPELINE: MESMA SAÍDA DO MODO EM LOTES, FILAS LIMITADAS E LEITURA DE PIPES
+static void test_pipeline() {
+    size_t tamanho = 100000, tamanhoLotes, tamanhoPipeline;
+    unsigned char *dados = malloc(tamanho);
+    for (size_t i = 0; i < tamanho; i++)
+        dados[i] = (unsigned char)("a vaca foi pro brejo "[i % 21] + (i % 4001 == 0));
+    FILE *f = fopen("pipeline.txt", "wb");
+    fwrite(dados, 1, tamanho, f);
+    fclose(f);
+
+    OpcoesCompactacao opcoes;
+    EstatisticasPipeline estatisticas;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 4096;
+    opcoes.indice = 1;
+    for (int threads = 1; threads <= 3; threads += 2) {
+        opcoes.threads = threads;
+        opcoes.pipeline = 0;
+        assert(compactarHuffmanComOpcoes("pipeline.txt", "pipeline_lotes.huff", &opcoes));
+        opcoes.pipeline = 1;
+        opcoes.estatisticasPipeline = &estatisticas;
+        assert(compactarHuffmanComOpcoes("pipeline.txt", "pipeline.huff", &opcoes));
+        assert(estatisticas.blocos == (tamanho + 4095) / 4096);
+        assert(estatisticas.capacidadeFila == 2 * threads + 2);
+        assert(estatisticas.maximoFilaProcessamento <= estatisticas.capacidadeFila);
+        assert(estatisticas.maximoFilaGravacao <= estatisticas.capacidadeFila);
+
+        unsigned char *lotes = lerArquivoInteiro("pipeline_lotes.huff", &tamanhoLotes);
+        unsigned char *pipeline = lerArquivoInteiro("pipeline.huff", &tamanhoPipeline);
+        assert(tamanhoLotes == tamanhoPipeline && memcmp(lotes, pipeline, tamanhoLotes) == 0);
+        free(lotes);
+        free(pipeline);
+
+        assert(descompactarHuffmanComOpcoes("pipeline.huff", "pipeline.out", &opcoes));
+        assert(estatisticas.blocos == (tamanho + 4095) / 4096);
+        size_t tamanhoRestaurado;
+        unsigned char *restaurado = lerArquivoInteiro("pipeline.out", &tamanhoRestaurado);
+        assert(tamanhoRestaurado == tamanho && memcmp(restaurado, dados, tamanho) == 0);
+        free(restaurado);
+    }
+
+    // Um bloco corrompido interrompe o pipeline sem travar as threads
+    f = fopen("pipeline.huff", "r+b");
+    fseek(f, 2, SEEK_SET);
+    fputc(0xFF, f);
+    fclose(f);
+    f = fopen("pipeline.huff", "rb");
+    FILE *descarte = fopen("pipeline.out", "wb");
+    assert(!descompactarFluxo(f, descarte, &opcoes));
+    fclose(f);
+    fclose(descarte);
+
+    // Em pipes o pread falha e a leitura passa a ser sequencial
+    int original[2];
+    assert(pipe(original) == 0);
+    assert(write(original[1], dados, 30000) == 30000);
+    close(original[1]);
+    FILE *entrada = fdopen(original[0], "rb"), *saida = fopen("pipeline.huff", "wb");
+    assert(compactarFluxo(entrada, saida, &opcoes));
+    fclose(entrada);
+    fclose(saida);
+    assert(estatisticas.blocos == (30000 + 4095) / 4096);
+    assert(descompactarHuffmanComOpcoes("pipeline.huff", "pipeline.out", &opcoes));
+    size_t tamanhoRestaurado;
+    unsigned char *restaurado = lerArquivoInteiro("pipeline.out", &tamanhoRestaurado);
+    assert(tamanhoRestaurado == 30000 && memcmp(restaurado, dados, 30000) == 0);
+    free(restaurado);
+
+    // Erro de leitura (um diretório aberto como arquivo) falha nos dois caminhos, não vira fim de arquivo
+    for (int comPipeline = 0; comPipeline <= 1; comPipeline++) {
+        opcoes.pipeline = comPipeline;
+        entrada = fopen(".", "rb");
+        saida = fopen("pipeline.huff", "wb");
+        assert(entrada && saida);
+        assert(!compactarFluxo(entrada, saida, &opcoes));
+        fclose(entrada);
+        fclose(saida);
+    }
+
+    remove("pipeline.txt");
+    remove("pipeline_lotes.huff");
+    remove("pipeline.huff");
+    remove("pipeline.out");
+    free(dados);
+}
+
+//TESTA AS ESTATÍSTICAS DE CADA FORMATO E A LINHA JSON
+static void test_estatisticas() {
+    size_t tamanho = 60000, tamanhoCompactado;
+    unsigned char *dados = malloc(tamanho);
+    for (size_t i = 0; i < tamanho; i++)
+        dados[i] = (unsigned char)("aaaabbc"[(i * 7 + i / 13) % 7] + (i % 997 == 0));
+    FILE *f = fopen("estatisticas.txt", "wb");
+    fwrite(dados, 1, tamanho, f);
+    fclose(f);
+
+    OpcoesCompactacao opcoes;
+    EstatisticasCodec estatisticas;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 16384;
+    opcoes.threads = 2;
+    opcoes.estatisticas = &estatisticas;
+    FormatoArquivo formatos[] = {FORMATO_ARVORE, FORMATO_CANONICO, FORMATO_BLOCOS};
+    for (int i = 0; i < 3; i++) {
+        opcoes.formato = formatos[i];
+        assert(compactarHuffmanComOpcoes("estatisticas.txt", "estatisticas.huff", &opcoes));
+        unsigned char *compactado = lerArquivoInteiro("estatisticas.huff", &tamanhoCompactado);
+        free(compactado);
+        assert(estatisticas.bytesEntrada == tamanho && estatisticas.simbolos == tamanho);
+        assert(estatisticas.bytesSaida == tamanhoCompactado);
+        // Códigos de Huffman ficam a menos de um bit por símbolo da entropia, por bloco ou no arquivo todo
+        double entropia = estatisticas.bitsEntropia / tamanho;
+        double medio = (double)estatisticas.bitsCodificados / tamanho;
+        assert(entropia > 1 && entropia < 3 && medio >= entropia - 1e-3 && medio < entropia + 1);
+        assert(estatisticas.profundidadeMaxima >= 3 && estatisticas.profundidadeMaxima <= COMPRIMENTO_MAXIMO_CODIGO);
+        double fases = 0;
+        for (int fase = 0; fase < TOTAL_FASES; fase++)
+            fases += estatisticas.segundosFase[fase];
+        assert(fases > 0 && estatisticas.segundos > 0);
+        assert(estatisticas.segundosFase[FASE_DECODIFICACAO] == 0);
+
+        assert(descompactarHuffmanComOpcoes("estatisticas.huff", "estatisticas.out", &opcoes));
+        assert(estatisticas.bytesEntrada == tamanhoCompactado && estatisticas.bytesSaida == tamanho);
+        assert(estatisticas.simbolos == 0 && estatisticas.segundosFase[FASE_CODIFICACAO] == 0);
+        assert(estatisticas.segundosFase[FASE_DECODIFICACAO] > 0);
+    }
+
+    // Em pipes e em /dev/null a posição da saída não serve; o tamanho precisa vir da contagem dos bytes gravados
+    const char *saidas[] = {"/dev/null", "cat > estatisticas.pipe"};
+    for (int i = 0; i < 3; i++) {
+        opcoes.formato = formatos[i];
+        assert(compactarHuffmanComOpcoes("estatisticas.txt", "estatisticas.huff", &opcoes));
+        free(lerArquivoInteiro("estatisticas.huff", &tamanhoCompactado));
+        for (int s = 0; s < 2; s++) {
+            FILE *entrada = fopen("estatisticas.huff", "rb");
+            FILE *saida = s == 0 ? fopen(saidas[s], "wb") : popen(saidas[s], "w");
+            assert(entrada != NULL && saida != NULL);
+            assert(descompactarFluxo(entrada, saida, &opcoes));
+            fclose(entrada);
+            if (s == 0) {
+                fclose(saida);
+            } else {
+                assert(pclose(saida) == 0);
+                size_t tamanhoPipe;
+                free(lerArquivoInteiro("estatisticas.pipe", &tamanhoPipe));
+                assert(tamanhoPipe == tamanho);
+            }
+            assert(estatisticas.bytesEntrada == tamanhoCompactado && estatisticas.bytesSaida == tamanho);
+        }
+    }
+
+    // A compactação em fluxo conta também o índice, quando ele é gravado
+    opcoes.formato = FORMATO_BLOCOS;
+    for (opcoes.indice = 0; opcoes.indice <= 1; opcoes.indice++) {
+        uint64_t tamanhos[2];
+        for (int s = 0; s < 2; s++) {
+            FILE *entrada = fopen("estatisticas.txt", "rb");
+            FILE *saida = s == 0 ? fopen(saidas[s], "wb") : popen(saidas[s], "w");
+            assert(entrada != NULL && saida != NULL);
+            assert(compactarFluxo(entrada, saida, &opcoes));
+            fclose(entrada);
+            tamanhos[s] = estatisticas.bytesSaida;
+            if (s == 0) {
+                fclose(saida);
+            } else {
+                assert(pclose(saida) == 0);
+                size_t tamanhoPipe;
+                free(lerArquivoInteiro("estatisticas.pipe", &tamanhoPipe));
+                assert(tamanhos[s] == tamanhoPipe);
+            }
+        }
+        assert(tamanhos[0] == tamanhos[1] && tamanhos[0] > 0);
+    }
+    opcoes.indice = 0;
+
+    // Na memória, a entrada e a saída são os próprios trechos
+    size_t limite = limiteCompactacao(tamanho, &opcoes), tamanhoSaida;
+    unsigned char *memoria = malloc(limite), *restaurado = malloc(tamanho);
+    assert(compactarMemoria(dados, tamanho, memoria, limite, &tamanhoSaida, &opcoes));
+    assert(estatisticas.bytesEntrada == tamanho && estatisticas.bytesSaida == tamanhoSaida);
+    assert(descompactarMemoria(memoria, tamanhoSaida, restaurado, tamanho, &tamanhoCompactado, &opcoes));
+    assert(estatisticas.bytesEntrada == tamanhoSaida && estatisticas.bytesSaida == tamanho);
+    free(memoria);
+    free(restaurado);
+
+    // Uma linha JSON com o nome escapado; sem símbolos contados, as médias saem como null
+    f = fopen("estatisticas.json", "w");
+    escreverEstatisticasJson(f, "descompactar", "a\"b", &estatisticas);
+    fclose(f);
+    size_t tamanhoJson;
+    char *json = (char *)lerArquivoInteiro("estatisticas.json", &tamanhoJson);
+    json[tamanhoJson] = '\0';
+    const char *inicio = "{\"operacao\":\"descompactar\",\"arquivo\":\"a\\\"b\",";
+    assert(strncmp(json, inicio, strlen(inicio)) == 0);
+    assert(strstr(json, "\"comprimento_medio\":null") && strstr(json, "\"fases\":{\"leitura\":"));
+    assert(tamanhoJson > 2 && memchr(json, '\n', tamanhoJson) == json + tamanhoJson - 1);
+    assert(strcmp(json + tamanhoJson - 3, "}}\n") == 0);
+    free(json);
+
+    remove("estatisticas.txt");
+    remove("estatisticas.huff");
+    remove("estatisticas.out");
+    remove("estatisticas.json");
+    remove("estatisticas.pipe");
+    free(dados);
+}
+
+//TESTA O PACOTE: ENTRADAS EM ORDEM DE NOME, EXTRAÇÃO DE UMA SÓ ENTRADA E DE TODAS, E PACOTES TRUNCADOS
+static void test_pacote() {
+    const char *nomes[] = {"pacote_dir/a.txt", "pacote_dir/sub/b.txt", "pacote_dir/sub/grande.bin", "pacote_dir/vazio"};
+    const size_t tamanhos[] = {3000, 777, 70000, 0};
+    unsigned char *conteudos[4];
+    assert(mkdir("pacote_dir", 0777) == 0 && mkdir("pacote_dir/sub", 0777) == 0);
+    uint32_t semente = 99;
+    for (int i = 0; i < 4; i++) {
+        conteudos[i] = malloc(tamanhos[i] + 1);
+        for (size_t j = 0; j < tamanhos[i]; j++) {
+            semente = semente * 1103515245u + 12345u;
+            conteudos[i][j] = i == 2 && j % 5000 < 2500 ? (unsigned char)(semente >> 24) : (unsigned char)("xyz"[j % 3]);
+        }
+        FILE *f = fopen(nomes[i], "wb");
+        assert(f != NULL);
+        fwrite(conteudos[i], 1, tamanhos[i], f);
+        fclose(f);
+    }
+
+    // Com blocos de 4 KiB, só grande.bin passa do limite das entradas compactadas na memória;
+    // o arquivo pedido duas vezes entra uma vez só
+    OpcoesCompactacao opcoes;
+    opcoesPadrao(&opcoes);
+    opcoes.tamanhoBloco = 4096;
+    opcoes.threads = 2;
+    char *caminhos[] = {"pacote_dir", "./pacote_dir/a.txt"};
+    assert(criarPacote("teste.hpak", caminhos, 2, &opcoes));
+
+    FILE *pacote = fopen("teste.hpak", "rb");
+    assert(pacote != NULL);
+    DiretorioPacote diretorio;
+    assert(lerDiretorioPacote(pacote, &diretorio));
+    assert(diretorio.quantidade == 4);
+    assert(diretorio.entradas[0].posicao == strlen(ASSINATURA_PACOTE));
+    for (int i = 0; i < 4; i++) {
+        assert(strcmp(diretorio.entradas[i].nome, nomes[i]) == 0);
+        assert(diretorio.entradas[i].tamanhoOriginal == tamanhos[i]);
+    }
+    assert(buscarEntradaPacote(&diretorio, "pacote_dir/ausente") == NULL);
+
+    // Uma entrada sozinha, pela posição no diretório
+    const EntradaPacote *entrada = buscarEntradaPacote(&diretorio, "pacote_dir/sub/b.txt");
+    assert(entrada == &diretorio.entradas[1]);
+    FILE *saida = fopen("pacote_b.txt", "wb");
+    assert(extrairEntradaPacote(pacote, entrada, saida, &opcoes));
+    fclose(saida);
+    size_t tamanho;
+    unsigned char *lido = lerArquivoInteiro("pacote_b.txt", &tamanho);
+    assert(tamanho == tamanhos[1] && memcmp(lido, conteudos[1], tamanho) == 0);
+    free(lido);
+    liberarDiretorioPacote(&diretorio);
+    fclose(pacote);
+
+    // Todas as entradas, dentro do destino
+    assert(extrairPacote("teste.hpak", "pacote_out", NULL, 0, &opcoes));
+    char caminho[128];
+    for (int i = 0; i < 4; i++) {
+        sprintf(caminho, "pacote_out/%s", nomes[i]);
+        lido = lerArquivoInteiro(caminho, &tamanho);
+        assert(tamanho == tamanhos[i] && memcmp(lido, conteudos[i], tamanho) == 0);
+        free(lido);
+    }
+    char *ausente[] = {"pacote_dir/ausente"};
+    assert(!extrairPacote("teste.hpak", "pacote_out", ausente, 1, &opcoes));
+
+    // Um caminho que não pode ser lido desfaz o pacote e fica registrado para a mensagem de erro
+    FalhaPacote falha;
+    opcoes.falhaPacote = &falha;
+    char *faltando[] = {"pacote_dir/sub", "pacote_dir/ausente"};
+    assert(!criarPacote("falha.hpak", faltando, 2, &opcoes));
+    assert(strcmp(falha.caminho, "pacote_dir/ausente") == 0 && falha.codigo == ENOENT);
+    assert(fopen("falha.hpak", "rb") == NULL);
+    opcoes.falhaPacote = NULL;
+
+    // Sem o último byte do rodapé, o arquivo não é mais um pacote
+    unsigned char *bytes = lerArquivoInteiro("teste.hpak", &tamanho);
+    FILE *truncado = fopen("truncado.hpak", "wb");
+    fwrite(bytes, 1, tamanho - 1, truncado);
+    fclose(truncado);
+    truncado = fopen("truncado.hpak", "rb");
+    assert(!lerDiretorioPacote(truncado, &diretorio));
+    fclose(truncado);
+    free(bytes);
+
+    for (int i = 0; i < 4; i++) {
+        sprintf(caminho, "pacote_out/%s", nomes[i]);
+        remove(caminho);
+        remove(nomes[i]);
+        free(conteudos[i]);
+    }
+    rmdir("pacote_out/pacote_dir/sub");
+    rmdir("pacote_out/pacote_dir");
+    rmdir("pacote_out");
+    rmdir("pacote_dir/sub");
+    rmdir("pacote_dir");
+    remove("pacote_b.txt");
+    remove("teste.hpak");
+    remove("truncado.hpak");
 }
 
 //TESTA A GERAÇÃO DE NOME DE ARQUIVO COM .HUFF
@@ -121,8 +1212,30 @@ int main() {
     test_criarFolha();
     test_criarNoInterno();
     test_contarFrequencias();
+    test_acumularFrequencias();
     test_construirArvoreHuffman_e_gerarCodigos();
+    test_construirArvoreHuffman_naArena();
+    test_gerarCodigosInteiros();
+    test_escreverCodigo();
     test_escreverArvore();
+    test_construirTabelaDecodificacao();
+    test_decodificarBits();
+    test_gerarCodigosCanonicos();
+    test_calcularComprimentosLimitados();
+    test_escreverComprimentos();
+    test_formatoCanonico();
+    test_formatoBlocos();
+    test_quatroFluxos();
+    test_tans();
+    test_ordem1();
+    test_compactarMemoria();
+    test_dicionario();
+    test_descompactarIntervalo();
+    test_mapearArquivo();
+    test_fluxo();
+    test_pipeline();
+    test_estatisticas();
+    test_pacote();
     test_gerarNomeArquivoComExtensaoHuff();
     printf("Todos os testes passaram!\n");
     return 0;
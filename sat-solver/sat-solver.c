@@ -3,13 +3,22 @@
 #include <string.h>
 #include <stdbool.h>
 
-// Nó de uma árvore binária para representar decisões de atribuição
-typedef struct NoArvore
-{
-    int indice_variavel;       // Índice da variável (0-based)
-    struct NoArvore *esquerda; // Subárvore para valor 1
-    struct NoArvore *direita;  // Subárvore para valor 0
-} NoArvore;
+// Fator de decaimento das atividades das variáveis e das cláusulas aprendidas a cada conflito
+#define DECAIMENTO_ATIVIDADE 0.95
+#define DECAIMENTO_CLAUSULA 0.999
+
+// Reinícios: Luby multiplica a sequência por INTERVALO_LUBY conflitos; o critério do glucose compara as médias
+// rápida e lenta do LBD das cláusulas aprendidas
+#define INTERVALO_LUBY 100
+#define PESO_MEDIA_RAPIDA (1.0 / 32)
+#define PESO_MEDIA_LENTA 1e-4
+#define MARGEM_REINICIO_LBD 1.25
+#define CONFLITOS_MINIMOS_REINICIO 50
+
+// A primeira redução das cláusulas aprendidas vem depois de PRIMEIRA_REDUCAO conflitos, e o intervalo entre
+// reduções cresce INCREMENTO_REDUCAO a cada vez
+#define PRIMEIRA_REDUCAO 2000
+#define INCREMENTO_REDUCAO 300
 
 // Estrutura para armazenar fórmula na forma CNF
 typedef struct
@@ -19,29 +28,6 @@ typedef struct
     int num_variaveis;    // Número de variáveis na fórmula
 } FormulaCNF;
 
-// Cria árvore de decisão com todas as combinações possíveis
-NoArvore *criar_arvore(int profundidade, int num_variaveis)
-{
-    if (profundidade >= num_variaveis)
-        return NULL;
-
-    NoArvore *no = malloc(sizeof(*no));
-    no->indice_variavel = profundidade;
-    no->esquerda = criar_arvore(profundidade + 1, num_variaveis); // Valor 1
-    no->direita = criar_arvore(profundidade + 1, num_variaveis);  // Valor 0
-    return no;
-}
-
-// Libera recursivamente a memória da árvore
-void liberar_arvore(NoArvore *no)
-{
-    if (!no)
-        return;
-    liberar_arvore(no->esquerda);
-    liberar_arvore(no->direita);
-    free(no);
-}
-
 // Verifica se todas as cláusulas estão satisfeitas
 bool formula_satisfeita(const FormulaCNF *formula, int atribuicao[])
 {
@@ -73,37 +59,816 @@ bool formula_satisfeita(const FormulaCNF *formula, int atribuicao[])
     return true;
 }
 
-// Explora a árvore de decisão usando DFS (primeiro esquerda, depois direita)
-bool gerar_com_arvore(
-    NoArvore *no_atual,
-    int atribuicao[],
-    const FormulaCNF *formula,
-    bool *solucao_encontrada)
+// Cláusulas que vigiam um literal, visitadas quando ele fica falso
+typedef struct
+{
+    int *clausulas;
+    int tamanho;
+    int capacidade;
+} ListaVigias;
+
+// Heap binário de variáveis por atividade, com a posição de cada variável para atualizá-la em O(log n)
+typedef struct
 {
-    if (*solucao_encontrada)
-        return true;
+    int *variaveis;
+    int *posicao;             // Posição de cada variável em 'variaveis'; -1 fora do heap
+    int tamanho;
+} HeapVariaveis;
 
-    // Folha da árvore: testa atribuição completa
-    if (no_atual == NULL)
+// Quando a busca CDCL volta ao nível 0
+typedef enum
+{
+    REINICIO_NENHUM,
+    REINICIO_LUBY,
+    REINICIO_LBD
+} PoliticaReinicio;
+
+// Estado da busca DPLL ou CDCL: atribuição parcial e trilha com os literais na ordem em que foram atribuídos
+typedef struct
+{
+    FormulaCNF *formula;      // As cláusulas têm os dois literais vigiados nas posições 0 e 1; as aprendidas vêm no fim
+    int capacidade_clausulas;
+    int *atribuicao;          // Valor de cada variável: -1 indefinida, 0 ou 1
+    int *trilha;              // Literais verdadeiros, do primeiro ao último atribuído
+    int tamanho_trilha;
+    int propagados;           // Literais da trilha cujas vigias já foram visitadas
+    ListaVigias *vigias;      // Uma lista por literal, indexada por indice_literal
+    int *inicio_nivel;        // Posição da trilha onde começa cada nível de decisão (nível 0 = sem decisões)
+    bool *decisao_invertida;  // Se a decisão do nível já é o segundo valor tentado
+    int nivel;
+    int *nivel_variavel;      // Nível em que cada variável recebeu valor
+    int *razao;               // Cláusula que propagou cada variável, com ela na posição 0; -1 para decisões
+    bool *visto;              // Marcas da análise de conflitos, sempre limpas entre análises
+    int *aprendida;           // Cláusula em construção na análise
+    int *pilha;               // Literais pendentes na minimização
+    int *limpeza;             // Literais marcados na análise, a desmarcar no fim
+    int tamanho_limpeza;
+    double *atividade;        // Participação recente de cada variável em conflitos
+    double incremento_atividade;
+    HeapVariaveis heap;       // Variáveis candidatas a decisão; as que têm valor saem dele só quando escolhidas
+    bool *fase_salva;         // Último valor de cada variável, usado na próxima decisão sobre ela
+    int num_originais;        // Cláusulas da fórmula; as de índice maior são aprendidas
+    int *lbd_clausula;        // LBD de cada cláusula aprendida ao ser criada
+    double *atividade_clausula;
+    double incremento_clausula;
+    int *marca_nivel;         // Carimbos por nível para o cálculo do LBD
+    int carimbo_nivel;
+    PoliticaReinicio politica_reinicio;
+    bool reduzir;             // Se as cláusulas aprendidas são reduzidas periodicamente
+    long conflitos;
+    long conflitos_desde_reinicio;
+    long reinicios;
+    long reducoes;
+    long proxima_reducao;
+    long intervalo_reducao;
+    double media_lbd_rapida;
+    double media_lbd_lenta;
+} Solucionador;
+
+// Posição do literal nas listas de vigias: 2 * variável para x e 2 * variável + 1 para -x
+int indice_literal(int literal)
+{
+    return 2 * (abs(literal) - 1) + (literal < 0);
+}
+
+// Acrescenta a cláusula às vigias do literal
+void adicionar_vigia(ListaVigias *vigias, int indice_clausula)
+{
+    if (vigias->tamanho >= vigias->capacidade)
     {
-        if (formula_satisfeita(formula, atribuicao))
-            *solucao_encontrada = true;
-        return *solucao_encontrada;
+        vigias->capacidade = vigias->capacidade == 0 ? 4 : vigias->capacidade * 2;
+        vigias->clausulas = realloc(vigias->clausulas, sizeof(int) * vigias->capacidade);
     }
+    vigias->clausulas[vigias->tamanho++] = indice_clausula;
+}
 
-    int indice_variavel = no_atual->indice_variavel;
+// Remove literais repetidos da cláusula, no próprio vetor; retorna false se ela tiver x e -x, sendo sempre verdadeira
+bool normalizar_clausula(int *clausula, int marcas[], int carimbo)
+{
+    int tamanho = 0;
+    bool tautologia = false;
+    for (int indice = 0; clausula[indice] != 0; indice++)
+    {
+        int literal = clausula[indice];
+        if (marcas[indice_literal(-literal)] == carimbo)
+            tautologia = true;
+        if (marcas[indice_literal(literal)] == carimbo)
+            continue;
+        marcas[indice_literal(literal)] = carimbo;
+        clausula[tamanho++] = literal;
+    }
+    clausula[tamanho] = 0;
+    return !tautologia;
+}
 
-    // Explora atribuição 1 (subárvore esquerda)
-    atribuicao[indice_variavel] = 1;
-    gerar_com_arvore(no_atual->esquerda, atribuicao, formula, solucao_encontrada);
-    if (*solucao_encontrada)
-        return true;
+// Diz se a variável 'a' deve sair do heap antes de 'b': maior atividade e, no empate, menor índice
+bool variavel_antes(const double atividade[], int a, int b)
+{
+    return atividade[a] > atividade[b] || (atividade[a] == atividade[b] && a < b);
+}
 
-    // Explora atribuição 0 (subárvore direita)
-    atribuicao[indice_variavel] = 0;
-    gerar_com_arvore(no_atual->direita, atribuicao, formula, solucao_encontrada);
+// Sobe a variável da posição informada até o pai não ter prioridade menor
+void heap_subir(HeapVariaveis *heap, const double atividade[], int posicao)
+{
+    int variavel = heap->variaveis[posicao];
+    while (posicao > 0)
+    {
+        int pai = (posicao - 1) / 2;
+        if (!variavel_antes(atividade, variavel, heap->variaveis[pai]))
+            break;
+        heap->variaveis[posicao] = heap->variaveis[pai];
+        heap->posicao[heap->variaveis[posicao]] = posicao;
+        posicao = pai;
+    }
+    heap->variaveis[posicao] = variavel;
+    heap->posicao[variavel] = posicao;
+}
+
+// Desce a variável da posição informada trocando-a pelo filho de maior prioridade
+void heap_descer(HeapVariaveis *heap, const double atividade[], int posicao)
+{
+    int variavel = heap->variaveis[posicao];
+    while (2 * posicao + 1 < heap->tamanho)
+    {
+        int filho = 2 * posicao + 1;
+        if (filho + 1 < heap->tamanho && variavel_antes(atividade, heap->variaveis[filho + 1], heap->variaveis[filho]))
+            filho++;
+        if (!variavel_antes(atividade, heap->variaveis[filho], variavel))
+            break;
+        heap->variaveis[posicao] = heap->variaveis[filho];
+        heap->posicao[heap->variaveis[posicao]] = posicao;
+        posicao = filho;
+    }
+    heap->variaveis[posicao] = variavel;
+    heap->posicao[variavel] = posicao;
+}
+
+// Insere a variável no heap, se ainda não estiver nele
+void heap_inserir(HeapVariaveis *heap, const double atividade[], int variavel)
+{
+    if (heap->posicao[variavel] >= 0)
+        return;
+    heap->variaveis[heap->tamanho] = variavel;
+    heap->posicao[variavel] = heap->tamanho;
+    heap_subir(heap, atividade, heap->tamanho++);
+}
+
+// Retira e retorna a variável mais ativa
+int heap_remover_maior(HeapVariaveis *heap, const double atividade[])
+{
+    int maior = heap->variaveis[0];
+    heap->posicao[maior] = -1;
+    heap->tamanho--;
+    if (heap->tamanho > 0)
+    {
+        heap->variaveis[0] = heap->variaveis[heap->tamanho];
+        heap->posicao[heap->variaveis[0]] = 0;
+        heap_descer(heap, atividade, 0);
+    }
+    return maior;
+}
+
+// Aumenta a atividade de uma variável que participou de um conflito; se os valores ficarem grandes demais, todos
+// são reduzidos na mesma proporção, o que mantém a ordem do heap
+void aumentar_atividade(Solucionador *solucionador, int variavel)
+{
+    solucionador->atividade[variavel] += solucionador->incremento_atividade;
+    if (solucionador->atividade[variavel] > 1e100)
+    {
+        for (int indice = 0; indice < solucionador->formula->num_variaveis; indice++)
+            solucionador->atividade[indice] *= 1e-100;
+        solucionador->incremento_atividade *= 1e-100;
+    }
+    if (solucionador->heap.posicao[variavel] >= 0)
+        heap_subir(&solucionador->heap, solucionador->atividade, solucionador->heap.posicao[variavel]);
+}
+
+// EVSIDS: em vez de multiplicar todas as atividades pelo decaimento, o incremento dos próximos conflitos cresce
+void decair_atividades(Solucionador *solucionador)
+{
+    solucionador->incremento_atividade /= DECAIMENTO_ATIVIDADE;
+}
 
-    return *solucao_encontrada;
+// Aumenta a atividade de uma cláusula aprendida usada na análise de um conflito
+void aumentar_atividade_clausula(Solucionador *solucionador, int indice_clausula)
+{
+    if (indice_clausula < solucionador->num_originais)
+        return;
+    solucionador->atividade_clausula[indice_clausula] += solucionador->incremento_clausula;
+    if (solucionador->atividade_clausula[indice_clausula] > 1e20)
+    {
+        for (int indice = solucionador->num_originais; indice < solucionador->formula->num_clausulas; indice++)
+            solucionador->atividade_clausula[indice] *= 1e-20;
+        solucionador->incremento_clausula *= 1e-20;
+    }
+}
+
+// Cria o solucionador sobre o vetor de atribuições do chamador, que deve vir todo com -1; cada cláusula com dois ou
+// mais literais passa a vigiar os dois primeiros
+Solucionador *criar_solucionador(FormulaCNF *formula, int atribuicao[])
+{
+    Solucionador *solucionador = malloc(sizeof(*solucionador));
+    int num_variaveis = formula->num_variaveis;
+    solucionador->formula = formula;
+    solucionador->capacidade_clausulas = formula->num_clausulas;
+    solucionador->atribuicao = atribuicao;
+    solucionador->trilha = malloc(sizeof(int) * (formula->num_variaveis + 1));
+    solucionador->tamanho_trilha = 0;
+    solucionador->propagados = 0;
+    solucionador->vigias = calloc(2 * formula->num_variaveis + 1, sizeof(ListaVigias));
+    solucionador->inicio_nivel = malloc(sizeof(int) * (formula->num_variaveis + 2));
+    solucionador->decisao_invertida = malloc(sizeof(bool) * (formula->num_variaveis + 2));
+    solucionador->inicio_nivel[0] = 0;
+    solucionador->nivel = 0;
+    solucionador->nivel_variavel = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->razao = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->visto = calloc(num_variaveis + 1, sizeof(bool));
+    solucionador->aprendida = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->pilha = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->limpeza = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->tamanho_limpeza = 0;
+    solucionador->atividade = calloc(num_variaveis + 1, sizeof(double));
+    solucionador->incremento_atividade = 1;
+    solucionador->fase_salva = malloc(sizeof(bool) * (num_variaveis + 1));
+    solucionador->heap.variaveis = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->heap.posicao = malloc(sizeof(int) * (num_variaveis + 1));
+    solucionador->heap.tamanho = 0;
+    solucionador->num_originais = formula->num_clausulas;
+    solucionador->lbd_clausula = calloc(formula->num_clausulas + 1, sizeof(int));
+    solucionador->atividade_clausula = calloc(formula->num_clausulas + 1, sizeof(double));
+    solucionador->incremento_clausula = 1;
+    solucionador->marca_nivel = calloc(num_variaveis + 2, sizeof(int));
+    solucionador->carimbo_nivel = 0;
+    solucionador->politica_reinicio = REINICIO_LBD;
+    solucionador->reduzir = true;
+    solucionador->conflitos = 0;
+    solucionador->conflitos_desde_reinicio = 0;
+    solucionador->reinicios = 0;
+    solucionador->reducoes = 0;
+    solucionador->intervalo_reducao = PRIMEIRA_REDUCAO;
+    solucionador->proxima_reducao = PRIMEIRA_REDUCAO;
+    solucionador->media_lbd_rapida = 0;
+    solucionador->media_lbd_lenta = 0;
+    for (int variavel = 0; variavel < num_variaveis; variavel++)
+    {
+        // Sem conflitos ainda, a ordem é a das variáveis e o primeiro valor tentado é 1
+        solucionador->fase_salva[variavel] = true;
+        solucionador->heap.posicao[variavel] = -1;
+        heap_inserir(&solucionador->heap, solucionador->atividade, variavel);
+    }
+
+    int *marcas = calloc(2 * formula->num_variaveis + 1, sizeof(int));
+    for (int indice_clausula = 0; indice_clausula < formula->num_clausulas; indice_clausula++)
+    {
+        int *clausula_atual = formula->clausulas[indice_clausula];
+        if (normalizar_clausula(clausula_atual, marcas, indice_clausula + 1) && clausula_atual[1] != 0)
+        {
+            adicionar_vigia(&solucionador->vigias[indice_literal(clausula_atual[0])], indice_clausula);
+            adicionar_vigia(&solucionador->vigias[indice_literal(clausula_atual[1])], indice_clausula);
+        }
+    }
+    free(marcas);
+    return solucionador;
+}
+
+// Libera o solucionador; as atribuições continuam com o chamador
+void liberar_solucionador(Solucionador *solucionador)
+{
+    for (int indice = 0; indice < 2 * solucionador->formula->num_variaveis; indice++)
+        free(solucionador->vigias[indice].clausulas);
+    free(solucionador->vigias);
+    free(solucionador->trilha);
+    free(solucionador->inicio_nivel);
+    free(solucionador->decisao_invertida);
+    free(solucionador->nivel_variavel);
+    free(solucionador->razao);
+    free(solucionador->visto);
+    free(solucionador->aprendida);
+    free(solucionador->pilha);
+    free(solucionador->limpeza);
+    free(solucionador->atividade);
+    free(solucionador->fase_salva);
+    free(solucionador->heap.variaveis);
+    free(solucionador->heap.posicao);
+    free(solucionador->lbd_clausula);
+    free(solucionador->atividade_clausula);
+    free(solucionador->marca_nivel);
+    free(solucionador);
+}
+
+// Valor do literal na atribuição parcial: 1 verdadeiro, 0 falso, -1 indefinido
+int valor_literal(const Solucionador *solucionador, int literal)
+{
+    int valor = solucionador->atribuicao[abs(literal) - 1];
+    if (valor < 0)
+        return -1;
+    return literal > 0 ? valor : 1 - valor;
+}
+
+// Torna o literal verdadeiro no nível atual e o acrescenta à trilha, com a cláusula que o propagou (-1 se nenhuma)
+void atribuir_literal(Solucionador *solucionador, int literal, int razao)
+{
+    int variavel = abs(literal) - 1;
+    solucionador->atribuicao[variavel] = literal > 0 ? 1 : 0;
+    solucionador->nivel_variavel[variavel] = solucionador->nivel;
+    solucionador->razao[variavel] = razao;
+    solucionador->trilha[solucionador->tamanho_trilha++] = literal;
+}
+
+// Abre um nível de decisão com o literal escolhido
+void decidir(Solucionador *solucionador, int literal, bool invertida)
+{
+    solucionador->nivel++;
+    solucionador->inicio_nivel[solucionador->nivel] = solucionador->tamanho_trilha;
+    solucionador->decisao_invertida[solucionador->nivel] = invertida;
+    atribuir_literal(solucionador, literal, -1);
+}
+
+// Desfaz, pelo fim da trilha, tudo o que foi atribuído depois do nível informado; as vigias continuam válidas,
+// pois um literal vigiado que volta a ficar indefinido não viola nada. Cada variável guarda o valor que tinha e
+// volta ao heap de decisão
+void retroceder(Solucionador *solucionador, int nivel)
+{
+    int limite = solucionador->inicio_nivel[nivel + 1];
+    while (solucionador->tamanho_trilha > limite)
+    {
+        int literal = solucionador->trilha[--solucionador->tamanho_trilha];
+        int variavel = abs(literal) - 1;
+        solucionador->atribuicao[variavel] = -1;
+        solucionador->fase_salva[variavel] = literal > 0;
+        heap_inserir(&solucionador->heap, solucionador->atividade, variavel);
+    }
+    if (solucionador->propagados > limite)
+        solucionador->propagados = limite;
+    solucionador->nivel = nivel;
+}
+
+// Propaga os literais da trilha visitando só as cláusulas que vigiam um literal que acabou de ficar falso;
+// retorna o índice da cláusula que ficou falsa ou -1 se não houver conflito
+int propagar(Solucionador *solucionador)
+{
+    while (solucionador->propagados < solucionador->tamanho_trilha)
+    {
+        int literal_falso = -solucionador->trilha[solucionador->propagados++];
+        ListaVigias *vigias = &solucionador->vigias[indice_literal(literal_falso)];
+        int mantidas = 0;
+
+        for (int indice = 0; indice < vigias->tamanho; indice++)
+        {
+            int indice_clausula = vigias->clausulas[indice];
+            int *clausula_atual = solucionador->formula->clausulas[indice_clausula];
+
+            // O literal que ficou falso vai para a posição 1
+            if (clausula_atual[0] == literal_falso)
+            {
+                clausula_atual[0] = clausula_atual[1];
+                clausula_atual[1] = literal_falso;
+            }
+
+            // A outra vigia já satisfaz a cláusula
+            if (valor_literal(solucionador, clausula_atual[0]) == 1)
+            {
+                vigias->clausulas[mantidas++] = indice_clausula;
+                continue;
+            }
+
+            // Procura outro literal que não seja falso para vigiar no lugar
+            bool trocou_vigia = false;
+            for (int posicao = 2; clausula_atual[posicao] != 0; posicao++)
+            {
+                if (valor_literal(solucionador, clausula_atual[posicao]) != 0)
+                {
+                    clausula_atual[1] = clausula_atual[posicao];
+                    clausula_atual[posicao] = literal_falso;
+                    adicionar_vigia(&solucionador->vigias[indice_literal(clausula_atual[1])], indice_clausula);
+                    trocou_vigia = true;
+                    break;
+                }
+            }
+            if (trocou_vigia)
+                continue;
+
+            // Sem substituto: a cláusula é unitária ou está em conflito
+            vigias->clausulas[mantidas++] = indice_clausula;
+            if (valor_literal(solucionador, clausula_atual[0]) == 0)
+            {
+                while (++indice < vigias->tamanho)
+                    vigias->clausulas[mantidas++] = vigias->clausulas[indice];
+                vigias->tamanho = mantidas;
+                return indice_clausula;
+            }
+            atribuir_literal(solucionador, clausula_atual[0], indice_clausula);
+        }
+        vigias->tamanho = mantidas;
+    }
+    return -1;
+}
+
+// Atribui no nível 0 as cláusulas de um só literal, que não têm vigias; retorna false se duas se contradizem
+bool atribuir_unitarias(Solucionador *solucionador)
+{
+    const FormulaCNF *formula = solucionador->formula;
+    for (int indice_clausula = 0; indice_clausula < formula->num_clausulas; indice_clausula++)
+    {
+        int *clausula_atual = formula->clausulas[indice_clausula];
+        if (clausula_atual[1] != 0)
+            continue;
+        int valor = valor_literal(solucionador, clausula_atual[0]);
+        if (valor == 0)
+            return false;
+        if (valor == -1)
+            atribuir_literal(solucionador, clausula_atual[0], indice_clausula);
+    }
+    return true;
+}
+
+// Variável sem valor mais ativa, com o último valor que teve; 0 se todas já têm valor
+int escolher_literal(Solucionador *solucionador)
+{
+    while (solucionador->heap.tamanho > 0)
+    {
+        int variavel = heap_remover_maior(&solucionador->heap, solucionador->atividade);
+        if (solucionador->atribuicao[variavel] == -1)
+            return solucionador->fase_salva[variavel] ? variavel + 1 : -(variavel + 1);
+    }
+    return 0;
+}
+
+// Busca DPLL sem recursão: decide, propaga e, em conflito, volta à última decisão que ainda pode ser invertida
+bool resolver_dpll(Solucionador *solucionador)
+{
+    if (!atribuir_unitarias(solucionador) || propagar(solucionador) >= 0)
+        return false;
+
+    while (true)
+    {
+        int literal = escolher_literal(solucionador);
+        if (literal == 0)
+            return true;
+
+        decidir(solucionador, literal, false);
+        while (propagar(solucionador) >= 0)
+        {
+            // Níveis cujas decisões já tentaram os dois valores são descartados
+            while (solucionador->nivel > 0 && solucionador->decisao_invertida[solucionador->nivel])
+                retroceder(solucionador, solucionador->nivel - 1);
+            if (solucionador->nivel == 0)
+                return false;
+
+            int decisao = solucionador->trilha[solucionador->inicio_nivel[solucionador->nivel]];
+            retroceder(solucionador, solucionador->nivel - 1);
+            decidir(solucionador, -decisao, true);
+        }
+    }
+}
+
+// Acrescenta a cláusula aprendida à fórmula e vigia os dois primeiros literais; retorna o seu índice
+int adicionar_clausula(Solucionador *solucionador, const int literais[], int tamanho, int lbd)
+{
+    FormulaCNF *formula = solucionador->formula;
+    if (formula->num_clausulas >= solucionador->capacidade_clausulas)
+    {
+        solucionador->capacidade_clausulas = solucionador->capacidade_clausulas * 2 + 16;
+        formula->clausulas = realloc(formula->clausulas, sizeof(int *) * solucionador->capacidade_clausulas);
+        solucionador->lbd_clausula = realloc(solucionador->lbd_clausula,
+                                             sizeof(int) * solucionador->capacidade_clausulas);
+        solucionador->atividade_clausula = realloc(solucionador->atividade_clausula,
+                                                   sizeof(double) * solucionador->capacidade_clausulas);
+    }
+
+    int *clausula = malloc(sizeof(int) * (tamanho + 1));
+    memcpy(clausula, literais, sizeof(int) * tamanho);
+    clausula[tamanho] = 0;
+    int indice_clausula = formula->num_clausulas++;
+    formula->clausulas[indice_clausula] = clausula;
+    solucionador->lbd_clausula[indice_clausula] = lbd;
+    solucionador->atividade_clausula[indice_clausula] = 0;
+    if (tamanho >= 2)
+    {
+        adicionar_vigia(&solucionador->vigias[indice_literal(clausula[0])], indice_clausula);
+        adicionar_vigia(&solucionador->vigias[indice_literal(clausula[1])], indice_clausula);
+    }
+    return indice_clausula;
+}
+
+// Verifica se o literal da cláusula aprendida é implicado pelos outros, seguindo as razões até chegar a literais
+// da cláusula ou do nível 0; marcas feitas numa verificação que falha são desfeitas
+bool literal_redundante(Solucionador *solucionador, int literal)
+{
+    int topo_pilha = 0;
+    int inicio_limpeza = solucionador->tamanho_limpeza;
+    solucionador->pilha[topo_pilha++] = literal;
+
+    while (topo_pilha > 0)
+    {
+        int atual = solucionador->pilha[--topo_pilha];
+        int *razao = solucionador->formula->clausulas[solucionador->razao[abs(atual) - 1]];
+        for (int posicao = 0; razao[posicao] != 0; posicao++)
+        {
+            int variavel = abs(razao[posicao]) - 1;
+            if (variavel == abs(atual) - 1 || solucionador->visto[variavel] ||
+                solucionador->nivel_variavel[variavel] == 0)
+                continue;
+
+            // Uma decisão fora da cláusula não é implicada por ela
+            if (solucionador->razao[variavel] < 0)
+            {
+                while (solucionador->tamanho_limpeza > inicio_limpeza)
+                    solucionador->visto[abs(solucionador->limpeza[--solucionador->tamanho_limpeza]) - 1] = false;
+                return false;
+            }
+            solucionador->visto[variavel] = true;
+            solucionador->pilha[topo_pilha++] = razao[posicao];
+            solucionador->limpeza[solucionador->tamanho_limpeza++] = razao[posicao];
+        }
+    }
+    return true;
+}
+
+// Deriva a cláusula do primeiro UIP a partir do conflito, resolvendo com as razões dos literais do nível atual na
+// ordem inversa da trilha; grava em 'aprendida' com o UIP na posição 0 e o literal do nível de retorno na 1
+int analisar_conflito(Solucionador *solucionador, int conflito, int *nivel_retorno)
+{
+    int *aprendida = solucionador->aprendida;
+    int tamanho = 1;
+    int pendentes = 0;
+    int literal_uip = 0;
+    int posicao_trilha = solucionador->tamanho_trilha - 1;
+
+    do
+    {
+        int *clausula = solucionador->formula->clausulas[conflito];
+        aumentar_atividade_clausula(solucionador, conflito);
+        for (int posicao = 0; clausula[posicao] != 0; posicao++)
+        {
+            int variavel = abs(clausula[posicao]) - 1;
+            if (clausula[posicao] == literal_uip || solucionador->visto[variavel] ||
+                solucionador->nivel_variavel[variavel] == 0)
+                continue;
+            solucionador->visto[variavel] = true;
+            aumentar_atividade(solucionador, variavel);
+            if (solucionador->nivel_variavel[variavel] == solucionador->nivel)
+                pendentes++;
+            else
+                aprendida[tamanho++] = clausula[posicao];
+        }
+
+        // Próximo literal marcado do nível atual, do fim da trilha para o começo
+        while (!solucionador->visto[abs(solucionador->trilha[posicao_trilha]) - 1])
+            posicao_trilha--;
+        literal_uip = solucionador->trilha[posicao_trilha--];
+        conflito = solucionador->razao[abs(literal_uip) - 1];
+        solucionador->visto[abs(literal_uip) - 1] = false;
+        pendentes--;
+    } while (pendentes > 0);
+    aprendida[0] = -literal_uip;
+
+    // Minimização: tira os literais implicados pelos demais; as marcas da cláusula entram na lista de limpeza
+    solucionador->tamanho_limpeza = 0;
+    for (int posicao = 1; posicao < tamanho; posicao++)
+        solucionador->limpeza[solucionador->tamanho_limpeza++] = aprendida[posicao];
+    int tamanho_original = tamanho;
+    int mantidos = 1;
+    for (int posicao = 1; posicao < tamanho_original; posicao++)
+    {
+        int variavel = abs(aprendida[posicao]) - 1;
+        if (solucionador->razao[variavel] < 0 || !literal_redundante(solucionador, aprendida[posicao]))
+            aprendida[mantidos++] = aprendida[posicao];
+    }
+    tamanho = mantidos;
+
+    for (int posicao = 0; posicao < solucionador->tamanho_limpeza; posicao++)
+        solucionador->visto[abs(solucionador->limpeza[posicao]) - 1] = false;
+    solucionador->tamanho_limpeza = 0;
+
+    // O retorno é ao maior nível entre os outros literais, que passa a ser a segunda vigia
+    *nivel_retorno = 0;
+    for (int posicao = 1; posicao < tamanho; posicao++)
+    {
+        int nivel = solucionador->nivel_variavel[abs(aprendida[posicao]) - 1];
+        if (nivel > *nivel_retorno)
+        {
+            *nivel_retorno = nivel;
+            int troca = aprendida[1];
+            aprendida[1] = aprendida[posicao];
+            aprendida[posicao] = troca;
+        }
+    }
+    return tamanho;
+}
+
+// Termo i (a partir de 1) da sequência de Luby: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+long termo_luby(long indice)
+{
+    while (true)
+    {
+        // Menor k com 2^k - 1 >= indice; no fim de cada bloco o termo é 2^(k-1), senão o bloco se repete
+        int expoente = 1;
+        while ((1L << expoente) - 1 < indice)
+            expoente++;
+        if (indice == (1L << expoente) - 1)
+            return 1L << (expoente - 1);
+        indice -= (1L << (expoente - 1)) - 1;
+    }
+}
+
+// Média móvel exponencial; nas primeiras amostras o peso é 1 / amostras, para não partir de zero
+void atualizar_media(double *media, double valor, double peso, long amostras)
+{
+    if (peso < 1.0 / amostras)
+        peso = 1.0 / amostras;
+    *media += peso * (valor - *media);
+}
+
+// Quantidade de níveis de decisão distintos entre os literais da cláusula (LBD)
+int calcular_lbd(Solucionador *solucionador, const int literais[], int tamanho)
+{
+    int lbd = 0;
+    solucionador->carimbo_nivel++;
+    for (int posicao = 0; posicao < tamanho; posicao++)
+    {
+        int nivel = solucionador->nivel_variavel[abs(literais[posicao]) - 1];
+        if (solucionador->marca_nivel[nivel] != solucionador->carimbo_nivel)
+        {
+            solucionador->marca_nivel[nivel] = solucionador->carimbo_nivel;
+            lbd++;
+        }
+    }
+    return lbd;
+}
+
+// Decide, depois de cada conflito, se a busca recomeça do nível 0 conforme a política escolhida
+bool deve_reiniciar(Solucionador *solucionador, int lbd)
+{
+    solucionador->conflitos_desde_reinicio++;
+    switch (solucionador->politica_reinicio)
+    {
+    case REINICIO_LUBY:
+        return solucionador->conflitos_desde_reinicio >=
+               INTERVALO_LUBY * termo_luby(solucionador->reinicios + 1);
+    case REINICIO_LBD:
+        // Reinicia quando as cláusulas recentes estão bem piores que a média longa, como no glucose
+        atualizar_media(&solucionador->media_lbd_rapida, lbd, PESO_MEDIA_RAPIDA, solucionador->conflitos);
+        atualizar_media(&solucionador->media_lbd_lenta, lbd, PESO_MEDIA_LENTA, solucionador->conflitos);
+        return solucionador->conflitos_desde_reinicio >= CONFLITOS_MINIMOS_REINICIO &&
+               solucionador->media_lbd_rapida > MARGEM_REINICIO_LBD * solucionador->media_lbd_lenta;
+    default:
+        return false;
+    }
+}
+
+// Cláusula aprendida candidata à remoção, com os critérios da ordenação
+typedef struct
+{
+    int indice;
+    int lbd;
+    double atividade;
+} CandidataRemocao;
+
+// Ordena da pior para a melhor: LBD maior primeiro e, no empate, menos ativa primeiro
+int comparar_candidatas(const void *a, const void *b)
+{
+    const CandidataRemocao *x = a, *y = b;
+    if (x->lbd != y->lbd)
+        return x->lbd > y->lbd ? -1 : 1;
+    if (x->atividade != y->atividade)
+        return x->atividade < y->atividade ? -1 : 1;
+    return x->indice - y->indice;
+}
+
+// Cláusula que é a razão de um literal atribuído não pode ser removida
+bool clausula_travada(const Solucionador *solucionador, int indice_clausula)
+{
+    int *clausula = solucionador->formula->clausulas[indice_clausula];
+    int variavel = abs(clausula[0]) - 1;
+    return valor_literal(solucionador, clausula[0]) == 1 && solucionador->razao[variavel] == indice_clausula;
+}
+
+// Remove a pior metade das cláusulas aprendidas, mantendo as de LBD até 2 e as que são razões, e compacta o vetor de
+// cláusulas, as vigias e as razões com os novos índices
+void reduzir_aprendidas(Solucionador *solucionador)
+{
+    FormulaCNF *formula = solucionador->formula;
+    int num_aprendidas = formula->num_clausulas - solucionador->num_originais;
+    CandidataRemocao *candidatas = malloc(sizeof(CandidataRemocao) * (num_aprendidas + 1));
+    int num_candidatas = 0;
+    for (int indice = solucionador->num_originais; indice < formula->num_clausulas; indice++)
+    {
+        if (solucionador->lbd_clausula[indice] <= 2 || clausula_travada(solucionador, indice))
+            continue;
+        candidatas[num_candidatas].indice = indice;
+        candidatas[num_candidatas].lbd = solucionador->lbd_clausula[indice];
+        candidatas[num_candidatas].atividade = solucionador->atividade_clausula[indice];
+        num_candidatas++;
+    }
+    qsort(candidatas, num_candidatas, sizeof(CandidataRemocao), comparar_candidatas);
+
+    // Novo índice de cada cláusula; -1 para as removidas
+    int *novo_indice = malloc(sizeof(int) * (formula->num_clausulas + 1));
+    for (int indice = 0; indice < formula->num_clausulas; indice++)
+        novo_indice[indice] = indice;
+    int remover = num_aprendidas / 2 < num_candidatas ? num_aprendidas / 2 : num_candidatas;
+    for (int posicao = 0; posicao < remover; posicao++)
+    {
+        int indice = candidatas[posicao].indice;
+        free(formula->clausulas[indice]);
+        novo_indice[indice] = -1;
+    }
+    free(candidatas);
+
+    int mantidas = solucionador->num_originais;
+    for (int indice = solucionador->num_originais; indice < formula->num_clausulas; indice++)
+    {
+        if (novo_indice[indice] < 0)
+            continue;
+        formula->clausulas[mantidas] = formula->clausulas[indice];
+        solucionador->lbd_clausula[mantidas] = solucionador->lbd_clausula[indice];
+        solucionador->atividade_clausula[mantidas] = solucionador->atividade_clausula[indice];
+        novo_indice[indice] = mantidas++;
+    }
+
+    for (int indice = 0; indice < 2 * formula->num_variaveis; indice++)
+    {
+        ListaVigias *vigias = &solucionador->vigias[indice];
+        int restantes = 0;
+        for (int posicao = 0; posicao < vigias->tamanho; posicao++)
+        {
+            int indice_clausula = novo_indice[vigias->clausulas[posicao]];
+            if (indice_clausula >= 0)
+                vigias->clausulas[restantes++] = indice_clausula;
+        }
+        vigias->tamanho = restantes;
+    }
+    for (int posicao = 0; posicao < solucionador->tamanho_trilha; posicao++)
+    {
+        int variavel = abs(solucionador->trilha[posicao]) - 1;
+        if (solucionador->razao[variavel] >= 0)
+            solucionador->razao[variavel] = novo_indice[solucionador->razao[variavel]];
+    }
+
+    formula->num_clausulas = mantidas;
+    free(novo_indice);
+    solucionador->reducoes++;
+}
+
+// Busca CDCL: a cada conflito aprende a cláusula do primeiro UIP e volta direto ao nível em que ela força o UIP;
+// reinícios e reduções só acontecem depois de uma propagação sem conflito
+bool resolver_cdcl(Solucionador *solucionador)
+{
+    if (!atribuir_unitarias(solucionador))
+        return false;
+
+    bool reinicio_pendente = false;
+    while (true)
+    {
+        int conflito = propagar(solucionador);
+        if (conflito >= 0)
+        {
+            // Conflito sem decisões: a fórmula é insatisfatível
+            if (solucionador->nivel == 0)
+                return false;
+
+            solucionador->conflitos++;
+            int nivel_retorno;
+            int tamanho = analisar_conflito(solucionador, conflito, &nivel_retorno);
+            int lbd = calcular_lbd(solucionador, solucionador->aprendida, tamanho);
+            decair_atividades(solucionador);
+            solucionador->incremento_clausula /= DECAIMENTO_CLAUSULA;
+            reinicio_pendente = deve_reiniciar(solucionador, lbd);
+
+            retroceder(solucionador, nivel_retorno);
+            if (tamanho == 1)
+            {
+                atribuir_literal(solucionador, solucionador->aprendida[0], -1);
+            }
+            else
+            {
+                int indice_clausula = adicionar_clausula(solucionador, solucionador->aprendida, tamanho, lbd);
+                atribuir_literal(solucionador, solucionador->aprendida[0], indice_clausula);
+            }
+            continue;
+        }
+
+        if (reinicio_pendente)
+        {
+            // As fases salvas e as atividades sobrevivem ao reinício
+            reinicio_pendente = false;
+            retroceder(solucionador, 0);
+            solucionador->reinicios++;
+            solucionador->conflitos_desde_reinicio = 0;
+        }
+        if (solucionador->reduzir && solucionador->conflitos >= solucionador->proxima_reducao)
+        {
+            reduzir_aprendidas(solucionador);
+            solucionador->intervalo_reducao += INCREMENTO_REDUCAO;
+            solucionador->proxima_reducao = solucionador->conflitos + solucionador->intervalo_reducao;
+        }
+
+        int literal = escolher_literal(solucionador);
+        if (literal == 0)
+            return true;
+        decidir(solucionador, literal, false);
+    }
 }
 
 // Lê arquivo CNF no formato DIMACS
@@ -206,16 +971,53 @@ void liberar_formula(FormulaCNF *formula)
     free(formula);
 }
 
+// Lê a política de reinícios pelo nome; retorna false se o nome não for conhecido
+bool ler_politica_reinicio(const char *nome, PoliticaReinicio *politica)
+{
+    if (strcmp(nome, "lbd") == 0)
+        *politica = REINICIO_LBD;
+    else if (strcmp(nome, "luby") == 0)
+        *politica = REINICIO_LUBY;
+    else if (strcmp(nome, "nenhum") == 0)
+        *politica = REINICIO_NENHUM;
+    else
+        return false;
+    return true;
+}
+
 // Ponto de entrada do programa
 int main(int argc, char *argv[])
 {
-    if (argc != 2)
+    // A busca padrão é a CDCL; --dpll usa o retrocesso cronológico, sem aprender cláusulas
+    bool usar_dpll = false;
+    bool reduzir = true;
+    bool estatisticas = false;
+    PoliticaReinicio politica = REINICIO_LBD;
+    const char *nome_arquivo = NULL;
+    bool argumentos_validos = true;
+    for (int indice = 1; indice < argc && argumentos_validos; indice++)
     {
-        fprintf(stderr, "Uso: %s <arquivo.cnf>\n", argv[0]);
+        if (strcmp(argv[indice], "--dpll") == 0)
+            usar_dpll = true;
+        else if (strcmp(argv[indice], "--sem-reducao") == 0)
+            reduzir = false;
+        else if (strcmp(argv[indice], "--estatisticas") == 0)
+            estatisticas = true;
+        else if (strcmp(argv[indice], "--reinicio") == 0 && indice + 1 < argc)
+            argumentos_validos = ler_politica_reinicio(argv[++indice], &politica);
+        else if (!nome_arquivo && argv[indice][0] != '-')
+            nome_arquivo = argv[indice];
+        else
+            argumentos_validos = false;
+    }
+    if (!argumentos_validos || !nome_arquivo)
+    {
+        fprintf(stderr, "Uso: %s [--dpll] [--reinicio lbd|luby|nenhum] [--sem-reducao] [--estatisticas] "
+                        "<arquivo.cnf>\n", argv[0]);
         return 1;
     }
 
-    FormulaCNF *formula = ler_arquivo_cnf(argv[1]);
+    FormulaCNF *formula = ler_arquivo_cnf(nome_arquivo);
     if (!formula)
         return 1;
 
@@ -234,11 +1036,20 @@ int main(int argc, char *argv[])
         atribuicoes[indice_variavel] = -1;
     }
 
-    // Executa busca exaustiva
-    NoArvore *arvore_raiz = criar_arvore(0, formula->num_variaveis);
-    bool solucao_encontrada = false;
-    gerar_com_arvore(arvore_raiz, atribuicoes, formula, &solucao_encontrada);
-    liberar_arvore(arvore_raiz);
+    // O modelo encontrado ainda é conferido cláusula por cláusula
+    Solucionador *solucionador = criar_solucionador(formula, atribuicoes);
+    solucionador->politica_reinicio = politica;
+    solucionador->reduzir = reduzir;
+    bool solucao_encontrada = (usar_dpll ? resolver_dpll(solucionador) : resolver_cdcl(solucionador)) &&
+                              formula_satisfeita(formula, atribuicoes);
+    if (estatisticas)
+    {
+        // Linhas de comentário no estilo DIMACS, fora da saída padrão
+        fprintf(stderr, "c conflitos: %ld\nc reinicios: %ld\nc reducoes: %ld\nc clausulas aprendidas: %d\n",
+                solucionador->conflitos, solucionador->reinicios, solucionador->reducoes,
+                formula->num_clausulas - solucionador->num_originais);
+    }
+    liberar_solucionador(solucionador);
 
     // Exibe resultados
     if (solucao_encontrada)